@@ -7,6 +7,7 @@
 #include <queue>
 #include <regex>
 #include "ImageEx.h"
+#include "MediaCache.h"
 
 #define SQLITE_EXTERN __declspec(dllimport) extern
 #include <winsqlite/winsqlite3.h>
@@ -44,10 +45,11 @@ namespace BiliUWP {
         util::debug::set_log_provider(m_logging_provider);
 
         auto update_log_level_fn = [this] {
-            m_cur_log_level = static_cast<util::debug::LogLevel>(m_cfg_model.App_LogLevel());
-            if (m_cur_log_level > util::debug::LogLevel::Error) {
-                m_cur_log_level = util::debug::LogLevel::Error;
+            auto new_level = static_cast<util::debug::LogLevel>(m_cfg_model.App_LogLevel());
+            if (new_level > util::debug::LogLevel::Error) {
+                new_level = util::debug::LogLevel::Error;
             }
+            this->set_log_level(new_level);
         };
         update_log_level_fn();
         auto update_bili_client_fn = [this] {
@@ -970,10 +972,10 @@ winrt::BiliUWP::implementation::App::App() :
 
     UnhandledException([this](IInspectable const&, UnhandledExceptionEventArgs const& e) {
         auto error_message = e.Message();
-        util::debug::log_error(std::format(
+        util::debug::log_error(
             L"Uncaught exception in application: 0x{:08x}: {}",
             static_cast<uint32_t>(e.Exception()), error_message
-        ));
+        );
         if (IsDebuggerPresent()) {
             __debugbreak();
         }
@@ -1072,10 +1074,12 @@ void winrt::BiliUWP::implementation::App::OnLaunched(LaunchActivatedEventArgs co
             sqlite3_config(SQLITE_CONFIG_LOG, +[](void* pArg, int iErrCode, const char* zMsg) {
                 std::ignore = pArg;
                 if ((iErrCode & 0xff) == SQLITE_WARNING) {
-                    util::debug::log_warn(std::format(L"sqlite3 warning: [{}] {}", iErrCode, to_hstring(zMsg)));
+                    util::debug::log_warn(L"sqlite3 warning: [{}] {}", iErrCode,
+                        util::debug::lazy_arg([&] { return to_hstring(zMsg); }));
                 }
                 else {
-                    util::debug::log_debug(std::format(L"sqlite3 log: [{}] {}", iErrCode, to_hstring(zMsg)));
+                    util::debug::log_debug(L"sqlite3 log: [{}] {}", iErrCode,
+                        util::debug::lazy_arg([&] { return to_hstring(zMsg); }));
                 }
             }, nullptr);
         }
@@ -1084,6 +1088,10 @@ void winrt::BiliUWP::implementation::App::OnLaunched(LaunchActivatedEventArgs co
             // TODO: Maybe improve ImageEx init logic
             co_await ::BiliUWP::init_image_ex_async();
         }();
+        // NOTE: Init media cache
+        []() -> fire_forget_except {
+            co_await ::BiliUWP::init_media_cache_async();
+        }();
 
         if (e.PreviousExecutionState() == ApplicationExecutionState::Terminated) {
             // Restore the saved session state only when appropriate, scheduling the
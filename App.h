@@ -143,7 +143,10 @@ namespace BiliUWP {
             winrt::hstring content;
         };
         // NOTE: Higher the level, fewer the logs
-        void set_log_level(util::debug::LogLevel new_level) { m_cur_log_level = new_level; }
+        void set_log_level(util::debug::LogLevel new_level) {
+            m_cur_log_level = new_level;
+            util::debug::set_min_log_level(new_level);
+        }
         void log_trace(winrt::hstring str, std::source_location const& loc) {
             // TODO: Add mutex support
             constexpr auto this_level = util::debug::LogLevel::Trace;
@@ -3,6 +3,7 @@
 #include "FavouritesUserViewItem.g.cpp"
 #include "AppItemsCollection.h"
 #include "App.h"
+#include "ImageEx.h"
 #include "util.hpp"
 
 using namespace winrt;
@@ -26,6 +27,19 @@ namespace winrt::BiliUWP::implementation {
 }
 
 namespace BiliUWP {
+    // Warms up the image cache with covers which are about to be shown
+    static IAsyncAction prefetch_covers(std::vector<Uri> const& uris) {
+        auto http_cache = ::BiliUWP::get_image_ex_http_cache();
+        if (!http_cache || uris.empty()) { return nullptr; }
+        return http_cache.prefetch_async(uris, ::BiliUWP::HttpCachePrefetchPriority::Low);
+    }
+    // NOTE: Malformed urls are skipped, as covers are only prefetched on a best-effort basis
+    static void push_cover_uri(std::vector<Uri>& uris, hstring const& url) {
+        if (url == L"") { return; }
+        try { uris.emplace_back(url); }
+        catch (hresult_error const&) {}
+    }
+
     util::winrt::task<std::vector<IInspectable>> FavouritesFolderViewItemsSource::GetMoreItemsAsync(
         uint32_t expected_count
     ) {
@@ -36,10 +50,13 @@ namespace BiliUWP {
 
         auto bili_client = ::BiliUWP::App::get()->bili_client();
 
-        auto result = std::move(co_await bili_client->fav_folder_res_list(
-            m_folder_id, { .n = m_pn + 1, .size = m_ps },
-            L"", ::BiliUWP::FavResSortOrderParam::ByFavouriteTime
-        ));
+        // NOTE: The page requested ahead of time is always the next one
+        auto page_op = m_next_page_op ? std::exchange(m_next_page_op, nullptr) :
+            bili_client->fav_folder_res_list(
+                m_folder_id, { .n = m_pn + 1, .size = m_ps },
+                L"", ::BiliUWP::FavResSortOrderParam::ByFavouriteTime
+            );
+        auto result = std::move(co_await page_op);
         m_total_items_count = static_cast<uint32_t>(result.info.media_count);
         m_upper_id = result.info.upper.mid;
         m_upper_name = result.info.upper.name;
@@ -51,10 +68,44 @@ namespace BiliUWP {
         }
 
         m_pn++;
+        if (m_pn * m_ps < m_total_items_count) {
+            m_next_page_op = fetch_page_ahead(m_pn + 1);
+        }
 
         co_return vec;
     }
+    // Requests a page before it is asked for, and warms up the image cache with its covers
+    // NOTE: Not cancelled by further GetMoreItemsAsync calls. Doesn't keep the source alive,
+    //       so that its destruction cancels the request.
+    util::winrt::task<::BiliUWP::FavFolderResListResult> FavouritesFolderViewItemsSource::fetch_page_ahead(
+        uint32_t pn
+    ) {
+        auto weak_this = weak_from_this();
+        auto cancellation_token = co_await get_cancellation_token();
+        cancellation_token.enable_propagation();
+
+        auto bili_client = ::BiliUWP::App::get()->bili_client();
+
+        auto result = std::move(co_await bili_client->fav_folder_res_list(
+            m_folder_id, { .n = pn, .size = m_ps },
+            L"", ::BiliUWP::FavResSortOrderParam::ByFavouriteTime
+        ));
+        std::vector<Uri> cover_uris;
+        for (auto const& i : result.media_list) {
+            push_cover_uri(cover_uris, i.cover_url);
+        }
+        auto strong_this = weak_this.lock();
+        if (!strong_this) { co_return result; }
+        util::winrt::cancel_async(m_cover_prefetch_op);
+        m_cover_prefetch_op = prefetch_covers(cover_uris);
+
+        co_return result;
+    }
     void FavouritesFolderViewItemsSource::Reset(void) {
+        if (m_next_page_op) { m_next_page_op.cancel(); }
+        m_next_page_op = nullptr;
+        util::winrt::cancel_async(m_cover_prefetch_op);
+        m_cover_prefetch_op = nullptr;
         m_pn = 0;
         m_total_items_count = 0;
         m_upper_name = L"";
@@ -98,10 +149,13 @@ namespace BiliUWP {
 
         auto bili_client = ::BiliUWP::App::get()->bili_client();
 
-        auto result = std::move(co_await bili_client->user_space_published_videos(
-            m_mid, { .n = m_pn + 1, .size = m_ps },
-            L"", ::BiliUWP::UserPublishedVideosOrderParam::ByPublishTime
-        ));
+        // NOTE: The page requested ahead of time is always the next one
+        auto page_op = m_next_page_op ? std::exchange(m_next_page_op, nullptr) :
+            bili_client->user_space_published_videos(
+                m_mid, { .n = m_pn + 1, .size = m_ps },
+                L"", ::BiliUWP::UserPublishedVideosOrderParam::ByPublishTime
+            );
+        auto result = std::move(co_await page_op);
         m_total_items_count = static_cast<uint32_t>(result.page.count);
         std::vector<IInspectable> vec;
         vec.reserve(result.list.vlist.size());
@@ -110,10 +164,44 @@ namespace BiliUWP {
         }
 
         m_pn++;
+        if (m_pn * m_ps < m_total_items_count) {
+            m_next_page_op = fetch_page_ahead(m_pn + 1);
+        }
 
         co_return vec;
     }
+    // Requests a page before it is asked for, and warms up the image cache with its covers
+    // NOTE: Not cancelled by further GetMoreItemsAsync calls. Doesn't keep the source alive,
+    //       so that its destruction cancels the request.
+    util::winrt::task<::BiliUWP::UserSpacePublishedVideosResult> UserVideosViewItemsSource::fetch_page_ahead(
+        uint32_t pn
+    ) {
+        auto weak_this = weak_from_this();
+        auto cancellation_token = co_await get_cancellation_token();
+        cancellation_token.enable_propagation();
+
+        auto bili_client = ::BiliUWP::App::get()->bili_client();
+
+        auto result = std::move(co_await bili_client->user_space_published_videos(
+            m_mid, { .n = pn, .size = m_ps },
+            L"", ::BiliUWP::UserPublishedVideosOrderParam::ByPublishTime
+        ));
+        std::vector<Uri> cover_uris;
+        for (auto const& i : result.list.vlist) {
+            push_cover_uri(cover_uris, i.cover_url);
+        }
+        auto strong_this = weak_this.lock();
+        if (!strong_this) { co_return result; }
+        util::winrt::cancel_async(m_cover_prefetch_op);
+        m_cover_prefetch_op = prefetch_covers(cover_uris);
+
+        co_return result;
+    }
     void UserVideosViewItemsSource::Reset(void) {
+        if (m_next_page_op) { m_next_page_op.cancel(); }
+        m_next_page_op = nullptr;
+        util::winrt::cancel_async(m_cover_prefetch_op);
+        m_cover_prefetch_op = nullptr;
         m_pn = 0;
         m_total_items_count = 0;
     }
@@ -98,6 +98,10 @@ namespace BiliUWP {
     struct FavouritesFolderViewItemsSource : ::BiliUWP::IIncrementalSource {
         FavouritesFolderViewItemsSource(uint64_t folder_id) :
             m_folder_id(folder_id), m_pn(0), m_ps(20), m_total_items_count(0) {}
+        ~FavouritesFolderViewItemsSource() {
+            if (m_next_page_op) { m_next_page_op.cancel(); }
+            util::winrt::cancel_async(m_cover_prefetch_op);
+        }
         util::winrt::task<std::vector<winrt::Windows::Foundation::IInspectable>> GetMoreItemsAsync(
             uint32_t expected_count
         );
@@ -109,12 +113,17 @@ namespace BiliUWP {
         uint32_t TotalItemsCount(void) { return m_total_items_count; }
 
     private:
+        util::winrt::task<::BiliUWP::FavFolderResListResult> fetch_page_ahead(uint32_t pn);
+
         uint64_t m_folder_id;
         uint32_t m_pn, m_ps;
         uint64_t m_upper_id;
         winrt::hstring m_upper_name;
         winrt::hstring m_folder_name;
         uint32_t m_total_items_count;
+        // The page following the loaded ones, requested ahead of time
+        util::winrt::task<::BiliUWP::FavFolderResListResult> m_next_page_op;
+        winrt::Windows::Foundation::IAsyncAction m_cover_prefetch_op{ nullptr };
     };
     struct FavouritesUserViewItemsSource : ::BiliUWP::IIncrementalSource {
         FavouritesUserViewItemsSource(uint64_t user_mid) :
@@ -134,6 +143,10 @@ namespace BiliUWP {
     struct UserVideosViewItemsSource : ::BiliUWP::IIncrementalSource {
         UserVideosViewItemsSource(uint64_t mid) :
             m_mid(mid), m_pn(0), m_ps(20), m_total_items_count(0) {}
+        ~UserVideosViewItemsSource() {
+            if (m_next_page_op) { m_next_page_op.cancel(); }
+            util::winrt::cancel_async(m_cover_prefetch_op);
+        }
         util::winrt::task<std::vector<winrt::Windows::Foundation::IInspectable>> GetMoreItemsAsync(
             uint32_t expected_count
         );
@@ -142,9 +155,14 @@ namespace BiliUWP {
         uint32_t TotalItemsCount(void) { return m_total_items_count; }
 
     private:
+        util::winrt::task<::BiliUWP::UserSpacePublishedVideosResult> fetch_page_ahead(uint32_t pn);
+
         uint64_t m_mid;
         uint32_t m_pn, m_ps;
         uint32_t m_total_items_count;
+        // The page following the loaded ones, requested ahead of time
+        util::winrt::task<::BiliUWP::UserSpacePublishedVideosResult> m_next_page_op;
+        winrt::Windows::Foundation::IAsyncAction m_cover_prefetch_op{ nullptr };
     };
     struct UserAudiosViewItemsSource : ::BiliUWP::IIncrementalSource {
         UserAudiosViewItemsSource(uint64_t mid) :
@@ -27,14 +27,35 @@ namespace BiliUWP {
     void check_json_code(json::JsonObject const& jo) {
         check_api_code(jo.at(L"code").get_value<int32_t>());
     }
-    void check_json_code(winrt::Windows::Data::Json::JsonObject const& jo) {
-        auto code = static_cast<ApiCode>(jo.GetNamedNumber(L"code"));
-        if (!try_check_api_code(code)) {
-            if (auto jv = jo.TryLookup(L"message")) {
-                throw BiliApiUpstreamException(code, winrt::to_string(jv.GetString()));
+
+    // An API response, with the json document parsed in place from its buffer
+    struct ApiJsonResponse {
+        ApiJsonResponse(winrt::Windows::Storage::Streams::IBuffer buf) : m_buf(std::move(buf)) {
+            auto data = reinterpret_cast<const char*>(m_buf.data());
+            check_parsed(m_doc.try_deserialize_from_utf8(data, m_buf.Length()));
+        }
+        ApiJsonResponse(std::vector<char> text) : m_buf(nullptr) {
+            check_parsed(m_doc.try_deserialize_from_utf8(std::move(text)));
+        }
+        ApiJsonResponse(ApiJsonResponse const&) = delete;
+
+        json::JsonObjectView root(void) const { return m_doc.root().get_object(); }
+        std::string_view text(void) const { return m_doc.text(); }
+        // NOTE: Converted only when the log is actually written
+        auto lazy_text(void) const {
+            return util::debug::lazy_arg([this] { return winrt::to_hstring(text()); });
+        }
+
+    private:
+        void check_parsed(bool parsed) {
+            if (!parsed || !m_doc.root().is_object()) {
+                throw winrt::hresult_error(WEB_E_INVALID_JSON_STRING, L"API response is not a valid JSON object");
             }
         }
-    }
+
+        winrt::Windows::Storage::Streams::IBuffer m_buf;
+        json::JsonDocument m_doc;
+    };
 
     struct JsonObjectVisitor;
     struct JsonArrayVisitor;
@@ -53,64 +74,93 @@ namespace BiliUWP {
             util::misc::second_type<decltype(func(std::declval<JsonValueVisitor>())), JsonValueVisitor>;
         template<typename Functor>
         static auto get_fn_param_helper(Functor func, ...) -> BadFnParamType;
-        static constexpr std::string_view stringify(winrt::Windows::Data::Json::JsonValueType jvt) {
-            using winrt::Windows::Data::Json::JsonValueType;
+        static constexpr std::string_view stringify(json::JsonValueKind jvt) {
+            using json::JsonValueKind;
             switch (jvt) {
-            case JsonValueType::Array:          return "array";
-            case JsonValueType::Boolean:        return "boolean";
-            case JsonValueType::Null:           return "null";
-            case JsonValueType::Number:         return "number";
-            case JsonValueType::Object:         return "object";
-            case JsonValueType::String:         return "string";
+            case JsonValueKind::Array:          return "array";
+            case JsonValueKind::Boolean:        return "boolean";
+            case JsonValueKind::Null:           return "null";
+            case JsonValueKind::Number:         return "number";
+            case JsonValueKind::Object:         return "object";
+            case JsonValueKind::String:         return "string";
             default:                            return "<unknown>";
             }
         }
     };
 
+    enum class JsonIntegerConversion { Ok, NotInteger, OutOfRange };
+    template<typename T>
+    JsonIntegerConversion json_number_to_integer(std::variant<int64_t, uint64_t, double> number, T& out) {
+        if (auto p = std::get_if<double>(&number)) {
+            auto value = *p;
+            if (std::trunc(value) != value) {
+                return JsonIntegerConversion::NotInteger;
+            }
+            // NOTE: Integers beyond 64 bits are parsed as double
+            if (!(value >= -0x1p63 && value < 0x1p63)) {
+                return JsonIntegerConversion::OutOfRange;
+            }
+            number = static_cast<int64_t>(value);
+        }
+        return std::visit([&](auto v) {
+            if constexpr (std::is_integral_v<decltype(v)>) {
+                if (!std::in_range<T>(v)) {
+                    return JsonIntegerConversion::OutOfRange;
+                }
+                out = static_cast<T>(v);
+                return JsonIntegerConversion::Ok;
+            }
+            else {
+                // Should be UNREACHABLE
+                return JsonIntegerConversion::NotInteger;
+            }
+        }, number);
+    }
+
     struct JsonValueVisitor {
         JsonValueVisitor(
-            winrt::Windows::Data::Json::IJsonValue jv,
+            json::JsonValueView jv,
             JsonPropsWalkTree& props_walk
         ) : m_jv(std::move(jv)), m_props_walk(props_walk) {}
 
         JsonPropsWalkTree& get_props_walk_tree(void) { return m_props_walk; }
 
         bool is_null(void) {
-            return m_jv.ValueType() == winrt::Windows::Data::Json::JsonValueType::Null;
+            return m_jv.kind() == json::JsonValueKind::Null;
         }
         void expect_null(void) {
-            expect_jv_type(m_jv, winrt::Windows::Data::Json::JsonValueType::Null);
+            expect_jv_type(m_jv, json::JsonValueKind::Null);
         }
 
         template<typename T>
         std::optional<T> try_as(void) = delete;
         template<>
         std::optional<std::wstring> try_as(void) {
-            if (m_jv.ValueType() != winrt::Windows::Data::Json::JsonValueType::String) {
+            if (m_jv.kind() != json::JsonValueKind::String) {
                 return std::nullopt;
             }
-            return std::wstring{ m_jv.GetString() };
+            return m_jv.get_value<std::wstring>();
         }
         template<>
         std::optional<winrt::hstring> try_as(void) {
-            if (m_jv.ValueType() != winrt::Windows::Data::Json::JsonValueType::String) {
+            if (m_jv.kind() != json::JsonValueKind::String) {
                 return std::nullopt;
             }
-            return m_jv.GetString();
+            return m_jv.get_value<winrt::hstring>();
         }
         template<>
         std::optional<bool> try_as(void) {
-            if (m_jv.ValueType() != winrt::Windows::Data::Json::JsonValueType::Boolean) {
+            if (m_jv.kind() != json::JsonValueKind::Boolean) {
                 return std::nullopt;
             }
-            return m_jv.GetBoolean();
+            return m_jv.get_value<bool>();
         }
         template<>
         std::optional<double> try_as(void) {
-            if (m_jv.ValueType() != winrt::Windows::Data::Json::JsonValueType::Number) {
+            if (m_jv.kind() != json::JsonValueKind::Number) {
                 return std::nullopt;
             }
-            return m_jv.GetNumber();
+            return m_jv.get_value<double>();
         }
         template<> std::optional<uint8_t> try_as(void) { return try_as_integer<uint8_t>(); }
         template<> std::optional<int8_t> try_as(void) { return try_as_integer<int8_t>(); }
@@ -125,27 +175,28 @@ namespace BiliUWP {
         template<>
         std::optional<JsonArrayVisitor> try_as(void);
 
+        // NOTE: Types without a specialization here are decoded through JsonFieldTable
         template<typename T>
-        T as(void) = delete;
+        T as(void);
         template<>
         std::wstring as(void) {
-            expect_jv_type(m_jv, winrt::Windows::Data::Json::JsonValueType::String);
-            return std::wstring{ m_jv.GetString() };
+            expect_jv_type(m_jv, json::JsonValueKind::String);
+            return m_jv.get_value<std::wstring>();
         }
         template<>
         winrt::hstring as(void) {
-            expect_jv_type(m_jv, winrt::Windows::Data::Json::JsonValueType::String);
-            return m_jv.GetString();
+            expect_jv_type(m_jv, json::JsonValueKind::String);
+            return m_jv.get_value<winrt::hstring>();
         }
         template<>
         bool as(void) {
-            expect_jv_type(m_jv, winrt::Windows::Data::Json::JsonValueType::Boolean);
-            return m_jv.GetBoolean();
+            expect_jv_type(m_jv, json::JsonValueKind::Boolean);
+            return m_jv.get_value<bool>();
         }
         template<>
         double as(void) {
-            expect_jv_type(m_jv, winrt::Windows::Data::Json::JsonValueType::Number);
-            return m_jv.GetNumber();
+            expect_jv_type(m_jv, json::JsonValueKind::Number);
+            return m_jv.get_value<double>();
         }
         template<> uint8_t as(void) { return as_integer<uint8_t>(); }
         template<> int8_t as(void) { return as_integer<int8_t>(); }
@@ -182,10 +233,10 @@ namespace BiliUWP {
 
     private:
         void expect_jv_type(
-            winrt::Windows::Data::Json::IJsonValue const& jv,
-            winrt::Windows::Data::Json::JsonValueType expected_type
+            json::JsonValueView const& jv,
+            json::JsonValueKind expected_type
         ) {
-            auto jvt = jv.ValueType();
+            auto jvt = jv.kind();
             if (jvt != expected_type) {
                 throw BiliApiParseException(BiliApiParseException::json_parse_wrong_type,
                     m_props_walk,
@@ -196,77 +247,50 @@ namespace BiliUWP {
         }
         template<typename T>
         std::optional<T> try_as_integer(void) {
-            expect_jv_type(m_jv, winrt::Windows::Data::Json::JsonValueType::Number);
-            auto number = m_jv.GetNumber();
-            if (std::trunc(number) != number) {
-                return std::nullopt;
-            }
-            errno = 0;
-            long long integer{ std::llround(number) };
-            if (auto cur_errno = errno; cur_errno == EDOM || cur_errno == ERANGE) {
+            expect_jv_type(m_jv, json::JsonValueKind::Number);
+            T integer;
+            if (json_number_to_integer(m_jv.get_number(), integer) != JsonIntegerConversion::Ok) {
                 return std::nullopt;
             }
-            if constexpr (std::numeric_limits<T>::is_signed) {
-                if (integer < std::numeric_limits<T>::min() || integer > std::numeric_limits<T>::max()) {
-                    return std::nullopt;
-                }
-            }
-            else {
-                if (integer < 0 || static_cast<unsigned long long>(integer) > std::numeric_limits<T>::max()) {
-                    return std::nullopt;
-                }
-            }
-            return std::optional{ static_cast<T>(integer) };
+            return std::optional{ integer };
         }
         template<typename T>
         T as_integer(void) {
-            expect_jv_type(m_jv, winrt::Windows::Data::Json::JsonValueType::Number);
-            auto number = m_jv.GetNumber();
-            if (std::trunc(number) != number) {
+            expect_jv_type(m_jv, json::JsonValueKind::Number);
+            T integer;
+            switch (json_number_to_integer(m_jv.get_number(), integer)) {
+            case JsonIntegerConversion::NotInteger:
                 throw BiliApiParseException(BiliApiParseException::json_parse_wrong_type,
                     m_props_walk,
                     "integer",
-                    JsonVisitorHelper::stringify(winrt::Windows::Data::Json::JsonValueType::Number)
-                );
-            }
-            errno = 0;
-            long long integer{ std::llround(number) };
-            if (auto cur_errno = errno; cur_errno == EDOM || cur_errno == ERANGE) {
-                throw BiliApiParseException(BiliApiParseException::json_parse_out_of_range,
-                    m_props_walk
+                    JsonVisitorHelper::stringify(json::JsonValueKind::Number)
                 );
+            case JsonIntegerConversion::OutOfRange:
+                throw BiliApiParseException(BiliApiParseException::json_parse_out_of_range, m_props_walk);
+            default:
+                break;
             }
-            if constexpr (std::numeric_limits<T>::is_signed) {
-                if (integer < std::numeric_limits<T>::min() || integer > std::numeric_limits<T>::max()) {
-                    throw BiliApiParseException(BiliApiParseException::json_parse_out_of_range, m_props_walk);
-                }
-            }
-            else {
-                if (integer < 0 || static_cast<unsigned long long>(integer) > std::numeric_limits<T>::max()) {
-                    throw BiliApiParseException(BiliApiParseException::json_parse_out_of_range, m_props_walk);
-                }
-            }
-            return static_cast<T>(integer);
+            return integer;
         }
 
-        winrt::Windows::Data::Json::IJsonValue m_jv;
+        json::JsonValueView m_jv;
         JsonPropsWalkTree& m_props_walk;
     };
 
     struct JsonObjectVisitor {
         JsonObjectVisitor(
-            winrt::Windows::Data::Json::JsonObject jo,
+            json::JsonObjectView jo,
             JsonPropsWalkTree& props_walk
         ) : m_jo(std::move(jo)), m_props_walk(props_walk) {}
 
         JsonPropsWalkTree& get_props_walk_tree(void) { return m_props_walk; }
 
         bool has_key(std::string_view key) {
-            return m_jo.HasKey(winrt::to_hstring(key));
+            return m_jo.contains(key);
         }
         template<typename Functor>
         auto scope(Functor&& func, std::string_view key) {
-            using winrt::Windows::Data::Json::JsonValueType;
+            using json::JsonValueKind;
             m_props_walk.push(key);
             deferred([this] {
                 m_props_walk.pop();
@@ -274,12 +298,12 @@ namespace BiliUWP {
             auto jv = expect_jo_lookup(m_jo, key);
             using ParamType = decltype(JsonVisitorHelper::get_fn_param_helper(func, 0, 0, 0));
             if constexpr (std::is_same_v<ParamType, JsonObjectVisitor>) {
-                expect_jv_type(jv, JsonValueType::Object);
-                return func(JsonObjectVisitor{ jv.GetObject(), m_props_walk });
+                expect_jv_type(jv, JsonValueKind::Object);
+                return func(JsonObjectVisitor{ jv.get_object(), m_props_walk });
             }
             else if constexpr (std::is_same_v<ParamType, JsonArrayVisitor>) {
-                expect_jv_type(jv, JsonValueType::Array);
-                return func(JsonArrayVisitor{ jv.GetArray(), m_props_walk });
+                expect_jv_type(jv, JsonValueKind::Array);
+                return func(JsonArrayVisitor{ jv.get_array(), m_props_walk });
             }
             else if constexpr (std::is_same_v<ParamType, JsonValueVisitor>) {
                 return func(JsonValueVisitor{ std::move(jv), m_props_walk });
@@ -291,8 +315,19 @@ namespace BiliUWP {
         template<typename Functor>
         auto scope_enumerate(Functor&& func) {
             // TODO: Maybe improve performance for scope_enumerate
-            for (auto&& kv : m_jo) {
-                this->scope(std::bind(func, kv.Key(), std::placeholders::_1), winrt::to_string(kv.Key()));
+            for (auto&& [key, jv] : m_jo) {
+                this->scope(std::bind(func, winrt::to_hstring(key), std::placeholders::_1), key);
+            }
+        }
+        // NOTE: Unlike scope_enumerate, properties are visited without looking them up again
+        template<typename Functor>
+        void scope_members(Functor&& func) {
+            for (auto&& [key, jv] : m_jo) {
+                m_props_walk.push(key);
+                deferred([this] {
+                    m_props_walk.pop();
+                });
+                func(key, JsonValueVisitor{ jv, m_props_walk });
             }
         }
         template<typename T>
@@ -310,13 +345,13 @@ namespace BiliUWP {
         // NOTE: std::nullopt will be stored only when the property does not exist
         template<typename T>
         void populate(std::optional<T>& dst, std::string_view key) {
-            if (auto jv = m_jo.TryLookup(winrt::to_hstring(key))) {
+            if (auto jv = m_jo.find(key)) {
                 T temp;
                 m_props_walk.push(key);
                 deferred([this] {
                     m_props_walk.pop();
                 });
-                JsonValueVisitor{ jv, m_props_walk }.populate(temp);
+                JsonValueVisitor{ *jv, m_props_walk }.populate(temp);
                 dst = std::move(temp);
             }
             else {
@@ -325,21 +360,21 @@ namespace BiliUWP {
         }
 
     private:
-        winrt::Windows::Data::Json::IJsonValue expect_jo_lookup(
-            winrt::Windows::Data::Json::JsonObject const& jo,
+        json::JsonValueView expect_jo_lookup(
+            json::JsonObjectView const& jo,
             std::string_view key
         ) {
-            auto jv = jo.TryLookup(winrt::to_hstring(key));
+            auto jv = jo.find(key);
             if (!jv) {
                 throw BiliApiParseException(BiliApiParseException::json_parse_no_prop, m_props_walk);
             }
-            return jv;
+            return *jv;
         }
         void expect_jv_type(
-            winrt::Windows::Data::Json::IJsonValue const& jv,
-            winrt::Windows::Data::Json::JsonValueType expected_type
+            json::JsonValueView const& jv,
+            json::JsonValueKind expected_type
         ) {
-            auto jvt = jv.ValueType();
+            auto jvt = jv.kind();
             if (jvt != expected_type) {
                 throw BiliApiParseException(BiliApiParseException::json_parse_wrong_type,
                     m_props_walk,
@@ -349,23 +384,23 @@ namespace BiliUWP {
             }
         }
 
-        winrt::Windows::Data::Json::JsonObject m_jo;
+        json::JsonObjectView m_jo;
         JsonPropsWalkTree& m_props_walk;
     };
     struct JsonArrayVisitor {
         JsonArrayVisitor(
-            winrt::Windows::Data::Json::JsonArray ja,
+            json::JsonArrayView ja,
             JsonPropsWalkTree& props_walk
         ) : m_ja(std::move(ja)), m_props_walk(props_walk) {}
 
         JsonPropsWalkTree& get_props_walk_tree(void) { return m_props_walk; }
 
         size_t size(void) {
-            return static_cast<size_t>(m_ja.Size());
+            return m_ja.size();
         }
         template<typename Functor>
         auto scope(Functor&& func, size_t idx) {
-            using winrt::Windows::Data::Json::JsonValueType;
+            using json::JsonValueKind;
             m_props_walk.push(idx);
             deferred([this] {
                 m_props_walk.pop();
@@ -373,12 +408,12 @@ namespace BiliUWP {
             auto jv = expect_ja_get(m_ja, idx);
             using ParamType = decltype(JsonVisitorHelper::get_fn_param_helper(func, 0, 0, 0));
             if constexpr (std::is_same_v<ParamType, JsonObjectVisitor>) {
-                expect_jv_type(jv, JsonValueType::Object);
-                return func(JsonObjectVisitor{ jv.GetObject(), m_props_walk });
+                expect_jv_type(jv, JsonValueKind::Object);
+                return func(JsonObjectVisitor{ jv.get_object(), m_props_walk });
             }
             else if constexpr (std::is_same_v<ParamType, JsonArrayVisitor>) {
-                expect_jv_type(jv, JsonValueType::Array);
-                return func(JsonArrayVisitor{ jv.GetArray(), m_props_walk });
+                expect_jv_type(jv, JsonValueKind::Array);
+                return func(JsonArrayVisitor{ jv.get_array(), m_props_walk });
             }
             else if constexpr (std::is_same_v<ParamType, JsonValueVisitor>) {
                 return func(JsonValueVisitor{ std::move(jv), m_props_walk });
@@ -390,7 +425,7 @@ namespace BiliUWP {
         template<typename T, typename Functor>
         auto scope_populate(Functor&& func, std::vector<T>& container) {
             // TODO: Maybe improve performance for scope_populate
-            auto size = m_ja.Size();
+            auto size = m_ja.size();
             container.clear();
             container.resize(size);
             for (decltype(size) i = 0; i < size; i++) {
@@ -400,9 +435,9 @@ namespace BiliUWP {
         template<typename Functor>
         auto scope_enumerate(Functor&& func) {
             // TODO: Maybe improve performance for scope_enumerate
-            auto size = m_ja.Size();
+            auto size = m_ja.size();
             for (decltype(size) i = 0; i < size; i++) {
-                this->scope(std::bind(func, static_cast<size_t>(i), std::placeholders::_1), i);
+                this->scope(std::bind(func, i, std::placeholders::_1), i);
             }
         }
         template<typename T>
@@ -420,24 +455,24 @@ namespace BiliUWP {
         }
 
     private:
-        winrt::Windows::Data::Json::IJsonValue expect_ja_get(
-            winrt::Windows::Data::Json::JsonArray const& ja,
+        json::JsonValueView expect_ja_get(
+            json::JsonArrayView const& ja,
             size_t idx
         ) {
-            auto size = static_cast<size_t>(ja.Size());
+            auto size = ja.size();
             if (idx >= size) {
                 throw BiliApiParseException(BiliApiParseException::json_parse_out_of_bound,
                     m_props_walk,
                     size
                 );
             }
-            return ja.GetAt(static_cast<uint32_t>(idx));
+            return ja[idx];
         }
         void expect_jv_type(
-            winrt::Windows::Data::Json::IJsonValue const& jv,
-            winrt::Windows::Data::Json::JsonValueType expected_type
+            json::JsonValueView const& jv,
+            json::JsonValueKind expected_type
         ) {
-            auto jvt = jv.ValueType();
+            auto jvt = jv.kind();
             if (jvt != expected_type) {
                 throw BiliApiParseException(BiliApiParseException::json_parse_wrong_type,
                     m_props_walk,
@@ -447,34 +482,253 @@ namespace BiliUWP {
             }
         }
 
-        winrt::Windows::Data::Json::JsonArray m_ja;
+        json::JsonArrayView m_ja;
         JsonPropsWalkTree& m_props_walk;
     };
 
     template<>
     std::optional<JsonObjectVisitor> JsonValueVisitor::try_as(void) {
-        if (m_jv.ValueType() != winrt::Windows::Data::Json::JsonValueType::Object) {
+        if (m_jv.kind() != json::JsonValueKind::Object) {
             return std::nullopt;
         }
-        return JsonObjectVisitor{ m_jv.GetObject(), m_props_walk };
+        return JsonObjectVisitor{ m_jv.get_object(), m_props_walk };
     }
     template<>
     std::optional<JsonArrayVisitor> JsonValueVisitor::try_as(void) {
-        if (m_jv.ValueType() != winrt::Windows::Data::Json::JsonValueType::Array) {
+        if (m_jv.kind() != json::JsonValueKind::Array) {
             return std::nullopt;
         }
-        return JsonArrayVisitor{ m_jv.GetArray(), m_props_walk };
+        return JsonArrayVisitor{ m_jv.get_array(), m_props_walk };
     }
     template<>
     JsonObjectVisitor JsonValueVisitor::as(void) {
-        expect_jv_type(m_jv, winrt::Windows::Data::Json::JsonValueType::Object);
-        return { m_jv.GetObject(), m_props_walk };
+        expect_jv_type(m_jv, json::JsonValueKind::Object);
+        return { m_jv.get_object(), m_props_walk };
     }
     template<>
     JsonArrayVisitor JsonValueVisitor::as(void) {
-        expect_jv_type(m_jv, winrt::Windows::Data::Json::JsonValueType::Array);
-        return { m_jv.GetArray(), m_props_walk };
+        expect_jv_type(m_jv, json::JsonValueKind::Array);
+        return { m_jv.get_array(), m_props_walk };
+    }
+
+    // NOTE: Missing or mistyped properties are reported as BiliApiParseException
+    void check_json_code(json::JsonObjectView const& jo) {
+        JsonPropsWalkTree json_props_walk;
+        JsonObjectVisitor jov{ jo, json_props_walk };
+        double code;
+        jov.populate(code, "code");
+        if (!try_check_api_code(code)) {
+            std::optional<winrt::hstring> message;
+            jov.populate(message, "message");
+            if (message) {
+                throw BiliApiUpstreamException(static_cast<ApiCode>(code), winrt::to_string(*message));
+            }
+        }
+    }
+
+    // Compile-time field descriptors for decoding json objects into structs
+    // Usage: Specialize JsonFieldTable<T> with `static constexpr std::array fields`, made of
+    //        json_field<&T::member>(key), json_field<&T::member, Adapter>(key) and
+    //        json_field_fn<T>(key, fn); JsonValueVisitor::as<T> will then be available
+    // NOTE: Properties must exist unless the member is std::optional, just like
+    //       JsonObjectVisitor::populate
+    template<typename T>
+    struct JsonField {
+        std::string_view key;
+        uint32_t key_hash;
+        void(*decode)(T& dst, JsonValueVisitor jvv);
+        bool optional;
+    };
+    template<typename T>
+    struct JsonFieldTable;
+
+    namespace field_details {
+        // FNV-1a
+        constexpr uint32_t key_hash(std::string_view key) {
+            uint32_t hash = 2166136261u;
+            for (char c : key) {
+                hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+            }
+            return hash;
+        }
+        template<typename>
+        struct member_pointer_traits;
+        template<typename C, typename M>
+        struct member_pointer_traits<M C::*> {
+            using class_type = C;
+            using member_type = M;
+        };
+        template<typename>
+        inline constexpr bool is_optional_v = false;
+        template<typename T>
+        inline constexpr bool is_optional_v<std::optional<T>> = true;
+
+        // pair<key_hash, field index>, sorted by hash
+        template<typename T>
+        inline constexpr auto field_index = [] {
+            constexpr auto& fields = JsonFieldTable<T>::fields;
+            std::array<std::pair<uint32_t, uint32_t>, std::size(fields)> result{};
+            for (size_t i = 0; i < result.size(); i++) {
+                result[i] = { fields[i].key_hash, static_cast<uint32_t>(i) };
+            }
+            std::sort(result.begin(), result.end());
+            return result;
+        }();
+    }
+
+    // NOTE: Adapter works the same as in JsonObjectVisitor::scope
+    template<auto Member, typename Adapter = void>
+    constexpr auto json_field(std::string_view key) {
+        using Traits = field_details::member_pointer_traits<decltype(Member)>;
+        using Class = typename Traits::class_type;
+        using MemberType = typename Traits::member_type;
+        JsonField<Class> result{ key, field_details::key_hash(key), nullptr, false };
+        if constexpr (std::is_void_v<Adapter>) {
+            result.optional = field_details::is_optional_v<MemberType>;
+            result.decode = [](Class& dst, JsonValueVisitor jvv) {
+                if constexpr (field_details::is_optional_v<MemberType>) {
+                    typename MemberType::value_type temp;
+                    jvv.populate(temp);
+                    dst.*Member = std::move(temp);
+                }
+                else {
+                    jvv.populate(dst.*Member);
+                }
+            };
+        }
+        else {
+            result.decode = [](Class& dst, JsonValueVisitor jvv) {
+                Adapter adapter{ dst.*Member };
+                using ParamType = decltype(JsonVisitorHelper::get_fn_param_helper(adapter, 0, 0, 0));
+                if constexpr (std::is_same_v<ParamType, JsonValueVisitor>) {
+                    adapter(std::move(jvv));
+                }
+                else {
+                    adapter(jvv.as<ParamType>());
+                }
+            };
+        }
+        return result;
+    }
+    template<typename T>
+    constexpr JsonField<T> json_field_fn(std::string_view key, void(*decode)(T& dst, JsonValueVisitor jvv)) {
+        return { key, field_details::key_hash(key), decode, false };
+    }
+
+    // Decodes all fields in a single pass over the object, dispatching on key hash
+    template<typename T>
+    T decode_json_fields(JsonValueVisitor jvv) {
+        constexpr auto& fields = JsonFieldTable<T>::fields;
+        constexpr auto& index = field_details::field_index<T>;
+        T result;
+        std::array<bool, std::size(fields)> seen{};
+        auto jov = jvv.as<JsonObjectVisitor>();
+        jov.scope_members([&](std::string_view key, JsonValueVisitor member_jvv) {
+            auto hash = field_details::key_hash(key);
+            auto it = std::lower_bound(index.begin(), index.end(), hash,
+                [](auto const& entry, uint32_t hash) { return entry.first < hash; }
+            );
+            for (; it != index.end() && it->first == hash; it++) {
+                auto& field = fields[it->second];
+                if (field.key == key) {
+                    field.decode(result, std::move(member_jvv));
+                    seen[it->second] = true;
+                    return;
+                }
+            }
+            // Unknown properties are ignored
+        });
+        for (size_t i = 0; i < seen.size(); i++) {
+            if (seen[i] || fields[i].optional) { continue; }
+            // Property is missing; let the lookup report it
+            jov.scope([&](JsonValueVisitor member_jvv) {
+                fields[i].decode(result, std::move(member_jvv));
+            }, fields[i].key);
+        }
+        return result;
     }
+
+    template<typename T>
+    T JsonValueVisitor::as(void) {
+        return decode_json_fields<T>(*this);
+    }
+
+    // Decodes an API response progressively while it is being received
+    // NOTE: Elements of the array at item_path are decoded one by one as soon as they are
+    //       complete, so the whole list never exists as a document; the rest of the
+    //       response is parsed in finish(), with that array left empty
+    // NOTE: If an element fails to decode, the rest are skipped but still read through, and
+    //       finish() reports the API error code of the response in preference to the failure
+    // NOTE: Keys in item_path must outlive the decoder
+    struct ApiJsonStreamDecoder {
+        static constexpr uint32_t READ_CHUNK_SIZE = 64 * 1024;
+
+        ApiJsonStreamDecoder(std::initializer_list<std::string_view> item_path) :
+            m_item_path(item_path),
+            m_splitter(std::vector<std::string>(item_path.begin(), item_path.end())),
+            m_buf(READ_CHUNK_SIZE), m_item_idx(0) {}
+
+        auto read_async(winrt::Windows::Storage::Streams::IInputStream const& stream) {
+            using winrt::Windows::Storage::Streams::InputStreamOptions;
+            return stream.ReadAsync(m_buf, READ_CHUNK_SIZE, InputStreamOptions::Partial);
+        }
+        // Calls func(JsonValueVisitor) for every element completed by buf
+        template<typename Functor>
+        void feed(
+            winrt::Windows::Storage::Streams::IBuffer const& buf,
+            JsonPropsWalkTree& props_walk,
+            Functor&& func
+        ) {
+            m_splitter.feed(reinterpret_cast<const char*>(buf.data()), buf.Length());
+            std::string_view item;
+            while (m_splitter.next_item(item)) {
+                if (m_item_error) { continue; }
+                try {
+                    json::JsonDocument item_doc;
+                    if (!item_doc.try_deserialize_from_utf8(item.data(), item.size())) {
+                        throw winrt::hresult_error(WEB_E_INVALID_JSON_STRING, L"API response is not valid JSON");
+                    }
+                    for (auto key : m_item_path) {
+                        props_walk.push(key);
+                    }
+                    props_walk.push(m_item_idx++);
+                    deferred([&] {
+                        for (size_t i = 0; i <= m_item_path.size(); i++) {
+                            props_walk.pop();
+                        }
+                    });
+                    func(JsonValueVisitor{ item_doc.root(), props_walk });
+                }
+                catch (...) {
+                    m_item_error = std::current_exception();
+                }
+            }
+        }
+        ApiJsonResponse finish(void) {
+            if (!m_splitter.is_complete()) {
+                if (m_item_error) { std::rethrow_exception(m_item_error); }
+                throw winrt::hresult_error(WEB_E_INVALID_JSON_STRING, L"API response ended unexpectedly");
+            }
+            if (m_item_error) {
+                ApiJsonResponse json_resp{ m_splitter.take_rest() };
+                auto jo = json_resp.root();
+                if (jo.find("code")) {
+                    check_json_code(jo);
+                    // NOTE: check_json_code only throws for responses carrying a message
+                    check_api_code(jo.at("code").get_value<double>());
+                }
+                std::rethrow_exception(m_item_error);
+            }
+            return ApiJsonResponse{ m_splitter.take_rest() };
+        }
+
+    private:
+        std::vector<std::string_view> m_item_path;
+        json::JsonArrayStreamSplitter m_splitter;
+        winrt::Windows::Storage::Streams::Buffer m_buf;
+        size_t m_item_idx;
+        std::exception_ptr m_item_error;
+    };
 }
 
 namespace BiliUWP {
@@ -588,337 +842,531 @@ namespace BiliUWP {
         };
     }
 
-    // User-defined as / try_as conversions
+    // User-defined field tables
     template<>
-    VideoViewInfo_Dimension JsonValueVisitor::as(void) {
-        VideoViewInfo_Dimension result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.width, "width");
-        jov.populate(result.height, "height");
-        jov.scope(adapter::assign_num_0_1_to_bool{ result.rotate }, "rotate");
-        return result;
-    }
+    struct JsonFieldTable<VideoViewInfo_Dimension> {
+        using T = VideoViewInfo_Dimension;
+        static constexpr std::array fields{
+            json_field<&T::width>("width"),
+            json_field<&T::height>("height"),
+            json_field<&T::rotate, adapter::assign_num_0_1_to_bool>("rotate"),
+        };
+    };
     template<>
-    VideoViewInfo_DescV2 JsonValueVisitor::as(void) {
-        VideoViewInfo_DescV2 result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.raw_text, "raw_text");
-        jov.populate(result.type, "type");
-        jov.populate(result.biz_id, "biz_id");
-        return result;
-    }
+    struct JsonFieldTable<VideoViewInfo_DescV2> {
+        using T = VideoViewInfo_DescV2;
+        static constexpr std::array fields{
+            json_field<&T::raw_text>("raw_text"),
+            json_field<&T::type>("type"),
+            json_field<&T::biz_id>("biz_id"),
+        };
+    };
     template<>
-    VideoViewInfo_Page JsonValueVisitor::as(void) {
-        VideoViewInfo_Page result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.cid, "cid");
-        jov.populate(result.page, "page");
-        jov.populate(result.from, "from");
-        jov.populate(result.part_title, "part");
-        jov.populate(result.duration, "duration");
-        jov.populate(result.external_vid, "vid");
-        jov.populate(result.external_weblink, "weblink");
-        jov.populate(result.dimension, "dimension");
-        return result;
-    }
+    struct JsonFieldTable<VideoViewInfo_Page> {
+        using T = VideoViewInfo_Page;
+        static constexpr std::array fields{
+            json_field<&T::cid>("cid"),
+            json_field<&T::page>("page"),
+            json_field<&T::from>("from"),
+            json_field<&T::part_title>("part"),
+            json_field<&T::duration>("duration"),
+            json_field<&T::external_vid>("vid"),
+            json_field<&T::external_weblink>("weblink"),
+            json_field<&T::dimension>("dimension"),
+        };
+    };
     template<>
-    VideoViewInfo_Subtitle JsonValueVisitor::as(void) {
-        VideoViewInfo_Subtitle result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.id, "id");
-        jov.populate(result.language, "lan");
-        jov.populate(result.language_doc, "lan_doc");
-        jov.populate(result.locked, "is_lock");
-        jov.populate(result.subtitle_url, "subtitle_url");
-        jov.scope([&](JsonObjectVisitor jov) {
-            jov.populate(result.author.mid, "mid");
-            jov.populate(result.author.name, "name");
-            jov.populate(result.author.sex, "sex");
-            jov.populate(result.author.face_url, "face");
-            jov.populate(result.author.sign, "sign");
-        }, "author");
-        return result;
-    }
+    struct JsonFieldTable<decltype(VideoViewInfo_Subtitle::author)> {
+        using T = decltype(VideoViewInfo_Subtitle::author);
+        static constexpr std::array fields{
+            json_field<&T::mid>("mid"),
+            json_field<&T::name>("name"),
+            json_field<&T::sex>("sex"),
+            json_field<&T::face_url>("face"),
+            json_field<&T::sign>("sign"),
+        };
+    };
     template<>
-    VideoViewInfo_Staff JsonValueVisitor::as(void) {
-        VideoViewInfo_Staff result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.mid, "mid");
-        jov.populate(result.title, "title");
-        jov.populate(result.name, "name");
-        jov.populate(result.face_url, "face");
-        jov.scope([&](JsonObjectVisitor jov) {
-            jov.populate(result.vip.type, "type");
-            jov.scope(adapter::assign_num_0_1_to_bool{ result.vip.is_vip }, "status");
-        }, "vip");
-        jov.scope([&](JsonObjectVisitor jov) {
-            jov.populate(result.official.role, "role");
-            jov.populate(result.official.title, "title");
-            jov.populate(result.official.desc, "desc");
-            jov.populate(result.official.type, "type");
-        }, "official");
-        jov.populate(result.follower_count, "follower");
-        return result;
-    }
+    struct JsonFieldTable<VideoViewInfo_Subtitle> {
+        using T = VideoViewInfo_Subtitle;
+        static constexpr std::array fields{
+            json_field<&T::id>("id"),
+            json_field<&T::language>("lan"),
+            json_field<&T::language_doc>("lan_doc"),
+            json_field<&T::locked>("is_lock"),
+            json_field<&T::subtitle_url>("subtitle_url"),
+            json_field<&T::author>("author"),
+        };
+    };
     template<>
-    VideoInfoV2_Subtitle JsonValueVisitor::as(void) {
-        VideoInfoV2_Subtitle result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.id, "id");
-        jov.populate(result.language, "lan");
-        jov.populate(result.language_doc, "lan_doc");
-        jov.populate(result.locked, "is_lock");
-        jov.populate(result.subtitle_url, "subtitle_url");
-        if (result.subtitle_url.starts_with(L"//")) {
-            result.subtitle_url = L"https:" + result.subtitle_url;
-        }
-        return result;
-    }
+    struct JsonFieldTable<decltype(VideoViewInfo_Staff::vip)> {
+        using T = decltype(VideoViewInfo_Staff::vip);
+        static constexpr std::array fields{
+            json_field<&T::type>("type"),
+            json_field<&T::is_vip, adapter::assign_num_0_1_to_bool>("status"),
+        };
+    };
     template<>
-    VideoPlayUrl_DurlPart JsonValueVisitor::as(void) {
-        VideoPlayUrl_DurlPart result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.order, "order");
-        jov.populate(result.length, "length");
-        jov.populate(result.size, "size");
-        jov.populate(result.ahead, "ahead");
-        jov.populate(result.vhead, "vhead");
-        jov.populate(result.url, "url");
-        jov.scope(adapter::assign_vec_or_null_as_empty{ result.backup_url }, "backup_url");
-        return result;
-    }
+    struct JsonFieldTable<decltype(VideoViewInfo_Staff::official)> {
+        using T = decltype(VideoViewInfo_Staff::official);
+        static constexpr std::array fields{
+            json_field<&T::role>("role"),
+            json_field<&T::title>("title"),
+            json_field<&T::desc>("desc"),
+            json_field<&T::type>("type"),
+        };
+    };
     template<>
-    VideoPlayUrl_Dash_Stream JsonValueVisitor::as(void) {
-        VideoPlayUrl_Dash_Stream result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.id, "id");
-        jov.populate(result.base_url, "base_url");
-        jov.scope(adapter::assign_vec_or_null_as_empty{ result.backup_url }, "backup_url");
-        jov.populate(result.bandwidth, "bandwidth");
-        jov.populate(result.mime_type, "mime_type");
-        jov.populate(result.codecs, "codecs");
-        jov.populate(result.width, "width");
-        jov.populate(result.height, "height");
-        jov.populate(result.frame_rate, "frame_rate");
-        jov.populate(result.sar, "sar");
-        jov.populate(result.start_with_sap, "start_with_sap");
-        jov.scope([&](JsonObjectVisitor jov) {
-            jov.populate(result.segment_base.initialization, "initialization");
-            jov.populate(result.segment_base.index_range, "index_range");
-        }, "segment_base");
-        jov.populate(result.codecid, "codecid");
-        return result;
-    }
+    struct JsonFieldTable<VideoViewInfo_Staff> {
+        using T = VideoViewInfo_Staff;
+        static constexpr std::array fields{
+            json_field<&T::mid>("mid"),
+            json_field<&T::title>("title"),
+            json_field<&T::name>("name"),
+            json_field<&T::face_url>("face"),
+            json_field<&T::vip>("vip"),
+            json_field<&T::official>("official"),
+            json_field<&T::follower_count>("follower"),
+        };
+    };
     template<>
-    VideoPlayUrl_Dash JsonValueVisitor::as(void) {
-        VideoPlayUrl_Dash result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.duration, "duration");
-        jov.populate(result.min_buffer_time, "min_buffer_time");
-        jov.populate(result.video, "video");
-        jov.scope(adapter::assign_vec_or_null_as_empty{ result.audio }, "audio");
-        return result;
-    }
+    struct JsonFieldTable<decltype(VideoViewInfoResult::rights)> {
+        using T = decltype(VideoViewInfoResult::rights);
+        static constexpr std::array fields{
+            json_field<&T::elec, adapter::assign_num_0_1_to_bool>("elec"),
+            json_field<&T::download, adapter::assign_num_0_1_to_bool>("download"),
+            json_field<&T::movie, adapter::assign_num_0_1_to_bool>("movie"),
+            json_field<&T::pay, adapter::assign_num_0_1_to_bool>("pay"),
+            json_field<&T::hd5, adapter::assign_num_0_1_to_bool>("hd5"),
+            json_field<&T::no_reprint, adapter::assign_num_0_1_to_bool>("no_reprint"),
+            json_field<&T::autoplay, adapter::assign_num_0_1_to_bool>("autoplay"),
+            json_field<&T::ugc_pay, adapter::assign_num_0_1_to_bool>("ugc_pay"),
+            json_field<&T::is_stein_gate, adapter::assign_num_0_1_to_bool>("is_stein_gate"),
+            json_field<&T::is_cooperation, adapter::assign_num_0_1_to_bool>("is_cooperation"),
+        };
+    };
     template<>
-    VideoPlayUrl_SupportFormat JsonValueVisitor::as(void) {
-        VideoPlayUrl_SupportFormat result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.quality, "quality");
-        jov.populate(result.format, "format");
-        jov.populate(result.new_description, "new_description");
-        jov.populate(result.display_desc, "display_desc");
-        jov.populate(result.superscript, "superscript");
-        jov.scope(adapter::assign_value_or_null_to_optional{ result.codecs }, "codecs");
-        return result;
-    }
+    struct JsonFieldTable<decltype(VideoViewInfoResult::owner)> {
+        using T = decltype(VideoViewInfoResult::owner);
+        static constexpr std::array fields{
+            json_field<&T::mid>("mid"),
+            json_field<&T::name>("name"),
+            json_field<&T::face_url>("face"),
+        };
+    };
     template<>
-    AudioPlayUrl_Quality JsonValueVisitor::as(void) {
-        AudioPlayUrl_Quality result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.scope(adapter::assign_num_to_enum{ result.type }, "type");
-        jov.populate(result.desc, "desc");
-        jov.populate(result.size, "size");
-        jov.populate(result.bps, "bps");
-        jov.populate(result.tag, "tag");
-        jov.scope(adapter::assign_num_0_1_to_bool{ result.require_membership }, "require");
-        jov.populate(result.require_membership_desc, "requiredesc");
-        return result;
-    }
+    struct JsonFieldTable<decltype(VideoViewInfoResult::stat)> {
+        using T = decltype(VideoViewInfoResult::stat);
+        static constexpr std::array fields{
+            json_field<&T::avid>("aid"),
+            json_field_fn<T>("view", [](T& dst, JsonValueVisitor jvv) {
+                if (jvv.as<int64_t>() < 0) {
+                    dst.view_count = std::nullopt;
+                }
+                else {
+                    jvv.populate(dst.view_count);
+                }
+            }),
+            json_field<&T::danmaku_count>("danmaku"),
+            json_field<&T::reply_count>("reply"),
+            json_field<&T::favorite_count>("favorite"),
+            json_field<&T::coin_count>("coin"),
+            json_field<&T::share_count>("share"),
+            json_field<&T::now_rank>("now_rank"),
+            json_field<&T::his_rank>("his_rank"),
+            json_field<&T::like_count>("like"),
+            json_field<&T::dislike_count>("dislike"),
+            json_field<&T::evaluation>("evaluation"),
+            json_field<&T::argue_msg>("argue_msg"),
+        };
+    };
     template<>
-    UserFavFoldersList_Folder JsonValueVisitor::as(void) {
-        UserFavFoldersList_Folder result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.id, "id");
-        jov.populate(result.fid, "fid");
-        jov.populate(result.mid, "mid");
-        jov.populate(result.attr, "attr");
-        jov.populate(result.title, "title");
-        jov.populate(result.cover_url, "cover");
-        jov.populate(result.cover_type, "cover_type");
-        jov.populate(result.intro, "intro");
-        jov.populate(result.ctime, "ctime");
-        jov.populate(result.mtime, "mtime");
-        jov.scope(adapter::assign_num_0_1_to_bool{ result.fav_has_item }, "fav_state");
-        jov.populate(result.media_count, "media_count");
-        return result;
-    }
+    struct JsonFieldTable<decltype(VideoViewInfoResult::subtitle)> {
+        using T = decltype(VideoViewInfoResult::subtitle);
+        static constexpr std::array fields{
+            json_field<&T::allow_submit>("allow_submit"),
+            json_field<&T::list>("list"),
+        };
+    };
     template<>
-    UserFavFoldersListAll_Folder JsonValueVisitor::as(void) {
-        UserFavFoldersListAll_Folder result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.id, "id");
-        jov.populate(result.fid, "fid");
-        jov.populate(result.mid, "mid");
-        jov.populate(result.attr, "attr");
-        jov.populate(result.title, "title");
-        jov.scope(adapter::assign_num_0_1_to_bool{ result.fav_has_item }, "fav_state");
-        jov.populate(result.media_count, "media_count");
-        return result;
-    }
+    struct JsonFieldTable<decltype(VideoViewInfoResult::user_garb)> {
+        using T = decltype(VideoViewInfoResult::user_garb);
+        static constexpr std::array fields{
+            json_field<&T::url_image_ani_cut>("url_image_ani_cut"),
+        };
+    };
     template<>
-    FavFolderResList_Media JsonValueVisitor::as(void) {
-        FavFolderResList_Media result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.nid, "id");
-        jov.scope(adapter::assign_num_to_enum{ result.type }, "type");
-        jov.populate(result.title, "title");
-        jov.populate(result.cover_url, "cover");
-        jov.populate(result.intro, "intro");
-        jov.populate(result.page_count, "page");
-        jov.populate(result.duration, "duration");
-        jov.scope([&](JsonObjectVisitor jov) {
-            jov.populate(result.upper.mid, "mid");
-            jov.populate(result.upper.name, "name");
-            jov.populate(result.upper.face_url, "face");
-        }, "upper");
-        jov.populate(result.attr, "attr");
-        jov.scope([&](JsonObjectVisitor jov) {
-            jov.populate(result.cnt_info.favourite_count, "collect");
-            jov.populate(result.cnt_info.play_count, "play");
-            jov.populate(result.cnt_info.danmaku_count, "danmaku");
-        }, "cnt_info");
-        jov.populate(result.res_link, "link");
-        jov.populate(result.ctime, "ctime");
-        jov.populate(result.pubtime, "pubtime");
-        jov.populate(result.fav_time, "fav_time");
-        jov.populate(result.bvid, "bvid");
-        return result;
-    }
+    struct JsonFieldTable<VideoViewInfoResult> {
+        using T = VideoViewInfoResult;
+        static constexpr std::array fields{
+            json_field<&T::bvid>("bvid"),
+            json_field<&T::avid>("aid"),
+            json_field<&T::videos_count>("videos"),
+            json_field<&T::tid>("tid"),
+            json_field<&T::tname>("tname"),
+            json_field<&T::copyright>("copyright"),
+            json_field<&T::cover_url>("pic"),
+            json_field<&T::title>("title"),
+            json_field<&T::pubdate>("pubdate"),
+            json_field<&T::ctime>("ctime"),
+            json_field<&T::desc>("desc"),
+            json_field<&T::desc_v2, adapter::assign_vec_or_null_as_empty<VideoViewInfo_DescV2>>("desc_v2"),
+            json_field<&T::state>("state"),
+            json_field<&T::duration>("duration"),
+            json_field<&T::forward_avid>("forward"),
+            json_field<&T::mission_id>("mission_id"),
+            json_field<&T::pgc_redirect_url>("redirect_url"),
+            json_field<&T::rights>("rights"),
+            json_field<&T::owner>("owner"),
+            json_field<&T::stat>("stat"),
+            json_field<&T::dynamic_text>("dynamic"),
+            json_field<&T::cid_1p>("cid"),
+            json_field<&T::dimension_1p>("dimension"),
+            json_field<&T::pages>("pages"),
+            json_field<&T::subtitle>("subtitle"),
+            json_field<&T::staff>("staff"),
+            json_field<&T::user_garb>("user_garb"),
+        };
+    };
     template<>
-    UserSpaceInfo_FansMedal_Medal JsonValueVisitor::as(void) {
-        UserSpaceInfo_FansMedal_Medal result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.uid, "uid");
-        jov.populate(result.target_uid, "target_id");
-        jov.populate(result.medal_id, "medal_id");
-        jov.populate(result.level, "level");
-        jov.populate(result.medal_name, "medal_name");
-        jov.populate(result.medal_color, "medal_color");
-        jov.populate(result.cur_intimacy, "intimacy");
-        jov.populate(result.next_intimacy, "next_intimacy");
-        jov.populate(result.intimacy_day_limit, "day_limit");
-        jov.populate(result.medal_color_start, "medal_color_start");
-        jov.populate(result.medal_color_end, "medal_color_end");
-        jov.populate(result.medal_color_border, "medal_color_border");
-        jov.scope(
-            adapter::assign_num_0_1_to_bool{ result.is_lighted }, "is_lighted");
-        jov.populate(result.light_status, "light_status");
-        jov.populate(result.wearing_status, "wearing_status");
-        jov.populate(result.score, "score");
-        return result;
-    }
+    struct JsonFieldTable<VideoInfoV2_Subtitle> {
+        using T = VideoInfoV2_Subtitle;
+        static constexpr std::array fields{
+            json_field<&T::id>("id"),
+            json_field<&T::language>("lan"),
+            json_field<&T::language_doc>("lan_doc"),
+            json_field<&T::locked>("is_lock"),
+            json_field_fn<T>("subtitle_url", [](T& dst, JsonValueVisitor jvv) {
+                jvv.populate(dst.subtitle_url);
+                if (dst.subtitle_url.starts_with(L"//")) {
+                    dst.subtitle_url = L"https:" + dst.subtitle_url;
+                }
+            }),
+        };
+    };
     template<>
-    UserSpaceInfo_LiveRoom JsonValueVisitor::as(void) {
-        UserSpaceInfo_LiveRoom result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.room_status, "roomStatus");
-        jov.populate(result.live_status, "liveStatus");
-        jov.populate(result.room_url, "url");
-        jov.populate(result.room_title, "title");
-        jov.populate(result.room_cover_url, "cover");
-        jov.scope([&](JsonObjectVisitor jov) {
-            jov.populate(result.watched_show.is_switched, "switch");
-            jov.populate(result.watched_show.total_watched_users, "num");
-            jov.populate(result.watched_show.text_small, "text_small");
-            jov.populate(result.watched_show.text_large, "text_large");
-            jov.populate(result.watched_show.icon_url, "icon");
-            jov.populate(result.watched_show.icon_location, "icon_location");
-            jov.populate(result.watched_show.icon_web_url, "icon_web");
-        }, "watched_show");
-        jov.populate(result.room_id, "roomid");
-        jov.scope(adapter::assign_num_0_1_to_bool{ result.is_rounding }, "roundStatus");
-        jov.populate(result.broadcast_type, "broadcast_type");
-        return result;
-    }
+    struct JsonFieldTable<VideoPlayUrl_DurlPart> {
+        using T = VideoPlayUrl_DurlPart;
+        static constexpr std::array fields{
+            json_field<&T::order>("order"),
+            json_field<&T::length>("length"),
+            json_field<&T::size>("size"),
+            json_field<&T::ahead>("ahead"),
+            json_field<&T::vhead>("vhead"),
+            json_field<&T::url>("url"),
+            json_field<&T::backup_url, adapter::assign_vec_or_null_as_empty<winrt::hstring>>("backup_url"),
+        };
+    };
     template<>
-    UserSpaceInfo_School JsonValueVisitor::as(void) {
-        UserSpaceInfo_School result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.name, "name");
-        return result;
-    }
+    struct JsonFieldTable<decltype(VideoPlayUrl_Dash_Stream::segment_base)> {
+        using T = decltype(VideoPlayUrl_Dash_Stream::segment_base);
+        static constexpr std::array fields{
+            json_field<&T::initialization>("initialization"),
+            json_field<&T::index_range>("index_range"),
+        };
+    };
     template<>
-    UserSpacePublishedVideos_Video JsonValueVisitor::as(void) {
-        UserSpacePublishedVideos_Video result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.avid, "aid");
-        jov.populate(result.author, "author");
-        jov.populate(result.bvid, "bvid");
-        jov.populate(result.comment_count, "comment");
-        jov.populate(result.copyright, "copyright");
-        jov.populate(result.publish_time, "created");
-        jov.populate(result.description, "description");
-        jov.scope(adapter::assign_num_0_1_to_bool{ result.is_pay }, "is_pay");
-        jov.scope(adapter::assign_num_0_1_to_bool{ result.is_union_video }, "is_union_video");
-        jov.populate(result.length_str, "length");
-        jov.populate(result.mid, "mid");
-        jov.populate(result.cover_url, "pic");
-        jov.scope([&](JsonValueVisitor jvv) {
-            if (jvv.try_as<winrt::hstring>() == L"--") {
-                result.play_count = std::nullopt;
-            }
-            else {
-                jvv.populate(result.play_count);
-            }
-        }, "play");
-        //jov.populate(result.play_count, "play");
-        jov.populate(result.review, "review");
-        jov.populate(result.subtitle, "subtitle");
-        jov.populate(result.title, "title");
-        jov.populate(result.tid, "typeid");
-        jov.populate(result.danmaku_count, "video_review");
-        return result;
-    }
+    struct JsonFieldTable<VideoPlayUrl_Dash_Stream> {
+        using T = VideoPlayUrl_Dash_Stream;
+        static constexpr std::array fields{
+            json_field<&T::id>("id"),
+            json_field<&T::base_url>("base_url"),
+            json_field<&T::backup_url, adapter::assign_vec_or_null_as_empty<winrt::hstring>>("backup_url"),
+            json_field<&T::bandwidth>("bandwidth"),
+            json_field<&T::mime_type>("mime_type"),
+            json_field<&T::codecs>("codecs"),
+            json_field<&T::width>("width"),
+            json_field<&T::height>("height"),
+            json_field<&T::frame_rate>("frame_rate"),
+            json_field<&T::sar>("sar"),
+            json_field<&T::start_with_sap>("start_with_sap"),
+            json_field<&T::segment_base>("segment_base"),
+            json_field<&T::codecid>("codecid"),
+        };
+    };
     template<>
-    UserSpacePublishedVideos_EpisodicButton JsonValueVisitor::as(void) {
-        UserSpacePublishedVideos_EpisodicButton result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.text, "text");
-        jov.populate(result.uri, "uri");
-        return result;
-    }
+    struct JsonFieldTable<VideoPlayUrl_Dash> {
+        using T = VideoPlayUrl_Dash;
+        static constexpr std::array fields{
+            json_field<&T::duration>("duration"),
+            json_field<&T::min_buffer_time>("min_buffer_time"),
+            json_field<&T::video>("video"),
+            json_field<&T::audio, adapter::assign_vec_or_null_as_empty<VideoPlayUrl_Dash_Stream>>("audio"),
+        };
+    };
     template<>
-    UserSpacePublishedAudios_Audio JsonValueVisitor::as(void) {
-        UserSpacePublishedAudios_Audio result;
-        auto jov = this->as<JsonObjectVisitor>();
-        jov.populate(result.id, "id");
-        jov.populate(result.mid, "uid");
-        jov.populate(result.uname, "uname");
-        jov.populate(result.title, "title");
-        jov.populate(result.cover_url, "cover");
-        jov.populate(result.duration, "duration");
-        jov.populate(result.coin_count, "coin_num");
-        jov.populate(result.passtime, "passtime");
-        jov.populate(result.ctime, "ctime");
-        jov.scope([&](JsonObjectVisitor jov) {
-            jov.populate(result.statistics.sid, "sid");
-            jov.populate(result.statistics.play_count, "play");
-            jov.populate(result.statistics.favourite_count, "collect");
-            jov.populate(result.statistics.comment_count, "comment");
-            jov.populate(result.statistics.share_count, "share");
-        }, "statistic");
-        return result;
-    }
+    struct JsonFieldTable<VideoPlayUrl_SupportFormat> {
+        using T = VideoPlayUrl_SupportFormat;
+        static constexpr std::array fields{
+            json_field<&T::quality>("quality"),
+            json_field<&T::format>("format"),
+            json_field<&T::new_description>("new_description"),
+            json_field<&T::display_desc>("display_desc"),
+            json_field<&T::superscript>("superscript"),
+            json_field<&T::codecs,
+                adapter::assign_value_or_null_to_optional<std::vector<winrt::hstring>>>("codecs"),
+        };
+    };
+    template<>
+    struct JsonFieldTable<AudioPlayUrl_Quality> {
+        using T = AudioPlayUrl_Quality;
+        static constexpr std::array fields{
+            json_field<&T::type, adapter::assign_num_to_enum<AudioQuality>>("type"),
+            json_field<&T::desc>("desc"),
+            json_field<&T::size>("size"),
+            json_field<&T::bps>("bps"),
+            json_field<&T::tag>("tag"),
+            json_field<&T::require_membership, adapter::assign_num_0_1_to_bool>("require"),
+            json_field<&T::require_membership_desc>("requiredesc"),
+        };
+    };
+    template<>
+    struct JsonFieldTable<UserFavFoldersList_Folder> {
+        using T = UserFavFoldersList_Folder;
+        static constexpr std::array fields{
+            json_field<&T::id>("id"),
+            json_field<&T::fid>("fid"),
+            json_field<&T::mid>("mid"),
+            json_field<&T::attr>("attr"),
+            json_field<&T::title>("title"),
+            json_field<&T::cover_url>("cover"),
+            json_field<&T::cover_type>("cover_type"),
+            json_field<&T::intro>("intro"),
+            json_field<&T::ctime>("ctime"),
+            json_field<&T::mtime>("mtime"),
+            json_field<&T::fav_has_item, adapter::assign_num_0_1_to_bool>("fav_state"),
+            json_field<&T::media_count>("media_count"),
+        };
+    };
+    template<>
+    struct JsonFieldTable<UserFavFoldersListAll_Folder> {
+        using T = UserFavFoldersListAll_Folder;
+        static constexpr std::array fields{
+            json_field<&T::id>("id"),
+            json_field<&T::fid>("fid"),
+            json_field<&T::mid>("mid"),
+            json_field<&T::attr>("attr"),
+            json_field<&T::title>("title"),
+            json_field<&T::fav_has_item, adapter::assign_num_0_1_to_bool>("fav_state"),
+            json_field<&T::media_count>("media_count"),
+        };
+    };
+    template<>
+    struct JsonFieldTable<decltype(FavFolderResList_Media::upper)> {
+        using T = decltype(FavFolderResList_Media::upper);
+        static constexpr std::array fields{
+            json_field<&T::mid>("mid"),
+            json_field<&T::name>("name"),
+            json_field<&T::face_url>("face"),
+        };
+    };
+    template<>
+    struct JsonFieldTable<decltype(FavFolderResList_Media::cnt_info)> {
+        using T = decltype(FavFolderResList_Media::cnt_info);
+        static constexpr std::array fields{
+            json_field<&T::favourite_count>("collect"),
+            json_field<&T::play_count>("play"),
+            json_field<&T::danmaku_count>("danmaku"),
+        };
+    };
+    template<>
+    struct JsonFieldTable<FavFolderResList_Media> {
+        using T = FavFolderResList_Media;
+        static constexpr std::array fields{
+            json_field<&T::nid>("id"),
+            json_field<&T::type, adapter::assign_num_to_enum<ResItemType>>("type"),
+            json_field<&T::title>("title"),
+            json_field<&T::cover_url>("cover"),
+            json_field<&T::intro>("intro"),
+            json_field<&T::page_count>("page"),
+            json_field<&T::duration>("duration"),
+            json_field<&T::upper>("upper"),
+            json_field<&T::attr>("attr"),
+            json_field<&T::cnt_info>("cnt_info"),
+            json_field<&T::res_link>("link"),
+            json_field<&T::ctime>("ctime"),
+            json_field<&T::pubtime>("pubtime"),
+            json_field<&T::fav_time>("fav_time"),
+            json_field<&T::bvid>("bvid"),
+        };
+    };
+    template<>
+    struct JsonFieldTable<decltype(decltype(FavFolderResListResult::info)::upper)> {
+        using T = decltype(decltype(FavFolderResListResult::info)::upper);
+        static constexpr std::array fields{
+            json_field<&T::mid>("mid"),
+            json_field<&T::name>("name"),
+            json_field<&T::face_url>("face"),
+            json_field<&T::followed>("followed"),
+            json_field<&T::vip_type>("vip_type"),
+            json_field<&T::is_vip, adapter::assign_num_0_1_to_bool>("vip_statue"),
+        };
+    };
+    template<>
+    struct JsonFieldTable<decltype(decltype(FavFolderResListResult::info)::cnt_info)> {
+        using T = decltype(decltype(FavFolderResListResult::info)::cnt_info);
+        static constexpr std::array fields{
+            json_field<&T::favourite_count>("collect"),
+            json_field<&T::play_count>("play"),
+            json_field<&T::like_count>("thumb_up"),
+            json_field<&T::share_count>("share"),
+        };
+    };
+    template<>
+    struct JsonFieldTable<decltype(FavFolderResListResult::info)> {
+        using T = decltype(FavFolderResListResult::info);
+        static constexpr std::array fields{
+            json_field<&T::id>("id"),
+            json_field<&T::fid>("fid"),
+            json_field<&T::mid>("mid"),
+            json_field<&T::attr>("attr"),
+            json_field<&T::title>("title"),
+            json_field<&T::cover_url>("cover"),
+            json_field<&T::upper>("upper"),
+            json_field<&T::cover_type>("cover_type"),
+            json_field<&T::cnt_info>("cnt_info"),
+            json_field<&T::type>("type"),
+            json_field<&T::intro>("intro"),
+            json_field<&T::ctime>("ctime"),
+            json_field<&T::mtime>("mtime"),
+            json_field<&T::state>("state"),
+            json_field<&T::fav_has_item, adapter::assign_num_0_1_to_bool>("fav_state"),
+            json_field<&T::is_liked, adapter::assign_num_0_1_to_bool>("like_state"),
+            json_field<&T::media_count>("media_count"),
+        };
+    };
+    template<>
+    struct JsonFieldTable<FavFolderResListResult> {
+        using T = FavFolderResListResult;
+        static constexpr std::array fields{
+            json_field<&T::info>("info"),
+            json_field<&T::media_list, adapter::assign_vec_or_null_as_empty<FavFolderResList_Media>>("medias"),
+            json_field<&T::has_more>("has_more"),
+        };
+    };
+    template<>
+    struct JsonFieldTable<UserSpaceInfo_FansMedal_Medal> {
+        using T = UserSpaceInfo_FansMedal_Medal;
+        static constexpr std::array fields{
+            json_field<&T::uid>("uid"),
+            json_field<&T::target_uid>("target_id"),
+            json_field<&T::medal_id>("medal_id"),
+            json_field<&T::level>("level"),
+            json_field<&T::medal_name>("medal_name"),
+            json_field<&T::medal_color>("medal_color"),
+            json_field<&T::cur_intimacy>("intimacy"),
+            json_field<&T::next_intimacy>("next_intimacy"),
+            json_field<&T::intimacy_day_limit>("day_limit"),
+            json_field<&T::medal_color_start>("medal_color_start"),
+            json_field<&T::medal_color_end>("medal_color_end"),
+            json_field<&T::medal_color_border>("medal_color_border"),
+            json_field<&T::is_lighted, adapter::assign_num_0_1_to_bool>("is_lighted"),
+            json_field<&T::light_status>("light_status"),
+            json_field<&T::wearing_status>("wearing_status"),
+            json_field<&T::score>("score"),
+        };
+    };
+    template<>
+    struct JsonFieldTable<decltype(UserSpaceInfo_LiveRoom::watched_show)> {
+        using T = decltype(UserSpaceInfo_LiveRoom::watched_show);
+        static constexpr std::array fields{
+            json_field<&T::is_switched>("switch"),
+            json_field<&T::total_watched_users>("num"),
+            json_field<&T::text_small>("text_small"),
+            json_field<&T::text_large>("text_large"),
+            json_field<&T::icon_url>("icon"),
+            json_field<&T::icon_location>("icon_location"),
+            json_field<&T::icon_web_url>("icon_web"),
+        };
+    };
+    template<>
+    struct JsonFieldTable<UserSpaceInfo_LiveRoom> {
+        using T = UserSpaceInfo_LiveRoom;
+        static constexpr std::array fields{
+            json_field<&T::room_status>("roomStatus"),
+            json_field<&T::live_status>("liveStatus"),
+            json_field<&T::room_url>("url"),
+            json_field<&T::room_title>("title"),
+            json_field<&T::room_cover_url>("cover"),
+            json_field<&T::watched_show>("watched_show"),
+            json_field<&T::room_id>("roomid"),
+            json_field<&T::is_rounding, adapter::assign_num_0_1_to_bool>("roundStatus"),
+            json_field<&T::broadcast_type>("broadcast_type"),
+        };
+    };
+    template<>
+    struct JsonFieldTable<UserSpaceInfo_School> {
+        using T = UserSpaceInfo_School;
+        static constexpr std::array fields{
+            json_field<&T::name>("name"),
+        };
+    };
+    template<>
+    struct JsonFieldTable<UserSpacePublishedVideos_Video> {
+        using T = UserSpacePublishedVideos_Video;
+        static constexpr std::array fields{
+            json_field<&T::avid>("aid"),
+            json_field<&T::author>("author"),
+            json_field<&T::bvid>("bvid"),
+            json_field<&T::comment_count>("comment"),
+            json_field<&T::copyright>("copyright"),
+            json_field<&T::publish_time>("created"),
+            json_field<&T::description>("description"),
+            json_field<&T::is_pay, adapter::assign_num_0_1_to_bool>("is_pay"),
+            json_field<&T::is_union_video, adapter::assign_num_0_1_to_bool>("is_union_video"),
+            json_field<&T::length_str>("length"),
+            json_field<&T::mid>("mid"),
+            json_field<&T::cover_url>("pic"),
+            json_field_fn<T>("play", [](T& dst, JsonValueVisitor jvv) {
+                if (jvv.try_as<winrt::hstring>() == L"--") {
+                    dst.play_count = std::nullopt;
+                }
+                else {
+                    jvv.populate(dst.play_count);
+                }
+            }),
+            json_field<&T::review>("review"),
+            json_field<&T::subtitle>("subtitle"),
+            json_field<&T::title>("title"),
+            json_field<&T::tid>("typeid"),
+            json_field<&T::danmaku_count>("video_review"),
+        };
+    };
+    template<>
+    struct JsonFieldTable<UserSpacePublishedVideos_EpisodicButton> {
+        using T = UserSpacePublishedVideos_EpisodicButton;
+        static constexpr std::array fields{
+            json_field<&T::text>("text"),
+            json_field<&T::uri>("uri"),
+        };
+    };
+    template<>
+    struct JsonFieldTable<decltype(UserSpacePublishedAudios_Audio::statistics)> {
+        using T = decltype(UserSpacePublishedAudios_Audio::statistics);
+        static constexpr std::array fields{
+            json_field<&T::sid>("sid"),
+            json_field<&T::play_count>("play"),
+            json_field<&T::favourite_count>("collect"),
+            json_field<&T::comment_count>("comment"),
+            json_field<&T::share_count>("share"),
+        };
+    };
+    template<>
+    struct JsonFieldTable<UserSpacePublishedAudios_Audio> {
+        using T = UserSpacePublishedAudios_Audio;
+        static constexpr std::array fields{
+            json_field<&T::id>("id"),
+            json_field<&T::mid>("uid"),
+            json_field<&T::uname>("uname"),
+            json_field<&T::title>("title"),
+            json_field<&T::cover_url>("cover"),
+            json_field<&T::duration>("duration"),
+            json_field<&T::coin_count>("coin_num"),
+            json_field<&T::passtime>("passtime"),
+            json_field<&T::ctime>("ctime"),
+            json_field<&T::statistics>("statistic"),
+        };
+    };
 
     BiliClient::BiliClient() :
         m_bili_client(winrt::BiliUWP::BiliClientManaged()), m_refresh_token() {}
@@ -955,13 +1403,14 @@ namespace BiliUWP {
         auto cancellation_token = co_await winrt::get_cancellation_token();
         cancellation_token.enable_propagation();
 
-        auto jo = co_await m_bili_client.api_passport_x_passport_tv_login_qrcode_auth_code(
+        ApiJsonResponse json_resp{ co_await m_bili_client.api_passport_x_passport_tv_login_qrcode_auth_code(
             keys::api_tv_1, local_id
-        );
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
+        ) };
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
         check_json_code(jo);
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
+        JsonObjectVisitor jov{ jo, json_props_walk };
         jov.scope([&](JsonObjectVisitor jov) {
             jov.populate(result.url, "url");
             jov.populate(result.auth_code, "auth_code");
@@ -978,12 +1427,13 @@ namespace BiliUWP {
         auto cancellation_token = co_await winrt::get_cancellation_token();
         cancellation_token.enable_propagation();
 
-        auto jo = co_await m_bili_client.api_passport_x_passport_tv_login_qrcode_poll(
+        ApiJsonResponse json_resp{ co_await m_bili_client.api_passport_x_passport_tv_login_qrcode_poll(
             keys::api_tv_1, auth_code, local_id
-        );
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
+        ) };
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
+        JsonObjectVisitor jov{ jo, json_props_walk };
         double code;
         jov.populate(code, "code");
         result.code = static_cast<ApiCode>(code);
@@ -1041,13 +1491,14 @@ namespace BiliUWP {
         auto cancellation_token = co_await winrt::get_cancellation_token();
         cancellation_token.enable_propagation();
 
-        auto jo = co_await m_bili_client.api_passport_api_v2_oauth2_refresh_token(
+        ApiJsonResponse json_resp{ co_await m_bili_client.api_passport_api_v2_oauth2_refresh_token(
             m_api_sign_keys, m_refresh_token
-        );
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
+        ) };
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
         check_json_code(jo);
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
+        JsonObjectVisitor jov{ jo, json_props_walk };
         jov.scope([&](JsonObjectVisitor jov) {
             jov.scope([&](JsonObjectVisitor jov) {
                 jov.populate(result.mid, "mid");
@@ -1094,11 +1545,12 @@ namespace BiliUWP {
         auto cancellation_token = co_await winrt::get_cancellation_token();
         cancellation_token.enable_propagation();
 
-        auto jo = co_await m_bili_client.api_passport_x_passport_login_revoke(keys::api_android_1);
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
+        ApiJsonResponse json_resp{ co_await m_bili_client.api_passport_x_passport_login_revoke(keys::api_android_1) };
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
         check_json_code(jo);
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
+        JsonObjectVisitor jov{ jo, json_props_walk };
         // TODO: Breakpoint here to verify actual JSON response
 
         // Update self data
@@ -1116,11 +1568,12 @@ namespace BiliUWP {
         auto cancellation_token = co_await winrt::get_cancellation_token();
         cancellation_token.enable_propagation();
 
-        auto jo = co_await m_bili_client.api_api_x_web_interface_nav();
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
+        ApiJsonResponse json_resp{ co_await m_bili_client.api_api_x_web_interface_nav() };
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
         check_json_code(jo);
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
+        JsonObjectVisitor jov{ jo, json_props_walk };
         jov.scope([&](JsonObjectVisitor jov) {
             jov.populate(result.logged_in, "isLogin");
             jov.scope(adapter::assign_num_0_1_to_bool{ result.email_verified }, "email_verified");
@@ -1180,11 +1633,12 @@ namespace BiliUWP {
         auto cancellation_token = co_await winrt::get_cancellation_token();
         cancellation_token.enable_propagation();
 
-        auto jo = co_await m_bili_client.api_api_x_web_interface_nav_stat();
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
+        ApiJsonResponse json_resp{ co_await m_bili_client.api_api_x_web_interface_nav_stat() };
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
         check_json_code(jo);
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
+        JsonObjectVisitor jov{ jo, json_props_walk };
         jov.scope([&](JsonObjectVisitor jov) {
             jov.populate(result.following_count, "following");
             jov.populate(result.follower_count, "follower");
@@ -1199,11 +1653,12 @@ namespace BiliUWP {
         auto cancellation_token = co_await winrt::get_cancellation_token();
         cancellation_token.enable_propagation();
 
-        auto jo = co_await m_bili_client.api_api_x_web_interface_card(mid, true);
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
+        ApiJsonResponse json_resp{ co_await m_bili_client.api_api_x_web_interface_card(mid, true) };
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
         check_json_code(jo);
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
+        JsonObjectVisitor jov{ jo, json_props_walk };
         jov.scope([&](JsonObjectVisitor jov) {
             jov.scope([&](JsonObjectVisitor jov) {
                 jov.populate(result.card.mid, "mid");
@@ -1260,11 +1715,12 @@ namespace BiliUWP {
         auto cancellation_token = co_await winrt::get_cancellation_token();
         cancellation_token.enable_propagation();
 
-        auto jo = co_await m_bili_client.api_api_x_space_acc_info(mid);
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
+        ApiJsonResponse json_resp{ co_await m_bili_client.api_api_x_space_acc_info(mid) };
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
         check_json_code(jo);
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
+        JsonObjectVisitor jov{ jo, json_props_walk };
         jov.scope([&](JsonObjectVisitor jov) {
             jov.populate(result.mid, "mid");
             jov.populate(result.name, "name");
@@ -1369,11 +1825,12 @@ namespace BiliUWP {
         auto cancellation_token = co_await winrt::get_cancellation_token();
         cancellation_token.enable_propagation();
 
-        auto jo = co_await m_bili_client.api_api_x_space_upstat(mid);
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
+        ApiJsonResponse json_resp{ co_await m_bili_client.api_api_x_space_upstat(mid) };
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
         check_json_code(jo);
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
+        JsonObjectVisitor jov{ jo, json_props_walk };
         jov.scope([&](JsonObjectVisitor jov) {
             jov.scope([&](JsonObjectVisitor jov) {
                 jov.populate(result.archive.view_count, "view");
@@ -1410,13 +1867,24 @@ namespace BiliUWP {
         default:
             throw winrt::hresult_invalid_argument();
         }
-        auto jo = co_await m_bili_client.api_api_x_space_arc_search(
+        auto stream = co_await m_bili_client.api_api_x_space_arc_search(
             mid, winrt::BiliUWP::ApiParam_Page{ page.n, page.size }, search_keyword, 0, param_order
         );
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
-        check_json_code(jo);
+        ApiJsonStreamDecoder decoder{ "data", "list", "vlist" };
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
+        std::vector<UserSpacePublishedVideos_Video> video_list;
+        while (true) {
+            auto buf = co_await decoder.read_async(stream);
+            if (buf.Length() == 0) { break; }
+            decoder.feed(buf, json_props_walk, [&](JsonValueVisitor jvv) {
+                video_list.push_back(jvv.as<UserSpacePublishedVideos_Video>());
+            });
+        }
+        auto json_resp = decoder.finish();
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
+        check_json_code(jo);
+        JsonObjectVisitor jov{ jo, json_props_walk };
         jov.scope([&](JsonObjectVisitor jov) {
             jov.scope([&](JsonObjectVisitor jov) {
                 jov.scope([&](JsonObjectVisitor jov) {
@@ -1443,6 +1911,8 @@ namespace BiliUWP {
             }, "page");
             jov.populate(result.episodic_button, "episodic_button");
         }, "data");
+        // NOTE: vlist was left empty in the remaining document
+        result.list.vlist = std::move(video_list);
 
         co_return result;
     }
@@ -1470,13 +1940,14 @@ namespace BiliUWP {
         default:
             throw winrt::hresult_invalid_argument();
         }
-        auto jo = co_await m_bili_client.api_api_audio_music_service_web_song_upper(
+        ApiJsonResponse json_resp{ co_await m_bili_client.api_api_audio_music_service_web_song_upper(
             mid, winrt::BiliUWP::ApiParam_Page{ page.n, page.size }, param_order
-        );
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
+        ) };
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
         check_json_code(jo);
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
+        JsonObjectVisitor jov{ jo, json_props_walk };
         jov.scope([&](JsonObjectVisitor jov) {
             jov.populate(result.cur_page, "curPage");
             jov.populate(result.page_count, "pageCount");
@@ -1512,82 +1983,13 @@ namespace BiliUWP {
             }
         }, vid);
 
-        auto jo = co_await m_bili_client.api_api_x_web_interface_view(avid, bvid);
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
+        ApiJsonResponse json_resp{ co_await m_bili_client.api_api_x_web_interface_view(avid, bvid) };
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
         check_json_code(jo);
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
-        jov.scope([&](JsonObjectVisitor jov) {
-            jov.populate(result.bvid, "bvid");
-            jov.populate(result.avid, "aid");
-            jov.populate(result.videos_count, "videos");
-            jov.populate(result.tid, "tid");
-            jov.populate(result.tname, "tname");
-            jov.populate(result.copyright, "copyright");
-            jov.populate(result.cover_url, "pic");
-            jov.populate(result.title, "title");
-            jov.populate(result.pubdate, "pubdate");
-            jov.populate(result.ctime, "ctime");
-            jov.populate(result.desc, "desc");
-            jov.scope(adapter::assign_vec_or_null_as_empty{ result.desc_v2 }, "desc_v2");
-            jov.populate(result.state, "state");
-            jov.populate(result.duration, "duration");
-            jov.populate(result.forward_avid, "forward");
-            jov.populate(result.mission_id, "mission_id");
-            jov.populate(result.pgc_redirect_url, "redirect_url");
-            jov.scope([&](JsonObjectVisitor jov) {
-                jov.scope(adapter::assign_num_0_1_to_bool{ result.rights.elec }, "elec");
-                jov.scope(adapter::assign_num_0_1_to_bool{ result.rights.download }, "download");
-                jov.scope(adapter::assign_num_0_1_to_bool{ result.rights.movie }, "movie");
-                jov.scope(adapter::assign_num_0_1_to_bool{ result.rights.pay }, "pay");
-                jov.scope(adapter::assign_num_0_1_to_bool{ result.rights.hd5 }, "hd5");
-                jov.scope(adapter::assign_num_0_1_to_bool{ result.rights.no_reprint }, "no_reprint");
-                jov.scope(adapter::assign_num_0_1_to_bool{ result.rights.autoplay }, "autoplay");
-                jov.scope(adapter::assign_num_0_1_to_bool{ result.rights.ugc_pay }, "ugc_pay");
-                jov.scope(adapter::assign_num_0_1_to_bool{ result.rights.is_stein_gate }, "is_stein_gate");
-                jov.scope(adapter::assign_num_0_1_to_bool{ result.rights.is_cooperation }, "is_cooperation");
-            }, "rights");
-            jov.scope([&](JsonObjectVisitor jov) {
-                jov.populate(result.owner.mid, "mid");
-                jov.populate(result.owner.name, "name");
-                jov.populate(result.owner.face_url, "face");
-            }, "owner");
-            jov.scope([&](JsonObjectVisitor jov) {
-                jov.populate(result.stat.avid, "aid");
-                jov.scope([&](JsonValueVisitor jvv) {
-                    if (jvv.as<int64_t>() < 0) {
-                        result.stat.view_count = std::nullopt;
-                    }
-                    else {
-                        jvv.populate(result.stat.view_count);
-                    }
-                }, "view");
-                //jov.populate(result.stat.view_count, "view");
-                jov.populate(result.stat.danmaku_count, "danmaku");
-                jov.populate(result.stat.reply_count, "reply");
-                jov.populate(result.stat.favorite_count, "favorite");
-                jov.populate(result.stat.coin_count, "coin");
-                jov.populate(result.stat.share_count, "share");
-                jov.populate(result.stat.now_rank, "now_rank");
-                jov.populate(result.stat.his_rank, "his_rank");
-                jov.populate(result.stat.like_count, "like");
-                jov.populate(result.stat.dislike_count, "dislike");
-                jov.populate(result.stat.evaluation, "evaluation");
-                jov.populate(result.stat.argue_msg, "argue_msg");
-            }, "stat");
-            jov.populate(result.dynamic_text, "dynamic");
-            jov.populate(result.cid_1p, "cid");
-            jov.populate(result.dimension_1p, "dimension");
-            jov.populate(result.pages, "pages");
-            jov.scope([&](JsonObjectVisitor jov) {
-                jov.populate(result.subtitle.allow_submit, "allow_submit");
-                jov.populate(result.subtitle.list, "list");
-            }, "subtitle");
-            jov.populate(result.staff, "staff");
-            jov.scope([&](JsonObjectVisitor jov) {
-                jov.populate(result.user_garb.url_image_ani_cut, "url_image_ani_cut");
-            }, "user_garb");
-        }, "data");
+        JsonObjectVisitor jov{ jo, json_props_walk };
+        jov.populate(result, "data");
 
         co_return result;
     }
@@ -1619,11 +2021,12 @@ namespace BiliUWP {
             }
         }, vid);
 
-        auto jo = co_await m_bili_client.api_api_x_player_v2(avid, bvid, cid);
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
+        ApiJsonResponse json_resp{ co_await m_bili_client.api_api_x_player_v2(avid, bvid, cid) };
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
         check_json_code(jo);
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
+        JsonObjectVisitor jov{ jo, json_props_walk };
         jov.scope([&](JsonObjectVisitor jov) {
             jov.populate(result.avid, "aid");
             jov.populate(result.bvid, "bvid");
@@ -1669,11 +2072,12 @@ namespace BiliUWP {
         api_prefers.prefer_8k = prefers.prefer_8k;
         api_prefers.prefer_av1 = prefers.prefer_av1;
 
-        auto jo = co_await m_bili_client.api_api_x_player_playurl(avid, bvid, cid, api_prefers);
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
+        ApiJsonResponse json_resp{ co_await m_bili_client.api_api_x_player_playurl(avid, bvid, cid, api_prefers) };
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
         check_json_code(jo);
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
+        JsonObjectVisitor jov{ jo, json_props_walk };
         jov.scope([&](JsonObjectVisitor jov) {
             jov.populate(result.from, "from");
             jov.populate(result.result, "result");
@@ -1719,11 +2123,22 @@ namespace BiliUWP {
             }
         }, vid);
 
-        auto jo = co_await m_bili_client.api_api_x_player_videoshot(avid, bvid, cid, load_indices);
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
-        check_json_code(jo);
+        auto stream = co_await m_bili_client.api_api_x_player_videoshot(avid, bvid, cid, load_indices);
+        ApiJsonStreamDecoder decoder{ "data", "index" };
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
+        std::vector<uint64_t> indices;
+        while (true) {
+            auto buf = co_await decoder.read_async(stream);
+            if (buf.Length() == 0) { break; }
+            decoder.feed(buf, json_props_walk, [&](JsonValueVisitor jvv) {
+                indices.push_back(jvv.as<uint64_t>());
+            });
+        }
+        auto json_resp = decoder.finish();
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
+        check_json_code(jo);
+        JsonObjectVisitor jov{ jo, json_props_walk };
         jov.scope([&](JsonObjectVisitor jov) {
             jov.populate(result.pvdata_url, "pvdata");
             jov.populate(result.img_x_len, "img_x_len");
@@ -1733,6 +2148,8 @@ namespace BiliUWP {
             jov.populate(result.images_url, "image");
             jov.populate(result.indices, "index");
         }, "data");
+        // NOTE: index was left empty in the remaining document
+        result.indices = std::move(indices);
 
         co_return result;
     }
@@ -1744,11 +2161,12 @@ namespace BiliUWP {
         auto cancellation_token = co_await winrt::get_cancellation_token();
         cancellation_token.enable_propagation();
 
-        auto jo = co_await m_bili_client.api_www_audio_music_service_c_web_song_info(auid);
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
+        ApiJsonResponse json_resp{ co_await m_bili_client.api_www_audio_music_service_c_web_song_info(auid) };
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
         check_json_code(jo);
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
+        JsonObjectVisitor jov{ jo, json_props_walk };
         jov.scope([&](JsonObjectVisitor jov) {
             jov.populate(result.auid, "id");
             jov.populate(result.uid, "uid");
@@ -1790,13 +2208,14 @@ namespace BiliUWP {
         auto cancellation_token = co_await winrt::get_cancellation_token();
         cancellation_token.enable_propagation();
 
-        auto jo = co_await m_bili_client.api_api_audio_music_service_c_url(
+        ApiJsonResponse json_resp{ co_await m_bili_client.api_api_audio_music_service_c_url(
             auid, static_cast<uint32_t>(quality)
-        );
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
+        ) };
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
         check_json_code(jo);
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
+        JsonObjectVisitor jov{ jo, json_props_walk };
         jov.scope([&](JsonObjectVisitor jov) {
             jov.populate(result.auid, "sid");
             jov.scope(adapter::assign_num_to_enum{ result.type }, "type");
@@ -1820,18 +2239,19 @@ namespace BiliUWP {
         auto cancellation_token = co_await winrt::get_cancellation_token();
         cancellation_token.enable_propagation();
 
-        auto jo = co_await m_bili_client.api_api_x_v3_fav_folder_created_list(
+        ApiJsonResponse json_resp{ co_await m_bili_client.api_api_x_v3_fav_folder_created_list(
             mid, winrt::BiliUWP::ApiParam_Page{ page.n, page.size },
             item_to_find.transform([](FavItemLookupParam v) {
                 return winrt::BiliUWP::ApiParam_FavItemLookup{
                     v.nid, static_cast<winrt::BiliUWP::ApiData_ResType>(v.type)
                 };
             })
-        );
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
+        ) };
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
         check_json_code(jo);
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
+        JsonObjectVisitor jov{ jo, json_props_walk };
         jov.scope([&](JsonObjectVisitor jov) {
             jov.populate(result.count, "count");
             jov.populate(result.list, "list");
@@ -1848,17 +2268,18 @@ namespace BiliUWP {
         auto cancellation_token = co_await winrt::get_cancellation_token();
         cancellation_token.enable_propagation();
 
-        auto jo = co_await m_bili_client.api_api_x_v3_fav_folder_created_list_all(
+        ApiJsonResponse json_resp{ co_await m_bili_client.api_api_x_v3_fav_folder_created_list_all(
             mid, item_to_find.transform([](FavItemLookupParam v) {
                 return winrt::BiliUWP::ApiParam_FavItemLookup{
                     v.nid, static_cast<winrt::BiliUWP::ApiData_ResType>(v.type)
                 };
             })
-        );
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
+        ) };
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
         check_json_code(jo);
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
+        JsonObjectVisitor jov{ jo, json_props_walk };
         jov.scope([&](JsonObjectVisitor jov) {
             jov.populate(result.count, "count");
             jov.populate(result.list, "list");
@@ -1890,48 +2311,27 @@ namespace BiliUWP {
         default:
             throw winrt::hresult_invalid_argument();
         }
-        auto jo = co_await m_bili_client.api_api_x_v3_fav_resource_list(
+        auto stream = co_await m_bili_client.api_api_x_v3_fav_resource_list(
             folder_id, winrt::BiliUWP::ApiParam_Page{ page.n, page.size }, search_keyword, param_order
         );
-        util::debug::log_trace(std::format(L"Parsing JSON: {}", jo.Stringify()));
-        check_json_code(jo);
+        ApiJsonStreamDecoder decoder{ "data", "medias" };
         JsonPropsWalkTree json_props_walk;
-        JsonObjectVisitor jov{ std::move(jo), json_props_walk };
-        jov.scope([&](JsonObjectVisitor jov) {
-            jov.scope([&](JsonObjectVisitor jov) {
-                jov.populate(result.info.id, "id");
-                jov.populate(result.info.fid, "fid");
-                jov.populate(result.info.mid, "mid");
-                jov.populate(result.info.attr, "attr");
-                jov.populate(result.info.title, "title");
-                jov.populate(result.info.cover_url, "cover");
-                jov.scope([&](JsonObjectVisitor jov) {
-                    jov.populate(result.info.upper.mid, "mid");
-                    jov.populate(result.info.upper.name, "name");
-                    jov.populate(result.info.upper.face_url, "face");
-                    jov.populate(result.info.upper.followed, "followed");
-                    jov.populate(result.info.upper.vip_type, "vip_type");
-                    jov.scope(adapter::assign_num_0_1_to_bool{ result.info.upper.is_vip }, "vip_statue");
-                }, "upper");
-                jov.populate(result.info.cover_type, "cover_type");
-                jov.scope([&](JsonObjectVisitor jov) {
-                    jov.populate(result.info.cnt_info.favourite_count, "collect");
-                    jov.populate(result.info.cnt_info.play_count, "play");
-                    jov.populate(result.info.cnt_info.like_count, "thumb_up");
-                    jov.populate(result.info.cnt_info.share_count, "share");
-                }, "cnt_info");
-                jov.populate(result.info.type, "type");
-                jov.populate(result.info.intro, "intro");
-                jov.populate(result.info.ctime, "ctime");
-                jov.populate(result.info.mtime, "mtime");
-                jov.populate(result.info.state, "state");
-                jov.scope(adapter::assign_num_0_1_to_bool{ result.info.fav_has_item }, "fav_state");
-                jov.scope(adapter::assign_num_0_1_to_bool{ result.info.is_liked }, "like_state");
-                jov.populate(result.info.media_count, "media_count");
-            }, "info");
-            jov.scope(adapter::assign_vec_or_null_as_empty{ result.media_list }, "medias");
-            jov.populate(result.has_more, "has_more");
-        }, "data");
+        std::vector<FavFolderResList_Media> media_list;
+        while (true) {
+            auto buf = co_await decoder.read_async(stream);
+            if (buf.Length() == 0) { break; }
+            decoder.feed(buf, json_props_walk, [&](JsonValueVisitor jvv) {
+                media_list.push_back(jvv.as<FavFolderResList_Media>());
+            });
+        }
+        auto json_resp = decoder.finish();
+        auto jo = json_resp.root();
+        util::debug::log_trace(L"Parsing JSON: {}", json_resp.lazy_text());
+        check_json_code(jo);
+        JsonObjectVisitor jov{ jo, json_props_walk };
+        jov.populate(result, "data");
+        // NOTE: medias was left empty in the remaining document
+        result.media_list = std::move(media_list);
 
         co_return result;
     }
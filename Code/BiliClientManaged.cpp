@@ -113,9 +113,10 @@ namespace winrt::BiliUWP::implementation {
     using namespace Windows::Foundation;
     using namespace Windows::Web::Http;
     using namespace Windows::Web::Http::Filters;
-    using namespace Windows::Data::Json;
+    using namespace Windows::Storage::Streams;
 
-    using AsyncJsonObjectResult = BiliClientManaged::AsyncJsonObjectResult;
+    using AsyncBufferResult = BiliClientManaged::AsyncBufferResult;
+    using AsyncInputStreamResult = BiliClientManaged::AsyncInputStreamResult;
 
     BiliClientManaged::BiliClientManaged() :
         // TODO: Can m_http_client be initialized with m_http_filter here?
@@ -184,7 +185,7 @@ namespace winrt::BiliUWP::implementation {
     }
 
     // Authentication
-    AsyncJsonObjectResult BiliClientManaged::api_passport_x_passport_tv_login_qrcode_auth_code(
+    AsyncBufferResult BiliClientManaged::api_passport_x_passport_tv_login_qrcode_auth_code(
         BiliUWP::APISignKeys const& keys, guid const& local_id
     ) {
         ApiParamMaker param_maker;
@@ -203,13 +204,13 @@ namespace winrt::BiliUWP::implementation {
             L"/x/passport-tv-login/qrcode/auth_code",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
         auto http_resp = co_await m_http_client.PostAsync(uri, nullptr);
-        co_return JsonObject::Parse(co_await http_resp.Content().ReadAsStringAsync());
+        co_return co_await http_resp.Content().ReadAsBufferAsync();
         http_client_safe_invoke_end;
     }
-    AsyncJsonObjectResult BiliClientManaged::api_passport_x_passport_tv_login_qrcode_poll(
+    AsyncBufferResult BiliClientManaged::api_passport_x_passport_tv_login_qrcode_poll(
         BiliUWP::APISignKeys const& keys, hstring const& auth_code, guid const& local_id
     ) {
         ApiParamMaker param_maker;
@@ -228,13 +229,13 @@ namespace winrt::BiliUWP::implementation {
             L"/x/passport-tv-login/qrcode/poll",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
         auto http_resp = co_await m_http_client.PostAsync(uri, nullptr);
-        co_return JsonObject::Parse(co_await http_resp.Content().ReadAsStringAsync());
+        co_return co_await http_resp.Content().ReadAsBufferAsync();
         http_client_safe_invoke_end;
     }
-    AsyncJsonObjectResult BiliClientManaged::api_passport_api_v2_oauth2_refresh_token(
+    AsyncBufferResult BiliClientManaged::api_passport_api_v2_oauth2_refresh_token(
         IReference<BiliUWP::APISignKeys> const& keys, hstring const& refresh_token
     ) {
         ApiParamMaker param_maker;
@@ -251,13 +252,13 @@ namespace winrt::BiliUWP::implementation {
             L"/api/v2/oauth2/refresh_token",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
         auto http_resp = co_await m_http_client.PostAsync(uri, nullptr);
-        co_return JsonObject::Parse(co_await http_resp.Content().ReadAsStringAsync());
+        co_return co_await http_resp.Content().ReadAsBufferAsync();
         http_client_safe_invoke_end;
     }
-    AsyncJsonObjectResult BiliClientManaged::api_passport_x_passport_login_revoke(
+    AsyncBufferResult BiliClientManaged::api_passport_x_passport_login_revoke(
         BiliUWP::APISignKeys const& keys
     ) {
         ApiParamMaker param_maker;
@@ -275,15 +276,15 @@ namespace winrt::BiliUWP::implementation {
             L"/x/passport-login/revoke",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
         auto http_resp = co_await m_http_client.PostAsync(uri, nullptr);
-        co_return JsonObject::Parse(co_await http_resp.Content().ReadAsStringAsync());
+        co_return co_await http_resp.Content().ReadAsBufferAsync();
         http_client_safe_invoke_end;
     }
 
     // User information
-    AsyncJsonObjectResult BiliClientManaged::api_app_x_v2_account_myinfo(
+    AsyncBufferResult BiliClientManaged::api_app_x_v2_account_myinfo(
         BiliUWP::APISignKeys const& keys
     ) {
         ApiParamMaker param_maker;
@@ -299,12 +300,12 @@ namespace winrt::BiliUWP::implementation {
             L"/x/v2/account/myinfo",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
-        co_return JsonObject::Parse(co_await m_http_client.GetStringAsync(uri));
+        co_return co_await m_http_client.GetBufferAsync(uri);
         http_client_safe_invoke_end;
     }
-    AsyncJsonObjectResult BiliClientManaged::api_api_x_web_interface_nav() {
+    AsyncBufferResult BiliClientManaged::api_api_x_web_interface_nav() {
         auto cancellation_token = co_await get_cancellation_token();
         cancellation_token.enable_propagation();
 
@@ -312,12 +313,12 @@ namespace winrt::BiliUWP::implementation {
             L"https://api.bilibili.com",
             L"/x/web-interface/nav"
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
-        co_return JsonObject::Parse(co_await m_http_client.GetStringAsync(uri));
+        co_return co_await m_http_client.GetBufferAsync(uri);
         http_client_safe_invoke_end;
     }
-    AsyncJsonObjectResult BiliClientManaged::api_api_x_web_interface_nav_stat() {
+    AsyncBufferResult BiliClientManaged::api_api_x_web_interface_nav_stat() {
         auto cancellation_token = co_await get_cancellation_token();
         cancellation_token.enable_propagation();
 
@@ -325,12 +326,12 @@ namespace winrt::BiliUWP::implementation {
             L"https://api.bilibili.com",
             L"/x/web-interface/nav/stat"
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
-        co_return JsonObject::Parse(co_await m_http_client.GetStringAsync(uri));
+        co_return co_await m_http_client.GetBufferAsync(uri);
         http_client_safe_invoke_end;
     }
-    AsyncJsonObjectResult BiliClientManaged::api_api_x_web_interface_card(uint64_t mid, bool get_photo) {
+    AsyncBufferResult BiliClientManaged::api_api_x_web_interface_card(uint64_t mid, bool get_photo) {
         ApiParamMaker param_maker;
 
         auto cancellation_token = co_await get_cancellation_token();
@@ -343,12 +344,12 @@ namespace winrt::BiliUWP::implementation {
             L"/x/web-interface/card",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
-        co_return JsonObject::Parse(co_await m_http_client.GetStringAsync(uri));
+        co_return co_await m_http_client.GetBufferAsync(uri);
         http_client_safe_invoke_end;
     }
-    AsyncJsonObjectResult BiliClientManaged::api_api_x_space_acc_info(uint64_t mid) {
+    AsyncBufferResult BiliClientManaged::api_api_x_space_acc_info(uint64_t mid) {
         ApiParamMaker param_maker;
 
         auto cancellation_token = co_await get_cancellation_token();
@@ -360,12 +361,12 @@ namespace winrt::BiliUWP::implementation {
             L"/x/space/acc/info",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
-        co_return JsonObject::Parse(co_await m_http_client.GetStringAsync(uri));
+        co_return co_await m_http_client.GetBufferAsync(uri);
         http_client_safe_invoke_end;
     }
-    AsyncJsonObjectResult BiliClientManaged::api_api_x_space_upstat(uint64_t mid) {
+    AsyncBufferResult BiliClientManaged::api_api_x_space_upstat(uint64_t mid) {
         ApiParamMaker param_maker;
 
         auto cancellation_token = co_await get_cancellation_token();
@@ -377,12 +378,12 @@ namespace winrt::BiliUWP::implementation {
             L"/x/space/upstat",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
-        co_return JsonObject::Parse(co_await m_http_client.GetStringAsync(uri));
+        co_return co_await m_http_client.GetBufferAsync(uri);
         http_client_safe_invoke_end;
     }
-    AsyncJsonObjectResult BiliClientManaged::api_api_x_space_arc_search(
+    AsyncInputStreamResult BiliClientManaged::api_api_x_space_arc_search(
         uint64_t mid,
         BiliUWP::ApiParam_Page page,
         hstring keyword,
@@ -415,12 +416,14 @@ namespace winrt::BiliUWP::implementation {
             L"/x/space/arc/search",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
-        co_return JsonObject::Parse(co_await m_http_client.GetStringAsync(uri));
+        auto http_resp = co_await m_http_client.GetAsync(uri, HttpCompletionOption::ResponseHeadersRead);
+        http_resp.EnsureSuccessStatusCode();
+        co_return co_await http_resp.Content().ReadAsInputStreamAsync();
         http_client_safe_invoke_end;
     }
-    AsyncJsonObjectResult BiliClientManaged::api_api_audio_music_service_web_song_upper(
+    AsyncBufferResult BiliClientManaged::api_api_audio_music_service_web_song_upper(
         uint64_t mid,
         BiliUWP::ApiParam_Page page,
         BiliUWP::ApiParam_AudioMusicServiceWebSongUpperOrder order
@@ -450,14 +453,14 @@ namespace winrt::BiliUWP::implementation {
             L"/audio/music-service/web/song/upper",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
-        co_return JsonObject::Parse(co_await m_http_client.GetStringAsync(uri));
+        co_return co_await m_http_client.GetBufferAsync(uri);
         http_client_safe_invoke_end;
     }
 
     // Video information
-    AsyncJsonObjectResult BiliClientManaged::api_api_x_web_interface_view(
+    AsyncBufferResult BiliClientManaged::api_api_x_web_interface_view(
         uint64_t avid, hstring bvid
     ) {
         ApiParamMaker param_maker;
@@ -476,12 +479,12 @@ namespace winrt::BiliUWP::implementation {
             L"/x/web-interface/view",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
-        co_return JsonObject::Parse(co_await m_http_client.GetStringAsync(uri));
+        co_return co_await m_http_client.GetBufferAsync(uri);
         http_client_safe_invoke_end;
     }
-    AsyncJsonObjectResult BiliClientManaged::api_api_x_web_interface_view_detail(
+    AsyncBufferResult BiliClientManaged::api_api_x_web_interface_view_detail(
         uint64_t avid, hstring bvid
     ) {
         ApiParamMaker param_maker;
@@ -500,12 +503,12 @@ namespace winrt::BiliUWP::implementation {
             L"/x/web-interface/view",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
-        co_return JsonObject::Parse(co_await m_http_client.GetStringAsync(uri));
+        co_return co_await m_http_client.GetBufferAsync(uri);
         http_client_safe_invoke_end;
     }
-    AsyncJsonObjectResult BiliClientManaged::api_api_x_player_v2(
+    AsyncBufferResult BiliClientManaged::api_api_x_player_v2(
         uint64_t avid,
         hstring bvid,
         uint64_t cid
@@ -527,12 +530,12 @@ namespace winrt::BiliUWP::implementation {
             L"/x/player/v2",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
-        co_return JsonObject::Parse(co_await m_http_client.GetStringAsync(uri));
+        co_return co_await m_http_client.GetBufferAsync(uri);
         http_client_safe_invoke_end;
     }
-    AsyncJsonObjectResult BiliClientManaged::api_api_x_player_playurl(
+    AsyncBufferResult BiliClientManaged::api_api_x_player_playurl(
         uint64_t avid,
         hstring bvid,
         uint64_t cid,
@@ -578,12 +581,12 @@ namespace winrt::BiliUWP::implementation {
             L"/x/player/playurl",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
-        co_return JsonObject::Parse(co_await m_http_client.GetStringAsync(uri));
+        co_return co_await m_http_client.GetBufferAsync(uri);
         http_client_safe_invoke_end;
     }
-    AsyncJsonObjectResult BiliClientManaged::api_api_x_player_videoshot(
+    AsyncInputStreamResult BiliClientManaged::api_api_x_player_videoshot(
         uint64_t avid,
         hstring bvid,
         uint64_t cid,
@@ -609,14 +612,16 @@ namespace winrt::BiliUWP::implementation {
             L"/x/player/videoshot",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
-        co_return JsonObject::Parse(co_await m_http_client.GetStringAsync(uri));
+        auto http_resp = co_await m_http_client.GetAsync(uri, HttpCompletionOption::ResponseHeadersRead);
+        http_resp.EnsureSuccessStatusCode();
+        co_return co_await http_resp.Content().ReadAsInputStreamAsync();
         http_client_safe_invoke_end;
     }
 
     // Audio information
-    AsyncJsonObjectResult BiliClientManaged::api_www_audio_music_service_c_web_song_info(
+    AsyncBufferResult BiliClientManaged::api_www_audio_music_service_c_web_song_info(
         uint64_t auid
     ) {
         ApiParamMaker param_maker;
@@ -630,12 +635,12 @@ namespace winrt::BiliUWP::implementation {
             L"/audio/music-service-c/web/song/info",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
-        co_return JsonObject::Parse(co_await m_http_client.GetStringAsync(uri));
+        co_return co_await m_http_client.GetBufferAsync(uri);
         http_client_safe_invoke_end;
     }
-    AsyncJsonObjectResult BiliClientManaged::api_api_audio_music_service_c_url(
+    AsyncBufferResult BiliClientManaged::api_api_audio_music_service_c_url(
         uint64_t auid,
         uint32_t quality
     ) {
@@ -655,14 +660,14 @@ namespace winrt::BiliUWP::implementation {
             L"/audio/music-service-c/url",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
-        co_return JsonObject::Parse(co_await m_http_client.GetStringAsync(uri));
+        co_return co_await m_http_client.GetBufferAsync(uri);
         http_client_safe_invoke_end;
     }
 
     // Favourites information
-    AsyncJsonObjectResult BiliClientManaged::api_api_x_v3_fav_folder_created_list(
+    AsyncBufferResult BiliClientManaged::api_api_x_v3_fav_folder_created_list(
         uint64_t mid,
         BiliUWP::ApiParam_Page page,
         Windows::Foundation::IReference<BiliUWP::ApiParam_FavItemLookup> const& item_to_find
@@ -685,12 +690,12 @@ namespace winrt::BiliUWP::implementation {
             L"/x/v3/fav/folder/created/list",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
-        co_return JsonObject::Parse(co_await m_http_client.GetStringAsync(uri));
+        co_return co_await m_http_client.GetBufferAsync(uri);
         http_client_safe_invoke_end;
     }
-    AsyncJsonObjectResult BiliClientManaged::api_api_x_v3_fav_folder_created_list_all(
+    AsyncBufferResult BiliClientManaged::api_api_x_v3_fav_folder_created_list_all(
         uint64_t mid,
         Windows::Foundation::IReference<BiliUWP::ApiParam_FavItemLookup> const& item_to_find
     ) {
@@ -710,12 +715,12 @@ namespace winrt::BiliUWP::implementation {
             L"/x/v3/fav/folder/created/list-all",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
-        co_return JsonObject::Parse(co_await m_http_client.GetStringAsync(uri));
+        co_return co_await m_http_client.GetBufferAsync(uri);
         http_client_safe_invoke_end;
     }
-    AsyncJsonObjectResult BiliClientManaged::api_api_x_v3_fav_resource_list(
+    AsyncInputStreamResult BiliClientManaged::api_api_x_v3_fav_resource_list(
         uint64_t folder_id,
         BiliUWP::ApiParam_Page page,
         hstring keyword,
@@ -747,9 +752,11 @@ namespace winrt::BiliUWP::implementation {
             L"/x/v3/fav/resource/list",
             param_maker.get_as_str()
         );
-        util::debug::log_trace(std::format(L"Sending request: {}", uri.ToString()));
+        util::debug::log_trace(L"Sending request: {}", util::debug::lazy_arg([&] { return uri.ToString(); }));
         http_client_safe_invoke_begin;
-        co_return JsonObject::Parse(co_await m_http_client.GetStringAsync(uri));
+        auto http_resp = co_await m_http_client.GetAsync(uri, HttpCompletionOption::ResponseHeadersRead);
+        http_resp.EnsureSuccessStatusCode();
+        co_return co_await http_resp.Content().ReadAsInputStreamAsync();
         http_client_safe_invoke_end;
     }
 }
@@ -5,7 +5,8 @@
 
 namespace winrt::BiliUWP::implementation {
     struct BiliClientManaged : BiliClientManagedT<BiliClientManaged> {
-        using AsyncJsonObjectResult = Windows::Foundation::IAsyncOperation<Windows::Data::Json::JsonObject>;
+        using AsyncBufferResult = Windows::Foundation::IAsyncOperation<Windows::Storage::Streams::IBuffer>;
+        using AsyncInputStreamResult = Windows::Foundation::IAsyncOperation<Windows::Storage::Streams::IInputStream>;
 
         BiliClientManaged();
 
@@ -17,66 +18,66 @@ namespace winrt::BiliUWP::implementation {
         void data_cookies(BiliUWP::UserCookies const& value);
 
         // Authentication
-        AsyncJsonObjectResult api_passport_x_passport_tv_login_qrcode_auth_code(
+        AsyncBufferResult api_passport_x_passport_tv_login_qrcode_auth_code(
             BiliUWP::APISignKeys const& keys,
             guid const& local_id
         );
-        AsyncJsonObjectResult api_passport_x_passport_tv_login_qrcode_poll(
+        AsyncBufferResult api_passport_x_passport_tv_login_qrcode_poll(
             BiliUWP::APISignKeys const& keys,
             hstring const& auth_code,
             winrt::guid const& local_id
         );
-        AsyncJsonObjectResult api_passport_api_v2_oauth2_refresh_token(
+        AsyncBufferResult api_passport_api_v2_oauth2_refresh_token(
             Windows::Foundation::IReference<BiliUWP::APISignKeys> const& keys,
             hstring const& refresh_token
         );
-        AsyncJsonObjectResult api_passport_x_passport_login_revoke(
+        AsyncBufferResult api_passport_x_passport_login_revoke(
             BiliUWP::APISignKeys const& keys
         );
 
         // User information
-        AsyncJsonObjectResult api_app_x_v2_account_myinfo(
+        AsyncBufferResult api_app_x_v2_account_myinfo(
             BiliUWP::APISignKeys const& keys
         );
-        AsyncJsonObjectResult api_api_x_web_interface_nav(void);
-        AsyncJsonObjectResult api_api_x_web_interface_nav_stat(void);
-        AsyncJsonObjectResult api_api_x_web_interface_card(uint64_t mid, bool get_photo);
-        AsyncJsonObjectResult api_api_x_space_acc_info(uint64_t mid);
-        AsyncJsonObjectResult api_api_x_space_upstat(uint64_t mid);
-        AsyncJsonObjectResult api_api_x_space_arc_search(
+        AsyncBufferResult api_api_x_web_interface_nav(void);
+        AsyncBufferResult api_api_x_web_interface_nav_stat(void);
+        AsyncBufferResult api_api_x_web_interface_card(uint64_t mid, bool get_photo);
+        AsyncBufferResult api_api_x_space_acc_info(uint64_t mid);
+        AsyncBufferResult api_api_x_space_upstat(uint64_t mid);
+        AsyncInputStreamResult api_api_x_space_arc_search(
             uint64_t mid,
             BiliUWP::ApiParam_Page page,
             hstring keyword,
             uint64_t tid,
             BiliUWP::ApiParam_SpaceArcSearchOrder order
         );
-        AsyncJsonObjectResult api_api_audio_music_service_web_song_upper(
+        AsyncBufferResult api_api_audio_music_service_web_song_upper(
             uint64_t mid,
             BiliUWP::ApiParam_Page page,
             BiliUWP::ApiParam_AudioMusicServiceWebSongUpperOrder order
         );
 
         // Video information
-        AsyncJsonObjectResult api_api_x_web_interface_view(
+        AsyncBufferResult api_api_x_web_interface_view(
             uint64_t avid,
             hstring bvid
         );
-        AsyncJsonObjectResult api_api_x_web_interface_view_detail(
+        AsyncBufferResult api_api_x_web_interface_view_detail(
             uint64_t avid,
             hstring bvid
         );
-        AsyncJsonObjectResult api_api_x_player_v2(
+        AsyncBufferResult api_api_x_player_v2(
             uint64_t avid,
             hstring bvid,
             uint64_t cid
         );
-        AsyncJsonObjectResult api_api_x_player_playurl(
+        AsyncBufferResult api_api_x_player_playurl(
             uint64_t avid,
             hstring bvid,
             uint64_t cid,
             BiliUWP::ApiParam_VideoPlayUrlPreference prefers
         );
-        AsyncJsonObjectResult api_api_x_player_videoshot(
+        AsyncInputStreamResult api_api_x_player_videoshot(
             uint64_t avid,
             hstring bvid,
             uint64_t cid,
@@ -84,25 +85,25 @@ namespace winrt::BiliUWP::implementation {
         );
 
         // Audio information
-        AsyncJsonObjectResult api_www_audio_music_service_c_web_song_info(
+        AsyncBufferResult api_www_audio_music_service_c_web_song_info(
             uint64_t auid
         );
-        AsyncJsonObjectResult api_api_audio_music_service_c_url(
+        AsyncBufferResult api_api_audio_music_service_c_url(
             uint64_t auid,
             uint32_t quality
         );
 
         // Favourites information
-        AsyncJsonObjectResult api_api_x_v3_fav_folder_created_list(
+        AsyncBufferResult api_api_x_v3_fav_folder_created_list(
             uint64_t mid,
             BiliUWP::ApiParam_Page page,
             Windows::Foundation::IReference<BiliUWP::ApiParam_FavItemLookup> const& item_to_find
         );
-        AsyncJsonObjectResult api_api_x_v3_fav_folder_created_list_all(
+        AsyncBufferResult api_api_x_v3_fav_folder_created_list_all(
             uint64_t mid,
             Windows::Foundation::IReference<BiliUWP::ApiParam_FavItemLookup> const& item_to_find
         );
-        AsyncJsonObjectResult api_api_x_v3_fav_resource_list(
+        AsyncInputStreamResult api_api_x_v3_fav_resource_list(
             uint64_t folder_id,
             BiliUWP::ApiParam_Page page,
             hstring keyword,
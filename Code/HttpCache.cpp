@@ -1,108 +1,576 @@
 #include "pch.h"
 #include "HttpCache.h"
 
-#include <winsqlite/winsqlite3.h>
+#include "sqlite3_util.hpp"
+#include <deque>
+#include <list>
+#include <set>
+#include <unordered_map>
 
-[[noreturn]] inline void throw_sqlite3_error(sqlite3* db) {
-    throw winrt::hresult_error(E_FAIL, winrt::hstring(
-        std::format(L"sqlite3 error: [{}] {}", sqlite3_errcode(db), (const wchar_t*)sqlite3_errmsg16(db))
-    ));
-}
-[[noreturn]] inline void throw_sqlite3_error_code(int code) {
-    throw winrt::hresult_error(E_FAIL, winrt::hstring(
-        std::format(L"sqlite3 error: [{}] {}", code, winrt::to_hstring(sqlite3_errstr(code)))
-    ));
-}
-inline void check_sqlite3(sqlite3* db, int result) {
-    if (result != SQLITE_OK) { throw_sqlite3_error(db); }
-}
-inline void check_sqlite3(int result) {
-    if (result != SQLITE_OK) { throw_sqlite3_error_code(result); }
-}
-template<typename U, typename... Args>
-inline void check_sqlite3_call(U&& func, sqlite3* db, Args&&... args) {
-    if (std::invoke(func, db, std::forward<Args>(args)...) != SQLITE_OK) {
-        throw_sqlite3_error(db);
-    }
-}
+namespace BiliUWP {
+    using namespace winrt::Windows::Foundation;
+    using namespace winrt::Windows::Web::Http;
+    using namespace winrt::Windows::Storage::Streams;
 
-struct Sqlite3MutexGuard {
-    Sqlite3MutexGuard(sqlite3* db) : Sqlite3MutexGuard(sqlite3_db_mutex(db)) {}
-    Sqlite3MutexGuard(sqlite3_mutex* sqlite_mutex) : m_sqlite_mutex(sqlite_mutex) {
-        sqlite3_mutex_enter(m_sqlite_mutex);
-    }
-    ~Sqlite3MutexGuard() {
-        sqlite3_mutex_leave(m_sqlite_mutex);
-    }
-private:
-    sqlite3_mutex* m_sqlite_mutex;
-};
-struct Sqlite3Statement {
-    Sqlite3Statement(sqlite3* db, std::wstring_view stmt) : m_db(db) {
-        check_sqlite3_call(sqlite3_prepare16_v2,
-            m_db, stmt.data(), static_cast<int>(stmt.size() * 2), &m_stmt, nullptr);
-    }
-    void reset(void) {
-        check_sqlite3(sqlite3_reset(m_stmt));
-    }
-    void bind(int idx, std::wstring_view value, bool clone_ownership) {
-        check_sqlite3(sqlite3_bind_text16(
-            m_stmt,
-            idx,
-            value.data(), static_cast<int>(value.size() * 2),
-            clone_ownership ? SQLITE_TRANSIENT : SQLITE_STATIC
-        ));
-    }
-    void bind(int idx, int64_t value) {
-        check_sqlite3(sqlite3_bind_int64(m_stmt, idx, value));
+    // Metadata writes are delayed by this long so that writes from concurrent
+    // fetches end up in the same transaction
+    constexpr auto METADATA_WRITE_BEHIND_DELAY = std::chrono::milliseconds(200);
+    constexpr uint64_t HOT_TIER_CAPACITY = 16 * 1024 * 1024;
+    // Larger resources are always served from disk
+    constexpr uint64_t HOT_TIER_MAX_ENTRY_SIZE = 1024 * 1024;
+    // Approximate bookkeeping cost of an entry, so that entries without data are bounded as well
+    constexpr uint64_t HOT_TIER_ENTRY_OVERHEAD = 256;
+    // Last access time is only recorded at this granularity (in seconds), to avoid a
+    // metadata write on every hit
+    constexpr uint64_t LAST_ACCESS_UPDATE_INTERVAL = 60;
+    // The evictor deletes this many entries at a time, pausing in between so that fetches
+    // are not blocked for long
+    constexpr int64_t EVICTION_BATCH_SIZE = 32;
+    constexpr auto EVICTION_BATCH_INTERVAL = std::chrono::milliseconds(50);
+    // Upper bound of the heuristic freshness lifetime (in seconds) for responses which
+    // carry Last-Modified but no max-age
+    constexpr uint64_t HEURISTIC_MAX_AGE_LIMIT = 24 * 60 * 60;
+    // De-duplicated bodies are stored under this folder, named by content hash
+    constexpr std::wstring_view BLOB_PATH_PREFIX = L"blobs\\";
+    // How often to retry taking a file lock held by another process
+    constexpr auto FILE_LOCK_POLL_INTERVAL = std::chrono::milliseconds(20);
+    // File locks cover a range far beyond the end of file, so that they never get in the
+    // way of reading data
+    constexpr DWORD FILE_LOCK_OFFSET_HIGH = 0x40000000;
+    // Maximum count of prefetches running at the same time
+    constexpr size_t PREFETCH_MAX_CONCURRENCY = 4;
+    // How often paused prefetches check whether regular fetches have finished
+    constexpr auto PREFETCH_YIELD_INTERVAL = std::chrono::milliseconds(50);
+
+    // Size-capped LRU of recently used entries, consulted before the disk
+    // NOTE: Entries without data only remember freshness, which is enough for uri results
+    struct HttpCacheHotTier {
+        struct Entry {
+            IBuffer data;
+            uint64_t expiry_ts;
+            uint64_t last_access_ts;
+            winrt::hstring file;
+        };
+
+        HttpCacheHotTier(uint64_t capacity) : m_capacity(capacity), m_size(0), m_stats() {}
+        std::optional<Entry> lookup(winrt::hstring const& key, uint64_t cur_ts, bool require_data) {
+            std::scoped_lock guard(m_mutex);
+            auto it = m_index.find(key);
+            if (it == m_index.end()) {
+                m_stats.hot_misses++;
+                return std::nullopt;
+            }
+            auto const& entry = it->second->second;
+            if (cur_ts > entry.expiry_ts) {
+                erase_nolock(it);
+                m_stats.hot_misses++;
+                return std::nullopt;
+            }
+            if (require_data && !entry.data) {
+                m_stats.hot_misses++;
+                return std::nullopt;
+            }
+            m_lru.splice(m_lru.begin(), m_lru, it->second);
+            m_stats.hot_hits++;
+            // NOTE: The returned entry carries the previous access time
+            auto result = entry;
+            if (cur_ts >= entry.last_access_ts + LAST_ACCESS_UPDATE_INTERVAL) {
+                it->second->second.last_access_ts = cur_ts;
+            }
+            return result;
+        }
+        void insert(winrt::hstring const& key, Entry entry) {
+            std::scoped_lock guard(m_mutex);
+            if (auto it = m_index.find(key); it != m_index.end()) {
+                erase_nolock(it);
+            }
+            auto entry_size = calc_entry_size(entry);
+            if (entry_size > m_capacity) { return; }
+            m_lru.emplace_front(key, std::move(entry));
+            m_index.emplace(key, m_lru.begin());
+            m_size += entry_size;
+            while (m_size > m_capacity) {
+                erase_nolock(m_index.find(m_lru.back().first));
+                m_stats.hot_evictions++;
+            }
+        }
+        void erase(winrt::hstring const& key) {
+            std::scoped_lock guard(m_mutex);
+            if (auto it = m_index.find(key); it != m_index.end()) {
+                erase_nolock(it);
+            }
+        }
+        void clear(void) {
+            std::scoped_lock guard(m_mutex);
+            m_index.clear();
+            m_lru.clear();
+            m_size = 0;
+        }
+        void record_coalesced(void) {
+            std::scoped_lock guard(m_mutex);
+            m_stats.coalesced_fetches++;
+        }
+        HttpCacheStats stats(void) {
+            std::scoped_lock guard(m_mutex);
+            auto result = m_stats;
+            result.hot_size = m_size;
+            return result;
+        }
+
+    private:
+        using LruList = std::list<std::pair<winrt::hstring, Entry>>;
+
+        static uint64_t calc_entry_size(Entry const& entry) {
+            return (entry.data ? entry.data.Length() : 0) + HOT_TIER_ENTRY_OVERHEAD;
+        }
+        void erase_nolock(std::unordered_map<winrt::hstring, LruList::iterator>::iterator it) {
+            m_size -= calc_entry_size(it->second->second);
+            m_lru.erase(it->second);
+            m_index.erase(it);
+        }
+
+        std::mutex m_mutex;
+        // Most recently used first
+        LruList m_lru;
+        std::unordered_map<winrt::hstring, LruList::iterator> m_index;
+        uint64_t m_capacity;
+        uint64_t m_size;
+        HttpCacheStats m_stats;
+    };
+
+    inline void resume_on_thread_pool(std::coroutine_handle<> handle) {
+        auto callback = [](PTP_CALLBACK_INSTANCE, void* context) {
+            std::coroutine_handle<>::from_address(context)();
+        };
+        if (!TrySubmitThreadpoolCallback(callback, handle.address(), nullptr)) {
+            handle();
+        }
     }
-    bool step(void) {
-        {
-            // Used for protecting error messages
-            Sqlite3MutexGuard guard(m_db);
-            switch (sqlite3_step(m_stmt)) {
-            case SQLITE_ROW:
+
+    // Per-key readers-writer locks for coordinating fetches within the process
+    // NOTE: Waiting coroutines are suspended rather than blocking threads, and are resumed
+    //       on the thread pool in FIFO order (new readers queue behind waiting writers)
+    // NOTE: Cancellation not supported
+    struct HttpCacheKeyLocks {
+        struct Guard {
+            Guard() : m_locks(nullptr), m_exclusive(false) {}
+            Guard(Guard&& other) noexcept :
+                m_locks(std::exchange(other.m_locks, nullptr)), m_key(std::move(other.m_key)),
+                m_exclusive(other.m_exclusive) {}
+            Guard& operator=(Guard&& other) noexcept {
+                if (this != &other) {
+                    unlock();
+                    m_locks = std::exchange(other.m_locks, nullptr);
+                    m_key = std::move(other.m_key);
+                    m_exclusive = other.m_exclusive;
+                }
+                return *this;
+            }
+            ~Guard() { unlock(); }
+            explicit operator bool() const { return m_locks != nullptr; }
+            bool is_exclusive(void) const { return m_locks && m_exclusive; }
+            // Turns an exclusive lock into a shared one without letting writers in between
+            void downgrade(void) {
+                if (!is_exclusive()) { return; }
+                m_exclusive = false;
+                m_locks->downgrade(m_key);
+            }
+            void unlock(void) {
+                if (!m_locks) { return; }
+                std::exchange(m_locks, nullptr)->unlock(m_key, m_exclusive);
+            }
+        private:
+            friend struct HttpCacheKeyLocks;
+            Guard(HttpCacheKeyLocks* locks, winrt::hstring key, bool exclusive) :
+                m_locks(locks), m_key(std::move(key)), m_exclusive(exclusive) {}
+
+            HttpCacheKeyLocks* m_locks;
+            winrt::hstring m_key;
+            bool m_exclusive;
+        };
+        struct Awaiter {
+            bool await_ready() { return m_locks->try_lock(m_key, m_exclusive, nullptr); }
+            bool await_suspend(std::coroutine_handle<> handle) {
+                return !m_locks->try_lock(m_key, m_exclusive, handle);
+            }
+            Guard await_resume() { return Guard(m_locks, std::move(m_key), m_exclusive); }
+
+            HttpCacheKeyLocks* m_locks;
+            winrt::hstring m_key;
+            bool m_exclusive;
+        };
+
+        Awaiter lock(winrt::hstring const& key) { return { this, key, true }; }
+        Awaiter lock_shared(winrt::hstring const& key) { return { this, key, false }; }
+
+    private:
+        struct Waiter {
+            std::coroutine_handle<> handle;
+            bool exclusive;
+        };
+        struct State {
+            uint32_t readers = 0;
+            bool writer = false;
+            std::deque<Waiter> waiters;
+        };
+
+        // If the lock cannot be taken immediately and handle is not null, queues handle
+        // as a waiter, which takes over the lock once resumed
+        bool try_lock(winrt::hstring const& key, bool exclusive, std::coroutine_handle<> handle) {
+            std::scoped_lock guard(m_mutex);
+            auto& state = m_states[key];
+            bool available = state.waiters.empty() && !state.writer && (!exclusive || state.readers == 0);
+            if (available) {
+                if (exclusive) { state.writer = true; }
+                else { state.readers++; }
                 return true;
-            case SQLITE_DONE:
-                return false;
-            case SQLITE_BUSY:
-                break;
-            default:
-                throw_sqlite3_error(m_db);
             }
+            if (handle) {
+                state.waiters.push_back({ handle, exclusive });
+            }
+            return false;
         }
-        // SQLITE_BUSY
-        Sleep(0);
-        return step();
-    }
-    int64_t col_i64(int idx) { return sqlite3_column_int64(m_stmt, idx); }
-    const wchar_t* col_str16(int idx) {
-        return reinterpret_cast<const wchar_t*>(sqlite3_column_text16(m_stmt, idx));
-    }
-    ~Sqlite3Statement() {
-        auto code = sqlite3_finalize(m_stmt);
-        if (code != SQLITE_OK) {
-            util::debug::log_warn(std::format(L"sqlite3 error: [{}] {}",
-                code, winrt::to_hstring(sqlite3_errstr(code))));
+        void unlock(winrt::hstring const& key, bool exclusive) {
+            std::vector<std::coroutine_handle<>> ready;
+            {
+                std::scoped_lock guard(m_mutex);
+                auto it = m_states.find(key);
+                if (it == m_states.end()) { return; }
+                auto& state = it->second;
+                if (exclusive) { state.writer = false; }
+                else { state.readers--; }
+                grant_nolock(state, ready);
+                if (state.readers == 0 && !state.writer && state.waiters.empty()) {
+                    m_states.erase(it);
+                }
+            }
+            resume_all(ready);
+        }
+        void downgrade(winrt::hstring const& key) {
+            std::vector<std::coroutine_handle<>> ready;
+            {
+                std::scoped_lock guard(m_mutex);
+                auto& state = m_states[key];
+                state.writer = false;
+                state.readers++;
+                grant_nolock(state, ready);
+            }
+            resume_all(ready);
+        }
+        // Hands the lock over to waiters at the front of the queue, as far as possible
+        static void grant_nolock(State& state, std::vector<std::coroutine_handle<>>& ready) {
+            while (!state.waiters.empty() && !state.writer) {
+                auto& waiter = state.waiters.front();
+                if (waiter.exclusive) {
+                    if (state.readers != 0) { break; }
+                    state.writer = true;
+                }
+                else {
+                    state.readers++;
+                }
+                ready.push_back(waiter.handle);
+                state.waiters.pop_front();
+            }
+        }
+        static void resume_all(std::vector<std::coroutine_handle<>> const& handles) {
+            for (auto handle : handles) {
+                resume_on_thread_pool(handle);
+            }
         }
-    }
-private:
-    sqlite3* m_db;
-    sqlite3_stmt* m_stmt;
-};
 
-namespace BiliUWP {
-    using namespace winrt::Windows::Foundation;
-    using namespace winrt::Windows::Web::Http;
-    using namespace winrt::Windows::Storage::Streams;
+        std::mutex m_mutex;
+        std::map<winrt::hstring, State> m_states;
+    };
+
+    // Progress of a body being downloaded into a file, shared with the streams reading it
+    // NOTE: The file is opened before the download starts, so that it can be read even after
+    //       being moved or deleted; lock_holder keeps writers out for as long as any reader
+    //       is alive, like for streams over complete bodies
+    struct HttpCacheTee {
+        struct Awaiter {
+            bool await_ready() { return m_tee->try_wait(m_pos, nullptr); }
+            bool await_suspend(std::coroutine_handle<> handle) { return !m_tee->try_wait(m_pos, handle); }
+            // Returns the number of bytes available
+            uint64_t await_resume() {
+                std::scoped_lock guard(m_tee->m_mutex);
+                if (m_tee->m_frontier < m_pos && m_tee->m_error) {
+                    std::rethrow_exception(m_tee->m_error);
+                }
+                return m_tee->m_frontier;
+            }
+
+            HttpCacheTee* m_tee;
+            uint64_t m_pos;
+        };
+
+        HttpCacheTee(util::win32::overlapped_file file, uint64_t size, std::shared_ptr<void> lock_holder) :
+            m_file(std::move(file)), m_size(size), m_lock_holder(std::move(lock_holder)) {}
+        util::win32::overlapped_file const& file(void) const { return m_file; }
+        uint64_t size(void) const { return m_size; }
+        // Completes once the first `pos` bytes are written, or the download has ended
+        Awaiter wait_until(uint64_t pos) { return { this, pos }; }
+        void advance(uint64_t count) {
+            std::vector<std::coroutine_handle<>> ready;
+            {
+                std::scoped_lock guard(m_mutex);
+                m_frontier += count;
+                std::erase_if(m_waiters, [&](auto const& waiter) {
+                    if (waiter.first > m_frontier) { return false; }
+                    ready.push_back(waiter.second);
+                    return true;
+                });
+            }
+            for (auto handle : ready) { resume_on_thread_pool(handle); }
+        }
+        // NOTE: error is null if the body was downloaded successfully
+        void finish(std::exception_ptr error) {
+            std::vector<std::coroutine_handle<>> ready;
+            {
+                std::scoped_lock guard(m_mutex);
+                if (m_finished) { return; }
+                m_finished = true;
+                m_error = error;
+                if (!m_error && m_frontier < m_size) {
+                    m_error = std::make_exception_ptr(winrt::hresult_error(E_FAIL,
+                        L"HttpCache: Response body is shorter than advertised"));
+                }
+                for (auto const& waiter : m_waiters) { ready.push_back(waiter.second); }
+                m_waiters.clear();
+            }
+            for (auto handle : ready) { resume_on_thread_pool(handle); }
+        }
+
+    private:
+        bool try_wait(uint64_t pos, std::coroutine_handle<> handle) {
+            std::scoped_lock guard(m_mutex);
+            if (m_frontier >= pos || m_finished) { return true; }
+            if (handle) { m_waiters.emplace_back(pos, handle); }
+            return false;
+        }
+
+        const util::win32::overlapped_file m_file;
+        const uint64_t m_size;
+        const std::shared_ptr<void> m_lock_holder;
+        std::mutex m_mutex;
+        uint64_t m_frontier = 0;
+        bool m_finished = false;
+        std::exception_ptr m_error;
+        std::vector<std::pair<uint64_t, std::coroutine_handle<>>> m_waiters;
+    };
+    // Read-only stream over a body which is still being downloaded; reads past the bytes
+    // written so far wait for them to arrive
+    // NOTE: Waiting reads are not cancellable, but always complete once the download ends
+    struct HttpCacheTeeStream : winrt::implements<HttpCacheTeeStream,
+        IRandomAccessStream, IClosable, IInputStream, IOutputStream>
+    {
+        HttpCacheTeeStream(std::shared_ptr<HttpCacheTee> tee, uint64_t position = 0) :
+            m_tee(std::move(tee)), m_position(position) {}
+        void Close() {
+            std::scoped_lock guard(m_mutex);
+            m_tee = nullptr;
+        }
+        IAsyncOperationWithProgress<IBuffer, uint32_t> ReadAsync(
+            IBuffer buffer, uint32_t count, InputStreamOptions options
+        ) {
+            auto strong_this = get_strong();
+            co_await winrt::resume_background();
+            // NOTE: Keeps the tee (and the file) for the read even if the stream is closed meanwhile
+            std::shared_ptr<HttpCacheTee> tee;
+            uint64_t pos;
+            {
+                std::scoped_lock guard(m_mutex);
+                tee = checked_tee();
+                pos = m_position;
+            }
+            auto size = tee->size();
+            auto end_pos = std::min(pos + std::min(count, buffer.Capacity()), size);
+            if (pos >= end_pos) {
+                buffer.Length(0);
+                co_return buffer;
+            }
+            bool partial = (options & InputStreamOptions::Partial) == InputStreamOptions::Partial;
+            auto available = co_await tee->wait_until(partial ? pos + 1 : end_pos);
+            end_pos = std::min(end_pos, available);
+            auto read_len = co_await tee->file().read_at_async(
+                pos, buffer.data(), static_cast<uint32_t>(end_pos - pos));
+            buffer.Length(read_len);
+            std::scoped_lock guard(m_mutex);
+            m_position = pos + read_len;
+            co_return buffer;
+        }
+        IAsyncOperationWithProgress<uint32_t, uint32_t> WriteAsync(IBuffer const&) {
+            throw winrt::hresult_illegal_method_call();
+        }
+        IAsyncOperation<bool> FlushAsync() {
+            co_return true;
+        }
+        uint64_t Size() {
+            std::scoped_lock guard(m_mutex);
+            return checked_tee()->size();
+        }
+        void Size(uint64_t) {
+            throw winrt::hresult_illegal_method_call();
+        }
+        IInputStream GetInputStreamAt(uint64_t position) {
+            std::scoped_lock guard(m_mutex);
+            return winrt::make<HttpCacheTeeStream>(checked_tee(), position);
+        }
+        IOutputStream GetOutputStreamAt(uint64_t) {
+            throw winrt::hresult_illegal_method_call();
+        }
+        uint64_t Position() {
+            std::scoped_lock guard(m_mutex);
+            return m_position;
+        }
+        void Seek(uint64_t position) {
+            std::scoped_lock guard(m_mutex);
+            m_position = position;
+        }
+        IRandomAccessStream CloneStream() {
+            std::scoped_lock guard(m_mutex);
+            return winrt::make<HttpCacheTeeStream>(checked_tee());
+        }
+        bool CanRead() { return true; }
+        bool CanWrite() { return false; }
+
+    private:
+        // NOTE: m_mutex must be held
+        std::shared_ptr<HttpCacheTee> const& checked_tee(void) const {
+            if (!m_tee) { throw winrt::hresult_error(RO_E_CLOSED); }
+            return m_tee;
+        }
+
+        std::mutex m_mutex;
+        std::shared_ptr<HttpCacheTee> m_tee;
+        uint64_t m_position;
+    };
+
+    // NOTE: Reads are overlapped and never block the calling thread
+    struct Win32FileReadOnlyRandomAccessStream :
+        winrt::implements<Win32FileReadOnlyRandomAccessStream,
+        IRandomAccessStream, IClosable, IInputStream, IOutputStream>
+    {
+        Win32FileReadOnlyRandomAccessStream(
+            std::function<util::win32::overlapped_file()> file_opener,
+            std::shared_ptr<void> lock_holder,
+            uint64_t position = 0) :
+            m_file(std::make_shared<util::win32::overlapped_file>(file_opener())),
+            m_file_opener(std::move(file_opener)),
+            m_lock_holder(std::move(lock_holder)), m_position(position) {}
+        ~Win32FileReadOnlyRandomAccessStream() { Close(); }
+        void Close() {
+            std::scoped_lock guard(m_mutex);
+            m_file = nullptr;
+            m_lock_holder = nullptr;
+        }
+        IAsyncOperationWithProgress<IBuffer, uint32_t> ReadAsync(
+            IBuffer buffer, uint32_t count, InputStreamOptions options
+        ) {
+            auto strong_this = get_strong();
+            // NOTE: Keeps the file open for the read even if the stream is closed meanwhile
+            std::shared_ptr<util::win32::overlapped_file> file;
+            uint64_t pos;
+            {
+                std::scoped_lock guard(m_mutex);
+                file = checked_file();
+                pos = m_position;
+            }
+            auto read_len = co_await file->read_at_async(
+                pos, buffer.data(), std::min(count, buffer.Capacity()));
+            buffer.Length(read_len);
+            std::scoped_lock guard(m_mutex);
+            m_position = pos + read_len;
+            co_return buffer;
+        }
+        IAsyncOperationWithProgress<uint32_t, uint32_t> WriteAsync(IBuffer const& buffer) {
+            throw winrt::hresult_illegal_method_call();
+        }
+        IAsyncOperation<bool> FlushAsync() {
+            co_return true;
+        }
+        uint64_t Size() {
+            std::scoped_lock guard(m_mutex);
+            return checked_file()->size();
+        }
+        void Size(uint64_t value) {
+            throw winrt::hresult_illegal_method_call();
+        }
+        ::winrt::Windows::Storage::Streams::IInputStream GetInputStreamAt(uint64_t position) {
+            std::scoped_lock guard(m_mutex);
+            checked_file();
+            return winrt::make<Win32FileReadOnlyRandomAccessStream>(
+                m_file_opener, m_lock_holder, position);
+        }
+        ::winrt::Windows::Storage::Streams::IOutputStream GetOutputStreamAt(uint64_t position) {
+            throw winrt::hresult_illegal_method_call();
+        }
+        uint64_t Position() {
+            std::scoped_lock guard(m_mutex);
+            return m_position;
+        }
+        void Seek(uint64_t position) {
+            std::scoped_lock guard(m_mutex);
+            m_position = position;
+        }
+        IRandomAccessStream CloneStream() {
+            std::scoped_lock guard(m_mutex);
+            checked_file();
+            return winrt::make<Win32FileReadOnlyRandomAccessStream>(
+                m_file_opener, m_lock_holder);
+        }
+        bool CanRead() { return true; }
+        bool CanWrite() { return false; }
+    private:
+        // NOTE: m_mutex must be held
+        std::shared_ptr<util::win32::overlapped_file> const& checked_file(void) const {
+            if (!m_file) { throw winrt::hresult_error(RO_E_CLOSED); }
+            return m_file;
+        }
+
+        // NOTE: Guards all members below, as streams may be used from multiple threads
+        std::mutex m_mutex;
+        std::shared_ptr<util::win32::overlapped_file> m_file;
+        std::function<util::win32::overlapped_file()> m_file_opener;
+        std::shared_ptr<void> m_lock_holder;
+        uint64_t m_position;
+    };
 
     // NOTE: Cancellation not supported
     struct details::HttpCacheImpl : std::enable_shared_from_this<HttpCacheImpl> {
+        // A fetch shared by concurrent requests for the same resource
+        struct InflightFetch {
+            util::winrt::task<> op;
+            // NOTE: Only the initiating request receives progress
+            std::mutex mutex;
+            std::function<void(HttpProgress const&)> progress_handler;
+            // The result of the fetch, which is handed out to all requests
+            // NOTE: Small bodies are loaded into data; large ones are shared as stream (which
+            //       may still be downloading); uri is set if no stream was requested
+            IBuffer data{ nullptr };
+            IRandomAccessStream stream{ nullptr };
+            winrt::Windows::Foundation::Uri uri{ nullptr };
+        };
+        // Resources queued by a single prefetch_async call
+        struct PrefetchBatch {
+            std::atomic<size_t> remaining;
+            util::winrt::awaitable_event done;
+
+            void complete_one(void) {
+                if (--remaining == 0) { done.set(); }
+            }
+        };
+        struct PrefetchItem {
+            winrt::Windows::Foundation::Uri uri{ nullptr };
+            std::shared_ptr<PrefetchBatch> batch;
+        };
         HttpCacheImpl(
             winrt::Windows::Storage::StorageFolder const& root,
             winrt::hstring const& name,
-            winrt::Windows::Web::Http::Filters::IHttpFilter const& http_filter
-        ) : m_root(root), m_cache_dir(nullptr), m_name(name), m_http_client(nullptr), m_db(nullptr) {
+            winrt::Windows::Web::Http::Filters::IHttpFilter const& http_filter,
+            uint64_t capacity
+        ) : m_root(root), m_cache_dir(nullptr), m_name(name), m_http_client(nullptr), m_db(nullptr),
+            m_capacity(capacity)
+        {
             if (http_filter) {
                 m_http_client = winrt::Windows::Web::Http::HttpClient(http_filter);
             }
@@ -118,6 +586,9 @@ namespace BiliUWP {
         ~HttpCacheImpl() {
             if (m_db) {
                 // TODO: Wait for all db operations to finish?
+                try { flush_pending_writes(); }
+                catch (...) { util::winrt::log_current_exception(); }
+                m_stmt_pool.clear();
                 check_sqlite3_call(sqlite3_close, m_db);
             }
         }
@@ -172,21 +643,81 @@ namespace BiliUWP {
             op.Progress([&](auto&&, auto&& progress) { progress_token(progress); });
             co_return (co_await std::move(op)).as<winrt::Windows::Foundation::Uri>();
         }
+        IAsyncAction prefetch_async(
+            std::vector<winrt::Windows::Foundation::Uri> uris,
+            HttpCachePrefetchPriority priority
+        ) {
+            auto strong_this = shared_from_this();
+            auto cancellation_token = co_await winrt::get_cancellation_token();
+            if (uris.empty()) { co_return; }
+            auto batch = std::make_shared<PrefetchBatch>();
+            batch->remaining = uris.size();
+            {
+                std::scoped_lock guard(m_mutex_prefetch);
+                auto& queue = m_prefetch_queues[static_cast<size_t>(priority)];
+                for (auto& uri : uris) {
+                    queue.push_back({ .uri = std::move(uri), .batch = batch });
+                }
+            }
+            cancellation_token.callback([strong_this, batch] {
+                {
+                    std::scoped_lock guard(strong_this->m_mutex_prefetch);
+                    for (auto& queue : strong_this->m_prefetch_queues) {
+                        std::erase_if(queue, [&](PrefetchItem const& item) { return item.batch == batch; });
+                    }
+                }
+                batch->done.set();
+            });
+            kick_prefetchers();
+            co_await batch->done;
+        }
         util::winrt::task<> remove_expired_async(void) {
             co_await winrt::resume_background();
             auto cur_ts = get_cur_ts();
-            Sqlite3Statement db_stmt(m_db, L"DELETE FROM entries WHERE "
-                "? > age + life_start_ts AND delete_entry(path) != 0;");
-            db_stmt.bind(1, static_cast<int64_t>(cur_ts));
-            db_stmt.step();
+            {
+                // NOTE: Held across the deletion, so that it neither runs inside the writer's
+                //       transaction nor gets undone by writes queued after the flush
+                std::scoped_lock guard_flush(m_mutex_flush);
+                flush_pending_writes_nolock();
+                {
+                    Sqlite3Statement db_stmt(m_stmt_pool, L"SELECT DISTINCT file FROM entries WHERE "
+                        "? > age + life_start_ts + stale_ttl;");
+                    db_stmt.bind(1, static_cast<int64_t>(cur_ts));
+                    while (db_stmt.step()) {
+                        queue_orphan_blob(db_stmt.col_str16(0));
+                    }
+                }
+                Sqlite3Statement db_stmt(m_stmt_pool, L"DELETE FROM entries WHERE "
+                    "? > age + life_start_ts + stale_ttl AND delete_entry(path) != 0;");
+                db_stmt.bind(1, static_cast<int64_t>(cur_ts));
+                db_stmt.step();
+                {
+                    std::scoped_lock guard(m_mutex_pending_writes);
+                    std::erase_if(m_pending_writes, [&](auto const& e) {
+                        auto const& record = e.second;
+                        return record && cur_ts > record->age + record->life_start_ts + record->stale_ttl;
+                    });
+                }
+                m_total_size = std::nullopt;
+            }
+            kick_evictor();
         }
         util::winrt::task<> clear_async(void) {
             co_await winrt::resume_background();
             // NOTE: The deletion is likely to fail, as the database connection remains open
+            m_hot_tier.clear();
             util::fs::delete_all_inside_folder(m_cache_dir_path.c_str());
-            //remove_record_all();
+            // NOTE: See remove_expired_async
+            std::scoped_lock guard_flush(m_mutex_flush);
+            flush_pending_writes_nolock();
+            //remove_record_all_nolock();
             // NOTE: Reduce orphan files at the expense of performance
             Sqlite3Statement(m_db, L"DELETE FROM entries WHERE delete_entry(path) != 0;").step();
+            {
+                std::scoped_lock guard(m_mutex_pending_writes);
+                m_pending_writes.clear();
+            }
+            m_total_size = std::nullopt;
         }
 
     private:
@@ -196,6 +727,19 @@ namespace BiliUWP {
             uint64_t default_age;
             uint64_t age;
             uint64_t life_start_ts;
+            uint64_t size;
+            uint64_t last_access_ts;
+            // Validators from the last response, sent back when revalidating
+            winrt::hstring etag;
+            winrt::hstring last_modified;
+            // For how long (in seconds) the entry may still be served after expiry,
+            // while it is being revalidated in background (stale-while-revalidate)
+            uint64_t stale_ttl;
+            // Path of the body file, relative to the cache folder; either the file of the
+            // entry itself, or a shared blob if bodies are de-duplicated
+            winrt::hstring file;
+
+            bool operator==(TableRecord const&) const = default;
         };
 
         // WARN: Not protected by mutex; caller must guarantee thread safety
@@ -248,8 +792,8 @@ namespace BiliUWP {
                 deferred([&] { sqlite3_close(m_db); m_db = nullptr; });
                 throw_sqlite3_error(m_db);
             }
-            // Create & update the database
-            update_database();
+            configure_sqlite3_db(m_db);
+            m_stmt_pool.attach(m_db);
             // Install functions
             check_sqlite3_call(sqlite3_create_function, m_db, "delete_entry", 1, SQLITE_UTF16, this,
                 [](sqlite3_context* context, int argc, sqlite3_value** argv) noexcept {
@@ -262,7 +806,9 @@ namespace BiliUWP {
                         }
                         auto that = reinterpret_cast<HttpCacheImpl*>(sqlite3_user_data(context));
                         auto path = reinterpret_cast<const wchar_t*>(sqlite3_value_text16(argv[0]));
-                        if (!util::fs::delete_file_if_exists((that->m_cache_dir_path + path).c_str())) {
+                        // NOTE: Shared blobs are left to the orphan sweep
+                        auto file_path = make_entry_file_path(path);
+                        if (!util::fs::delete_file_if_exists((that->m_cache_dir_path + file_path).c_str())) {
                             throw winrt::hresult_error(E_FAIL,
                                 L"sql function delete_entry: Cannot remove file");
                         }
@@ -274,6 +820,28 @@ namespace BiliUWP {
                     sqlite3_result_int(context, result);
                 }, nullptr, nullptr
             );
+            // NOTE: Returns 0 if the file does not exist
+            check_sqlite3_call(sqlite3_create_function, m_db, "entry_file_size", 1, SQLITE_UTF16, this,
+                [](sqlite3_context* context, int argc, sqlite3_value** argv) noexcept {
+                    if (argc != 1) {
+                        sqlite3_result_error(context, "entry_file_size: Expected exactly 1 argument", -1);
+                        return;
+                    }
+                    auto that = reinterpret_cast<HttpCacheImpl*>(sqlite3_user_data(context));
+                    auto path = reinterpret_cast<const wchar_t*>(sqlite3_value_text16(argv[0]));
+                    WIN32_FILE_ATTRIBUTE_DATA attr_data;
+                    int64_t size = 0;
+                    if (GetFileAttributesExFromAppW((that->m_cache_dir_path + path).c_str(),
+                        GetFileExInfoStandard, &attr_data))
+                    {
+                        size = (static_cast<int64_t>(attr_data.nFileSizeHigh) << 32) | attr_data.nFileSizeLow;
+                    }
+                    sqlite3_result_int64(context, size);
+                }, nullptr, nullptr
+            );
+            // Create & update the database
+            update_database();
+            kick_evictor();
         }
         void update_database() {
             Sqlite3Statement stmt_user_version(m_db, L"PRAGMA user_version;");
@@ -288,11 +856,126 @@ namespace BiliUWP {
                     "path TEXT UNIQUE PRIMARY KEY NOT NULL,"
                     "default_age INTEGER NOT NULL,"
                     "age INTEGER NOT NULL,"
-                    "life_start_ts INTEGER NOT NULL);"
+                    "life_start_ts INTEGER NOT NULL,"
+                    "size INTEGER NOT NULL DEFAULT 0,"
+                    "last_access_ts INTEGER NOT NULL DEFAULT 0,"
+                    "etag TEXT NOT NULL DEFAULT '',"
+                    "last_modified TEXT NOT NULL DEFAULT '',"
+                    "stale_ttl INTEGER NOT NULL DEFAULT 0,"
+                    "file TEXT NOT NULL DEFAULT '');"
+                ).step();
+                Sqlite3Statement(m_db, L""
+                    "CREATE INDEX IF NOT EXISTS entries_last_access ON entries(last_access_ts);"
+                ).step();
+                Sqlite3Statement(m_db, L""
+                    "CREATE INDEX IF NOT EXISTS entries_file ON entries(file);"
+                ).step();
+                Sqlite3Statement(m_db, L"PRAGMA user_version = 4;").step();
+                current_version = 4;
+            }
+            if (current_version == 1) {
+                // v1 -> v2: Track size & last access time for eviction
+                Sqlite3Statement(m_db, L"BEGIN;").step();
+                bool committed = false;
+                deferred([&] {
+                    if (!committed) { sqlite3_exec(m_db, "ROLLBACK;", nullptr, nullptr, nullptr); }
+                });
+                Sqlite3Statement(m_db, L""
+                    "ALTER TABLE entries ADD COLUMN size INTEGER NOT NULL DEFAULT 0;"
+                ).step();
+                Sqlite3Statement(m_db, L""
+                    "ALTER TABLE entries ADD COLUMN last_access_ts INTEGER NOT NULL DEFAULT 0;"
+                ).step();
+                Sqlite3Statement(m_db, L""
+                    "UPDATE entries SET size = entry_file_size(path), last_access_ts = life_start_ts;"
+                ).step();
+                Sqlite3Statement(m_db, L""
+                    "CREATE INDEX IF NOT EXISTS entries_last_access ON entries(last_access_ts);"
+                ).step();
+                Sqlite3Statement(m_db, L"PRAGMA user_version = 2;").step();
+                Sqlite3Statement(m_db, L"COMMIT;").step();
+                committed = true;
+                current_version = 2;
+            }
+            if (current_version == 2) {
+                // v2 -> v3: Store validators for conditional revalidation
+                Sqlite3Statement(m_db, L"BEGIN;").step();
+                bool committed = false;
+                deferred([&] {
+                    if (!committed) { sqlite3_exec(m_db, "ROLLBACK;", nullptr, nullptr, nullptr); }
+                });
+                Sqlite3Statement(m_db, L""
+                    "ALTER TABLE entries ADD COLUMN etag TEXT NOT NULL DEFAULT '';"
+                ).step();
+                Sqlite3Statement(m_db, L""
+                    "ALTER TABLE entries ADD COLUMN last_modified TEXT NOT NULL DEFAULT '';"
+                ).step();
+                Sqlite3Statement(m_db, L""
+                    "ALTER TABLE entries ADD COLUMN stale_ttl INTEGER NOT NULL DEFAULT 0;"
+                ).step();
+                Sqlite3Statement(m_db, L"PRAGMA user_version = 3;").step();
+                Sqlite3Statement(m_db, L"COMMIT;").step();
+                committed = true;
+                current_version = 3;
+            }
+            if (current_version == 3) {
+                // v3 -> v4: Move bodies out of the tree mirroring uris into sharded files
+                Sqlite3Statement(m_db, L"BEGIN;").step();
+                bool committed = false;
+                deferred([&] {
+                    if (!committed) { sqlite3_exec(m_db, "ROLLBACK;", nullptr, nullptr, nullptr); }
+                });
+                Sqlite3Statement(m_db, L""
+                    "ALTER TABLE entries ADD COLUMN file TEXT NOT NULL DEFAULT '';"
+                ).step();
+                Sqlite3Statement(m_db, L""
+                    "CREATE INDEX IF NOT EXISTS entries_file ON entries(file);"
                 ).step();
-                Sqlite3Statement(m_db, L"PRAGMA user_version = 1;").step();
+                std::vector<winrt::hstring> keys;
+                {
+                    Sqlite3Statement db_stmt(m_db, L"SELECT path FROM entries;");
+                    while (db_stmt.step()) {
+                        keys.emplace_back(db_stmt.col_str16(0));
+                    }
+                }
+                size_t migrated_count = 0;
+                for (auto const& key : keys) {
+                    std::wstring old_path{ key };
+                    for (auto& ch : old_path) {
+                        if (ch != L'/') { continue; }
+                        ch = L'\\';
+                    }
+                    old_path = m_cache_dir_path + std::move(old_path);
+                    auto file_path = make_entry_file_path(key);
+                    auto new_path = m_cache_dir_path + file_path;
+                    std::wstring_view new_path_view = new_path;
+                    winrt::hstring new_base_dir{ new_path_view.substr(0, new_path_view.rfind(L'\\')) };
+                    bool moved = util::fs::create_dir_all(new_base_dir.c_str()) &&
+                        util::fs::delete_file_if_exists(new_path.c_str()) &&
+                        util::fs::rename_path(old_path.c_str(), new_path.c_str());
+                    if (moved) {
+                        Sqlite3Statement db_stmt(m_db, L"UPDATE entries SET file = ? WHERE path = ?;");
+                        db_stmt.bind(1, file_path, false);
+                        db_stmt.bind(2, key, false);
+                        db_stmt.step();
+                        migrated_count++;
+                    }
+                    else {
+                        Sqlite3Statement db_stmt(m_db, L"DELETE FROM entries WHERE path = ?;");
+                        db_stmt.bind(1, key, false);
+                        db_stmt.step();
+                    }
+                }
+                Sqlite3Statement(m_db, L"PRAGMA user_version = 4;").step();
+                Sqlite3Statement(m_db, L"COMMIT;").step();
+                committed = true;
+                current_version = 4;
+                util::debug::log_info(L"HttpCache: Migrated {} of {} entries to sharded layout",
+                    migrated_count, keys.size());
+                // Whatever is left in the old tree is garbage now
+                remove_legacy_dirs();
             }
-            else if (current_version == 1) {
+            if (current_version == 4) {
                 // Database is up-to-date
             }
             else {
@@ -300,6 +983,73 @@ namespace BiliUWP {
             }
         }
 
+        // Removes top-level folders which are not part of the sharded layout
+        void remove_legacy_dirs(void) {
+            auto is_shard_dir_fn = [](std::wstring_view name) {
+                return name.size() == 2 && std::all_of(name.begin(), name.end(), [](wchar_t ch) {
+                    return (L'0' <= ch && ch <= L'9') || (L'a' <= ch && ch <= L'f');
+                });
+            };
+            WIN32_FIND_DATAW find_data;
+            auto find_handle = FindFirstFileExW((m_cache_dir_path + L"*").c_str(),
+                FindExInfoBasic, &find_data, FindExSearchNameMatch, nullptr, 0);
+            if (find_handle == INVALID_HANDLE_VALUE) { return; }
+            deferred([&] { FindClose(find_handle); });
+            do {
+                if (!(find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) { continue; }
+                std::wstring_view name = find_data.cFileName;
+                if (name == L"." || name == L".." || is_shard_dir_fn(name)) { continue; }
+                if (name == L"blobs") { continue; }
+                if (!util::fs::delete_folder((m_cache_dir_path + name).c_str())) {
+                    util::debug::log_warn(L"HttpCache: Cannot remove legacy folder `{}`", name);
+                }
+            } while (FindNextFileW(find_handle, &find_data) != 0);
+        }
+        // Relative path of the file of an entry, under a two-level fan-out of the key hash
+        // NOTE: The file also serves as the lock of the entry when its body is a shared blob
+        static winrt::hstring make_entry_file_path(winrt::hstring const& key) {
+            util::cryptography::Md5 md5;
+            md5.add_string(winrt::to_string(key));
+            md5.finialize();
+            return make_shard_path(md5.get_result_as_str());
+        }
+        static winrt::hstring make_shard_path(std::wstring_view hash) {
+            return winrt::hstring(std::format(L"{}\\{}\\{}", hash.substr(0, 2), hash.substr(2, 2), hash));
+        }
+        static bool is_blob_path(std::wstring_view path) {
+            return path.starts_with(BLOB_PATH_PREFIX);
+        }
+        // Returns the size of a body file, or std::nullopt if it does not exist
+        std::optional<uint64_t> get_body_size(std::wstring_view path) {
+            WIN32_FILE_ATTRIBUTE_DATA attr_data;
+            if (!GetFileAttributesExFromAppW((m_cache_dir_path + path).c_str(), GetFileExInfoStandard, &attr_data)) {
+                return std::nullopt;
+            }
+            return (static_cast<uint64_t>(attr_data.nFileSizeHigh) << 32) | attr_data.nFileSizeLow;
+        }
+        // Blobs may be shared by several entries, and are only deleted once none refers to them
+        void queue_orphan_blob(std::wstring_view path) {
+            if (!is_blob_path(path)) { return; }
+            std::scoped_lock guard(m_mutex_orphans);
+            m_orphan_blobs.emplace(path);
+        }
+        // NOTE: Pending writes must have been flushed before
+        void sweep_orphan_blobs(void) {
+            std::set<winrt::hstring> candidates;
+            {
+                std::scoped_lock guard(m_mutex_orphans);
+                candidates.swap(m_orphan_blobs);
+            }
+            for (auto const& path : candidates) {
+                Sqlite3Statement db_stmt(m_stmt_pool, L"SELECT 1 FROM entries WHERE file = ? LIMIT 1;");
+                db_stmt.bind(1, path, false);
+                if (db_stmt.step()) { continue; }
+                // NOTE: A concurrent fetch might just be reusing the blob; it will notice
+                //       the missing file and fetch again
+                util::fs::delete_file_if_exists((m_cache_dir_path + path).c_str());
+            }
+        }
+
         void check_uri_scheme(winrt::Windows::Foundation::Uri const& uri) {
             auto uri_scheme_name = uri.SchemeName();
             if (uri_scheme_name != L"http" && uri_scheme_name != L"https") {
@@ -309,9 +1059,6 @@ namespace BiliUWP {
         winrt::hstring preprocess_uri(winrt::Windows::Foundation::Uri const& uri) {
             check_uri_scheme(uri);
             std::wstring uri_path{ uri.Path() };
-            if (uri_path.ends_with(L'/')) {
-                throw winrt::hresult_invalid_argument(L"HttpCache: Requested resource is not a file");
-            }
             /*for (auto& ch : uri_path) {
                 if (ch != L'/') { continue; }
                 ch = L'\\';
@@ -329,41 +1076,254 @@ namespace BiliUWP {
                 std::chrono::system_clock::now().time_since_epoch()).count());
         }
 
+        // NOTE: Pending writes take precedence over the database
         std::optional<TableRecord> lookup_record(winrt::hstring const& key) {
-            Sqlite3Statement db_stmt(m_db,
-                L"SELECT default_age, age, life_start_ts FROM entries WHERE path = ?;");
+            {
+                std::scoped_lock guard(m_mutex_pending_writes);
+                auto it = m_pending_writes.find(key);
+                if (it != m_pending_writes.end()) { return it->second; }
+            }
+            Sqlite3Statement db_stmt(m_stmt_pool, L"SELECT default_age, age, life_start_ts, "
+                "size, last_access_ts, etag, last_modified, stale_ttl, file FROM entries WHERE path = ?;");
             db_stmt.bind(1, key, false);
             if (!db_stmt.step()) { return std::nullopt; }
             return TableRecord{
                 .default_age = static_cast<uint64_t>(db_stmt.col_i64(0)),
                 .age = static_cast<uint64_t>(db_stmt.col_i64(1)),
                 .life_start_ts = static_cast<uint64_t>(db_stmt.col_i64(2)),
+                .size = static_cast<uint64_t>(db_stmt.col_i64(3)),
+                .last_access_ts = static_cast<uint64_t>(db_stmt.col_i64(4)),
+                .etag = db_stmt.col_str16(5),
+                .last_modified = db_stmt.col_str16(6),
+                .stale_ttl = static_cast<uint64_t>(db_stmt.col_i64(7)),
+                .file = db_stmt.col_str16(8),
             };
         }
         void remove_record(winrt::hstring const& key) {
-            Sqlite3Statement db_stmt(m_db, L"DELETE FROM entries WHERE path = ?;");
-            db_stmt.bind(1, key, false);
-            db_stmt.step();
+            queue_write(key, std::nullopt);
         }
         void insert_record(winrt::hstring const& key, TableRecord const& new_record) {
-            Sqlite3Statement db_stmt(m_db, L"INSERT INTO entries VALUES(?, ?, ?, ?);");
-            db_stmt.bind(1, key, false);
-            db_stmt.bind(2, static_cast<int64_t>(new_record.default_age));
-            db_stmt.bind(3, static_cast<int64_t>(new_record.age));
-            db_stmt.bind(4, static_cast<int64_t>(new_record.life_start_ts));
-            db_stmt.step();
+            queue_write(key, new_record);
         }
         void update_record(winrt::hstring const& key, TableRecord const& new_record) {
-            Sqlite3Statement db_stmt(m_db,
-                L"UPDATE entries SET default_age = ?, age = ?, life_start_ts = ? WHERE path = ?;");
-            db_stmt.bind(1, static_cast<int64_t>(new_record.default_age));
-            db_stmt.bind(2, static_cast<int64_t>(new_record.age));
-            db_stmt.bind(3, static_cast<int64_t>(new_record.life_start_ts));
-            db_stmt.bind(4, key, false);
-            db_stmt.step();
-        }
-        void remove_record_all(void) {
+            queue_write(key, new_record);
+        }
+        // NOTE: Must be called with m_mutex_flush held
+        void remove_record_all_nolock(void) {
+            {
+                std::scoped_lock guard(m_mutex_pending_writes);
+                m_pending_writes.clear();
+            }
             Sqlite3Statement(m_db, L"DELETE FROM entries;").step();
+            m_total_size = std::nullopt;
+        }
+
+        // Metadata writes are committed in batches by a background writer
+        // NOTE: A nullopt record means deletion
+        void queue_write(winrt::hstring const& key, std::optional<TableRecord> record) {
+            std::scoped_lock guard(m_mutex_pending_writes);
+            m_pending_writes.insert_or_assign(key, std::move(record));
+            if (!m_writer_scheduled) {
+                m_writer_scheduled = true;
+                // SAFETY: run_writer resumes in background before touching pending writes
+                m_writer = run_writer();
+            }
+        }
+        util::winrt::task<> run_writer(void) {
+            auto strong_this = shared_from_this();
+            co_await winrt::resume_background();
+            co_await METADATA_WRITE_BEHIND_DELAY;
+            try { flush_pending_writes(); }
+            catch (...) {
+                // NOTE: Failed writes stay pending and are retried by the next flush
+                util::winrt::log_current_exception();
+            }
+            kick_evictor();
+        }
+        // Records an access to an existing entry
+        void touch_record(winrt::hstring const& key, uint64_t cur_ts) {
+            auto record = lookup_record(key);
+            if (!record || cur_ts < record->last_access_ts + LAST_ACCESS_UPDATE_INTERVAL) { return; }
+            record->last_access_ts = cur_ts;
+            queue_write(key, *record);
+        }
+
+        void kick_prefetchers(void) {
+            std::scoped_lock guard(m_mutex_prefetch);
+            size_t queued_count = 0;
+            for (auto const& queue : m_prefetch_queues) { queued_count += queue.size(); }
+            while (m_prefetchers_running < std::min(queued_count, PREFETCH_MAX_CONCURRENCY)) {
+                m_prefetchers_running++;
+                // SAFETY: run_prefetcher resumes in background before touching the queues
+                run_prefetcher();
+            }
+        }
+        // Works through the prefetch queues, higher priorities first, until they are empty
+        util::winrt::task<> run_prefetcher(void) {
+            auto strong_this = shared_from_this();
+            co_await winrt::resume_background();
+            while (true) {
+                // NOTE: Regular fetches go first; wait for them instead of competing
+                while (m_regular_fetches.load() > 0) {
+                    co_await PREFETCH_YIELD_INTERVAL;
+                }
+                PrefetchItem item;
+                {
+                    std::scoped_lock guard(m_mutex_prefetch);
+                    auto it = std::find_if(std::rbegin(m_prefetch_queues), std::rend(m_prefetch_queues),
+                        [](auto const& queue) { return !queue.empty(); });
+                    if (it == std::rend(m_prefetch_queues)) {
+                        m_prefetchers_running--;
+                        co_return;
+                    }
+                    item = std::move(it->front());
+                    it->pop_front();
+                }
+                try {
+                    // NOTE: Uri results keep the body out of the hot tier, which is reserved
+                    //       for resources actually in use
+                    co_await fetch_async_inner(item.uri, std::nullopt, true, true, true);
+                }
+                catch (...) {
+                    util::winrt::log_current_exception();
+                }
+                item.batch->complete_one();
+            }
+        }
+
+        // NOTE: Shared blobs are counted once per entry
+        uint64_t get_total_size(void) {
+            std::scoped_lock guard(m_mutex_flush);
+            if (!m_total_size) {
+                Sqlite3Statement db_stmt(m_stmt_pool, L"SELECT COALESCE(SUM(size), 0) FROM entries;");
+                m_total_size = db_stmt.step() ? static_cast<uint64_t>(db_stmt.col_i64(0)) : 0;
+            }
+            return *m_total_size;
+        }
+        void kick_evictor(void) {
+            std::scoped_lock guard(m_mutex_evictor);
+            if (m_evictor_running) { return; }
+            m_evictor_running = true;
+            // SAFETY: run_evictor resumes in background before doing anything
+            m_evictor = run_evictor();
+        }
+        // Deletes least recently used entries in small batches until the cache fits into capacity
+        // NOTE: Entries whose files are in use cannot be deleted and are skipped; eviction
+        //       only gives up once all entries have been tried
+        util::winrt::task<> run_evictor(void) {
+            auto strong_this = shared_from_this();
+            co_await winrt::resume_background();
+            deferred([&] {
+                std::scoped_lock guard(m_mutex_evictor);
+                m_evictor_running = false;
+            });
+            try {
+                // Count of entries skipped for being in use, which stay ahead of the rest
+                int64_t skipped_count = 0;
+                while (true) {
+                    flush_pending_writes();
+                    sweep_orphan_blobs();
+                    if (get_total_size() <= m_capacity.load()) { break; }
+                    std::vector<std::pair<winrt::hstring, winrt::hstring>> victims;
+                    {
+                        Sqlite3Statement db_stmt(m_stmt_pool,
+                            L"SELECT path, file FROM entries ORDER BY last_access_ts ASC LIMIT ? OFFSET ?;");
+                        db_stmt.bind(1, EVICTION_BATCH_SIZE);
+                        db_stmt.bind(2, skipped_count);
+                        while (db_stmt.step()) {
+                            victims.emplace_back(db_stmt.col_str16(0), db_stmt.col_str16(1));
+                        }
+                    }
+                    if (victims.empty()) {
+                        util::debug::log_warn(L"HttpCache: Over capacity, but no entry can be evicted");
+                        break;
+                    }
+                    for (auto const& [key, file] : victims) {
+                        {
+                            // NOTE: Entries being fetched are in use
+                            std::scoped_lock guard(m_mutex_inflight);
+                            if (m_inflight_fetches.contains(key)) {
+                                skipped_count++;
+                                continue;
+                            }
+                        }
+                        m_hot_tier.erase(key);
+                        auto file_path = make_entry_file_path(key);
+                        if (!util::fs::delete_file_if_exists((m_cache_dir_path + file_path).c_str())) {
+                            skipped_count++;
+                            continue;
+                        }
+                        remove_record(key);
+                        queue_orphan_blob(file);
+                    }
+                    co_await EVICTION_BATCH_INTERVAL;
+                }
+            }
+            catch (...) {
+                util::winrt::log_current_exception();
+            }
+        }
+        // Commits all pending writes in a single transaction
+        void flush_pending_writes(void) {
+            std::scoped_lock guard_flush(m_mutex_flush);
+            flush_pending_writes_nolock();
+        }
+        // NOTE: Must be called with m_mutex_flush held
+        void flush_pending_writes_nolock(void) {
+            std::map<winrt::hstring, std::optional<TableRecord>> batch;
+            {
+                std::scoped_lock guard(m_mutex_pending_writes);
+                m_writer_scheduled = false;
+                // NOTE: Writes remain visible in the overlay until committed
+                batch = m_pending_writes;
+            }
+            if (batch.empty()) { return; }
+            Sqlite3Statement(m_db, L"BEGIN IMMEDIATE;").step();
+            bool committed = false;
+            deferred([&] {
+                if (!committed) { sqlite3_exec(m_db, "ROLLBACK;", nullptr, nullptr, nullptr); }
+            });
+            int64_t size_delta = 0;
+            for (auto const& [key, record] : batch) {
+                if (m_total_size) {
+                    Sqlite3Statement db_stmt(m_stmt_pool, L"SELECT size FROM entries WHERE path = ?;");
+                    db_stmt.bind(1, key, false);
+                    if (db_stmt.step()) { size_delta -= db_stmt.col_i64(0); }
+                    if (record) { size_delta += static_cast<int64_t>(record->size); }
+                }
+                if (record) {
+                    Sqlite3Statement db_stmt(m_stmt_pool, L"INSERT OR REPLACE INTO entries"
+                        "(path, default_age, age, life_start_ts, size, last_access_ts, etag, last_modified, stale_ttl, file)"
+                        " VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?);");
+                    db_stmt.bind(1, key, false);
+                    db_stmt.bind(2, static_cast<int64_t>(record->default_age));
+                    db_stmt.bind(3, static_cast<int64_t>(record->age));
+                    db_stmt.bind(4, static_cast<int64_t>(record->life_start_ts));
+                    db_stmt.bind(5, static_cast<int64_t>(record->size));
+                    db_stmt.bind(6, static_cast<int64_t>(record->last_access_ts));
+                    db_stmt.bind(7, record->etag, false);
+                    db_stmt.bind(8, record->last_modified, false);
+                    db_stmt.bind(9, static_cast<int64_t>(record->stale_ttl));
+                    db_stmt.bind(10, record->file, false);
+                    db_stmt.step();
+                }
+                else {
+                    Sqlite3Statement db_stmt(m_stmt_pool, L"DELETE FROM entries WHERE path = ?;");
+                    db_stmt.bind(1, key, false);
+                    db_stmt.step();
+                }
+            }
+            Sqlite3Statement(m_db, L"COMMIT;").step();
+            committed = true;
+            if (m_total_size) { *m_total_size += size_delta; }
+            std::scoped_lock guard(m_mutex_pending_writes);
+            for (auto const& [key, record] : batch) {
+                // Keep writes which were superseded while committing
+                auto it = m_pending_writes.find(key);
+                if (it != m_pending_writes.end() && it->second == record) {
+                    m_pending_writes.erase(it);
+                }
+            }
         }
         /*
         template<typename Functor>
@@ -380,11 +1340,513 @@ namespace BiliUWP {
         }
         */
 
+        // NOTE: The hot tier is consulted first; on miss, concurrent requests for the
+        //       same resource share a single fetch
+        // NOTE: Prefetches are held back while regular fetches are running
         IAsyncOperationWithProgress<IInspectable, HttpProgress> fetch_async_inner(
             winrt::Windows::Foundation::Uri uri,
             std::optional<uint64_t> override_age,
             bool uri_as_result,
-            bool uri_return_abs
+            bool uri_return_abs,
+            bool is_prefetch = false
+        ) {
+            auto progress_token = co_await winrt::get_progress_token();
+            if (!is_prefetch) { m_regular_fetches++; }
+            deferred([&] {
+                if (!is_prefetch) { m_regular_fetches--; }
+            });
+
+            auto local_path = preprocess_uri(uri);
+            co_await winrt::resume_background();
+            if (auto result = lookup_hot_result(local_path, uri_as_result, uri_return_abs)) {
+                co_return result;
+            }
+            std::shared_ptr<InflightFetch> inflight;
+            bool is_owner = false;
+            util::winrt::task<> op;
+            {
+                std::scoped_lock guard(m_mutex_inflight);
+                auto it = m_inflight_fetches.find(local_path);
+                if (it != m_inflight_fetches.end()) {
+                    inflight = it->second;
+                    m_hot_tier.record_coalesced();
+                }
+                else {
+                    inflight = std::make_shared<InflightFetch>();
+                    inflight->progress_handler = [&](HttpProgress const& progress) { progress_token(progress); };
+                    is_owner = true;
+                    // SAFETY: fetch_shared resumes in background before touching the table
+                    inflight->op = fetch_shared(uri, local_path, override_age, !uri_as_result, inflight);
+                    m_inflight_fetches.emplace(local_path, inflight);
+                }
+                op = inflight->op;
+            }
+            deferred([&] {
+                if (!is_owner || !inflight) { return; }
+                std::scoped_lock guard(inflight->mutex);
+                inflight->progress_handler = nullptr;
+            });
+            co_await op;
+            // NOTE: Requests are always served from the result of the shared fetch, as the
+            //       resource may already be expired (or not cached at all) by now
+            IBuffer data{ nullptr };
+            IRandomAccessStream stream{ nullptr };
+            winrt::Windows::Foundation::Uri result_uri{ nullptr };
+            {
+                std::scoped_lock guard(inflight->mutex);
+                data = inflight->data;
+                stream = inflight->stream;
+                result_uri = inflight->uri;
+            }
+            if (!uri_as_result) {
+                if (data) { co_return winrt::make<util::winrt::BufferBackedRandomAccessStream>(data); }
+                if (stream) { co_return stream.CloneStream(); }
+            }
+            else if (result_uri && uri_return_abs) {
+                co_return result_uri;
+            }
+            // The shared fetch produced the other kind of result; serve from the body it stored
+            // WARN: The shared stream may hold the key lock, so it must be let go before
+            //       waiting for the lock below, or writers queued in between would deadlock
+            stream = nullptr;
+            inflight = nullptr;
+            // NOTE: Waits for the body to be completely downloaded
+            auto key_guard = co_await m_key_locks.lock_shared(local_path);
+            auto record = lookup_record(local_path);
+            if (!record) {
+                throw winrt::hresult_error(E_FAIL, L"HttpCache: Fetched resource is no longer stored");
+            }
+            if (uri_as_result) { co_return make_result_uri(record->file, uri_return_abs); }
+            if (is_blob_path(record->file)) { co_return make_body_stream(record->file, nullptr); }
+            std::shared_ptr<void> lock_holder{
+                new HttpCacheKeyLocks::Guard(std::move(key_guard)),
+                [strong_this = shared_from_this()](void* p) {
+                    delete static_cast<HttpCacheKeyLocks::Guard*>(p);
+                }
+            };
+            co_return make_body_stream(record->file, std::move(lock_holder));
+        }
+        // NOTE: Runs detached from the initiating request, so that other requests waiting
+        //       for the same resource are not affected by it going away
+        util::winrt::task<> fetch_shared(
+            winrt::Windows::Foundation::Uri uri,
+            winrt::hstring local_path,
+            std::optional<uint64_t> override_age,
+            bool load_data,
+            std::shared_ptr<InflightFetch> inflight
+        ) {
+            auto strong_this = shared_from_this();
+            co_await winrt::resume_background();
+            deferred([&] {
+                std::scoped_lock guard(m_mutex_inflight);
+                m_inflight_fetches.erase(local_path);
+            });
+            auto op = fetch_to_disk_async(uri, override_age, !load_data, true, true);
+            op.Progress([&](auto&&, HttpProgress const& progress) {
+                std::scoped_lock guard(inflight->mutex);
+                if (inflight->progress_handler) { inflight->progress_handler(progress); }
+            });
+            auto result = co_await std::move(op);
+            IBuffer data{ nullptr };
+            if (load_data) {
+                auto stream = result.as<IRandomAccessStream>();
+                auto size = stream.Size();
+                if (size > HOT_TIER_MAX_ENTRY_SIZE) {
+                    // NOTE: The body may still be downloading; let requests read it as it arrives
+                    std::scoped_lock guard(inflight->mutex);
+                    inflight->stream = std::move(stream);
+                    co_return;
+                }
+                // NOTE: Streams may return data in a buffer other than the one passed in
+                IBuffer buf = Buffer(static_cast<uint32_t>(size));
+                buf = co_await stream.ReadAsync(buf, static_cast<uint32_t>(size), InputStreamOptions::None);
+                if (buf.Length() != size) {
+                    // Let requests read the body from the stream instead
+                    std::scoped_lock guard(inflight->mutex);
+                    inflight->stream = std::move(stream);
+                    co_return;
+                }
+                stream.Close();
+                data = std::move(buf);
+                std::scoped_lock guard(inflight->mutex);
+                inflight->data = data;
+            }
+            else {
+                std::scoped_lock guard(inflight->mutex);
+                inflight->uri = result.as<winrt::Windows::Foundation::Uri>();
+            }
+            auto record = lookup_record(local_path);
+            if (!record) { co_return; }
+            // NOTE: Stale entries served during revalidation are not worth keeping
+            if (get_cur_ts() > record->age + record->life_start_ts) { co_return; }
+            HttpCacheHotTier::Entry entry{
+                .data = std::move(data),
+                .expiry_ts = record->age + record->life_start_ts,
+                .last_access_ts = record->last_access_ts,
+                .file = record->file,
+            };
+            m_hot_tier.insert(local_path, std::move(entry));
+        }
+        IInspectable lookup_hot_result(winrt::hstring const& local_path, bool uri_as_result, bool uri_return_abs) {
+            auto cur_ts = get_cur_ts();
+            auto entry = m_hot_tier.lookup(local_path, cur_ts, !uri_as_result);
+            if (!entry) { return nullptr; }
+            if (cur_ts >= entry->last_access_ts + LAST_ACCESS_UPDATE_INTERVAL) {
+                touch_record(local_path, cur_ts);
+            }
+            if (uri_as_result) { return make_result_uri(entry->file, uri_return_abs); }
+            // NOTE: The buffer is shared between hits; consumers only read from it
+            return winrt::make<util::winrt::BufferBackedRandomAccessStream>(entry->data);
+        }
+        // NOTE: file_path is relative to the cache folder
+        winrt::Windows::Foundation::Uri make_result_uri(winrt::hstring const& file_path, bool uri_return_abs) {
+            if (uri_return_abs) {
+                return winrt::Windows::Foundation::Uri(m_cache_dir_path + file_path);
+            }
+            std::wstring local_path_buf{ file_path };
+            for (auto& i : local_path_buf) {
+                if (i != L'\\') { continue; }
+                i = L'/';
+            }
+            return winrt::Windows::Foundation::Uri(m_cache_dir_uri_str, local_path_buf);
+        }
+        // NOTE: file_path is relative to the cache folder
+        // NOTE: Entry files must be kept from writers by lock_holder for as long as
+        //       the stream (or any of its clones) is alive
+        IRandomAccessStream make_body_stream(winrt::hstring const& file_path, std::shared_ptr<void> lock_holder) {
+            if (is_blob_path(file_path)) {
+                // NOTE: Blobs are never modified in place, so they are read without locks
+                auto open_blob_fn = [blob_path = m_cache_dir_path + file_path] {
+                    auto blob_file = util::win32::overlapped_file::open(
+                        blob_path.c_str(),
+                        GENERIC_READ,
+                        FILE_SHARE_READ | FILE_SHARE_DELETE,
+                        OPEN_EXISTING
+                    );
+                    if (!blob_file) { winrt::throw_last_error(); }
+                    return blob_file;
+                };
+                return winrt::make<Win32FileReadOnlyRandomAccessStream>(open_blob_fn, nullptr);
+            }
+            auto open_entry_fn = [full_path = m_cache_dir_path + file_path] {
+                // NOTE: Must share writing, as entry files are kept open for writing by fetches
+                auto data_file = util::win32::overlapped_file::open(
+                    full_path.c_str(),
+                    GENERIC_READ,
+                    FILE_SHARE_READ | FILE_SHARE_WRITE,
+                    OPEN_EXISTING
+                );
+                if (!data_file) { winrt::throw_last_error(); }
+                return data_file;
+            };
+            return winrt::make<Win32FileReadOnlyRandomAccessStream>(open_entry_fn, std::move(lock_holder));
+        }
+        // Starts a background refresh of a stale entry, unless one is already running
+        void schedule_revalidation(
+            winrt::Windows::Foundation::Uri const& uri,
+            winrt::hstring const& local_path,
+            std::optional<uint64_t> override_age
+        ) {
+            std::scoped_lock guard(m_mutex_inflight);
+            if (!m_revalidating.insert(local_path).second) { return; }
+            // SAFETY: revalidate_async resumes in background before touching the set
+            revalidate_async(uri, local_path, override_age);
+        }
+        util::winrt::task<> revalidate_async(
+            winrt::Windows::Foundation::Uri uri,
+            winrt::hstring local_path,
+            std::optional<uint64_t> override_age
+        ) {
+            auto strong_this = shared_from_this();
+            co_await winrt::resume_background();
+            deferred([&] {
+                std::scoped_lock guard(m_mutex_inflight);
+                m_revalidating.erase(local_path);
+            });
+            util::debug::log_trace(L"HttpCache: Revalidating stale resource `{}`...", uri);
+            co_await fetch_to_disk_async(uri, override_age, true, true, false);
+        }
+        // Parses the response headers into (max age, stale ttl)
+        static std::pair<uint64_t, uint64_t> get_response_lifetime(HttpResponseMessage const& http_resp) {
+            using std::chrono::floor;
+            using std::chrono::seconds;
+            auto http_resp_cache_control_hdr = http_resp.Headers().CacheControl();
+            uint64_t stale_ttl = 0;
+            for (auto&& directive : http_resp_cache_control_hdr) {
+                if (_wcsicmp(directive.Name().c_str(), L"stale-while-revalidate") != 0) { continue; }
+                stale_ttl = std::wcstoull(directive.Value().c_str(), nullptr, 10);
+            }
+            if (auto nullable_max_age = http_resp_cache_control_hdr.MaxAge()) {
+                return { static_cast<uint64_t>(floor<seconds>(nullable_max_age.Value()).count()), stale_ttl };
+            }
+            // Heuristic freshness (RFC 7234 4.2.2): 10% of the time since last modification
+            auto http_cont = http_resp.Content();
+            auto nullable_last_modified = http_cont ? http_cont.Headers().LastModified() : nullptr;
+            if (!nullable_last_modified) { return { 0, stale_ttl }; }
+            auto nullable_date = http_resp.Headers().Date();
+            auto date = nullable_date ? nullable_date.Value() : winrt::clock::now();
+            auto elapsed = floor<seconds>(date - nullable_last_modified.Value()).count();
+            if (elapsed <= 0) { return { 0, stale_ttl }; }
+            return { std::min(static_cast<uint64_t>(elapsed) / 10, HEURISTIC_MAX_AGE_LIMIT), stale_ttl };
+        }
+        static void create_parent_dirs(std::wstring_view path) {
+            winrt::hstring path_base_dir{ path.substr(0, path.rfind(L'\\')) };
+            if (!util::fs::create_dir_all(path_base_dir.c_str())) {
+                throw winrt::hresult_error(E_FAIL, L"HttpCache: Failed to create directories");
+            }
+        }
+        // Where bodies to be de-duplicated are downloaded to, before their hash is known
+        static winrt::hstring make_tmp_file_path(winrt::hstring const& entry_file_path) {
+            std::wstring_view entry_file_view = entry_file_path;
+            return winrt::hstring(std::format(L"{}tmp\\{}", BLOB_PATH_PREFIX,
+                entry_file_view.substr(entry_file_view.rfind(L'\\') + 1)));
+        }
+        // Everything needed to store a fetched body, which may outlive the fetching request
+        struct BodyStoreArgs {
+            winrt::hstring local_path;
+            winrt::hstring entry_file_path;
+            winrt::hstring write_path;      // Relative path the body is downloaded to
+            bool dedup;
+            std::optional<uint64_t> override_age;
+            uint64_t cur_ts;
+            HttpResponseMessage http_resp;
+            std::optional<TableRecord> prev_record;
+            uint64_t max_age;
+            uint64_t stale_ttl;
+            winrt::hstring etag;
+            winrt::hstring last_modified;
+        };
+        void write_entry_record(BodyStoreArgs const& args, winrt::hstring const& file) {
+            auto file_size = get_body_size(file);
+            if (!file_size) {
+                throw winrt::hresult_error(E_FAIL, L"HttpCache: Body file vanished unexpectedly");
+            }
+            if (auto ov = lookup_record(args.local_path)) {
+                ov->default_age = args.max_age;
+                ov->age = args.override_age.value_or(args.max_age);
+                ov->life_start_ts = args.cur_ts;
+                ov->size = *file_size;
+                ov->last_access_ts = args.cur_ts;
+                ov->etag = args.etag;
+                ov->last_modified = args.last_modified;
+                ov->stale_ttl = args.stale_ttl;
+                ov->file = file;
+                update_record(args.local_path, *ov);
+            }
+            else {
+                TableRecord rec{
+                    .default_age = args.max_age,
+                    .age = args.override_age.value_or(args.max_age),
+                    .life_start_ts = args.cur_ts,
+                    .size = *file_size,
+                    .last_access_ts = args.cur_ts,
+                    .etag = args.etag,
+                    .last_modified = args.last_modified,
+                    .stale_ttl = args.stale_ttl,
+                    .file = file,
+                };
+                insert_record(args.local_path, rec);
+            }
+        }
+        // Opens the file the body is downloaded to
+        util::win32::overlapped_file open_body_out_file(BodyStoreArgs const& args) {
+            util::win32::overlapped_file out_file;
+            if (args.dedup) {
+                // NOTE: With de-duplication, the body is downloaded into a temporary file
+                //       first, then moved to the blob named after its content hash
+                auto tmp_path = m_cache_dir_path + args.write_path;
+                auto open_tmp_fn = [&] {
+                    // NOTE: Tee streams read (and outlive) the file while it is being moved
+                    return util::win32::overlapped_file::open(tmp_path.c_str(), GENERIC_WRITE,
+                        FILE_SHARE_READ | FILE_SHARE_DELETE, CREATE_ALWAYS);
+                };
+                out_file = open_tmp_fn();
+                if (!out_file) {
+                    create_parent_dirs(tmp_path);
+                    out_file = open_tmp_fn();
+                }
+            }
+            else {
+                // NOTE: hfile is synchronous, so the body goes through another handle
+                out_file = util::win32::overlapped_file::open(
+                    (m_cache_dir_path + args.entry_file_path).c_str(), GENERIC_WRITE,
+                    FILE_SHARE_READ | FILE_SHARE_WRITE, OPEN_EXISTING);
+            }
+            if (!out_file) { winrt::throw_last_error(); }
+            return out_file;
+        }
+        // Downloads the body into out_file and records the entry
+        // NOTE: Caller must hold both the key lock and the file lock exclusively
+        // NOTE: If tee is not null, it is advanced as data is written, and always finished
+        util::winrt::task<> store_body_async(
+            winrt::file_handle const& hfile,
+            util::win32::overlapped_file out_file,
+            BodyStoreArgs args,
+            std::shared_ptr<HttpCacheTee> tee,
+            std::function<void(HttpProgress const&)> progress_handler
+        ) {
+            struct Win32FileOutputStream :
+                winrt::implements<Win32FileOutputStream, IOutputStream, IClosable>
+            {
+                Win32FileOutputStream(util::win32::overlapped_file const& file, util::cryptography::Md5* md5,
+                    HttpCacheTee* tee) : m_file(file), m_md5(md5), m_tee(tee), m_offset(0) {}
+                void Close() {}
+                IAsyncOperationWithProgress<uint32_t, uint32_t> WriteAsync(IBuffer const& buffer) {
+                    // NOTE: Take a reference before suspending, as the parameter may not outlive it
+                    auto data = buffer;
+                    auto strong_this = get_strong();
+                    auto progress_token = co_await winrt::get_progress_token();
+                    // NOTE: Writes are sequential, so the offset is only touched by one operation
+                    auto data_len = data.Length();
+                    progress_token(0);
+                    auto written_len = co_await m_file.write_at_async(m_offset, data.data(), data_len);
+                    m_offset += written_len;
+                    if (m_md5) {
+                        m_md5->add_string(std::string_view(
+                            reinterpret_cast<const char*>(data.data()), written_len));
+                    }
+                    if (m_tee) { m_tee->advance(written_len); }
+                    progress_token(written_len);
+                    co_return written_len;
+                }
+                IAsyncOperation<bool> FlushAsync() {
+                    co_return FlushFileBuffers(m_file.get());
+                }
+                uint64_t written_size() const noexcept { return m_offset; }
+            private:
+                util::win32::overlapped_file const& m_file;
+                util::cryptography::Md5* m_md5;
+                HttpCacheTee* m_tee;
+                uint64_t m_offset;
+            };
+            try {
+                std::optional<util::cryptography::Md5> content_md5;
+                if (args.dedup) { content_md5.emplace(); }
+                auto tmp_path = m_cache_dir_path + args.write_path;
+                auto out_stream = winrt::make_self<Win32FileOutputStream>(
+                    out_file, content_md5 ? &*content_md5 : nullptr, tee.get());
+                auto http_cont = args.http_resp.Content();
+                auto op = http_cont.WriteToStreamAsync(out_stream.as<IOutputStream>());
+                HttpProgress http_progress{
+                    .Stage = HttpProgressStage::ReceivingContent,
+                    .BytesSent = 0,
+                    .TotalBytesToSend = nullptr,
+                    .BytesReceived = 0,
+                    .TotalBytesToReceive = http_cont.Headers().ContentLength(),
+                    .Retries = 0,
+                };
+                if (progress_handler) {
+                    progress_handler(http_progress);
+                    op.Progress([&](auto const&, uint64_t progress) {
+                        http_progress.BytesReceived = progress;
+                        progress_handler(http_progress);
+                    });
+                }
+                co_await std::move(op);
+                auto written_size = out_stream->written_size();
+                out_file.close();
+                winrt::hstring res_file;
+                if (args.dedup) {
+                    content_md5->finialize();
+                    res_file = winrt::hstring(std::wstring(BLOB_PATH_PREFIX) +
+                        make_shard_path(content_md5->get_result_as_str()));
+                    auto blob_path = m_cache_dir_path + res_file;
+                    if (get_body_size(res_file) == written_size) {
+                        // Identical body is already stored
+                        util::fs::delete_file_if_exists(tmp_path.c_str());
+                    }
+                    else {
+                        create_parent_dirs(blob_path);
+                        if (!util::fs::delete_file_if_exists(blob_path.c_str()) ||
+                            !util::fs::rename_path(tmp_path.c_str(), blob_path.c_str()))
+                        {
+                            util::fs::delete_file_if_exists(tmp_path.c_str());
+                            throw winrt::hresult_error(E_FAIL, L"HttpCache: Failed to store blob");
+                        }
+                    }
+                    // NOTE: The entry file is only kept as the lock
+                    SetFilePointer(hfile.get(), 0, nullptr, FILE_BEGIN);
+                    winrt::check_bool(SetEndOfFile(hfile.get()));
+                }
+                else {
+                    // NOTE: Drop leftovers from a previous, longer version of the resource
+                    winrt::check_bool(SetFilePointerEx(hfile.get(),
+                        { .QuadPart = static_cast<LONGLONG>(written_size) }, nullptr, FILE_BEGIN));
+                    winrt::check_bool(SetEndOfFile(hfile.get()));
+                    SetFilePointer(hfile.get(), 0, nullptr, FILE_BEGIN);
+                    res_file = args.entry_file_path;
+                }
+                if (args.prev_record && args.prev_record->file != res_file) {
+                    queue_orphan_blob(args.prev_record->file);
+                }
+                write_entry_record(args, res_file);
+            }
+            catch (...) {
+                if (tee) { tee->finish(std::current_exception()); }
+                throw;
+            }
+            if (tee) { tee->finish(nullptr); }
+        }
+        // Keeps writers out of an entry, by holding the key lock and the file lock on hfile
+        struct EntryFileLock {
+            HttpCacheKeyLocks::Guard key_guard;
+            winrt::file_handle hfile;
+        };
+        std::shared_ptr<EntryFileLock> make_entry_file_lock(
+            HttpCacheKeyLocks::Guard key_guard, winrt::file_handle hfile
+        ) {
+            return {
+                new EntryFileLock{ std::move(key_guard), std::move(hfile) },
+                [strong_this = shared_from_this()](EntryFileLock* p) { delete p; }
+            };
+        }
+        static void unlock_file(HANDLE hfile) {
+            OVERLAPPED ol{};
+            ol.OffsetHigh = FILE_LOCK_OFFSET_HIGH;
+            winrt::check_bool(UnlockFileEx(hfile, 0, 16, 0, &ol));
+        }
+        // Finishes storing a body in background, after its tee stream has been handed out
+        // NOTE: The entry lock is downgraded once the body is complete, and then held by the
+        //       tee streams only
+        util::winrt::task<> store_body_detached_async(
+            std::shared_ptr<EntryFileLock> entry_lock,
+            util::win32::overlapped_file out_file,
+            BodyStoreArgs args,
+            std::shared_ptr<HttpCacheTee> tee
+        ) {
+            auto strong_this = shared_from_this();
+            co_await winrt::resume_background();
+            // NOTE: Other fetches of the same resource wait for the key lock until the body is complete
+            try {
+                co_await store_body_async(entry_lock->hfile, std::move(out_file),
+                    std::move(args), std::move(tee), nullptr);
+            }
+            catch (...) {
+                util::winrt::log_current_exception();
+            }
+            entry_lock->key_guard.downgrade();
+            unlock_file(entry_lock->hfile.get());
+            co_await lock_file_async(entry_lock->hfile.get(), false);
+        }
+        // NOTE: The file lock may be held by another process; poll instead of blocking a thread
+        static IAsyncAction lock_file_async(HANDLE hfile, bool exclusive) {
+            while (true) {
+                OVERLAPPED ol{};
+                ol.OffsetHigh = FILE_LOCK_OFFSET_HIGH;
+                DWORD flags = (exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0) | LOCKFILE_FAIL_IMMEDIATELY;
+                if (LockFileEx(hfile, flags, 0, 16, 0, &ol)) { co_return; }
+                if (GetLastError() != ERROR_LOCK_VIOLATION) { winrt::throw_last_error(); }
+                co_await FILE_LOCK_POLL_INTERVAL;
+            }
+        }
+        // NOTE: If allow_stale is true, entries within their stale-while-revalidate window
+        //       are served as is, and refreshed in background
+        IAsyncOperationWithProgress<IInspectable, HttpProgress> fetch_to_disk_async(
+            winrt::Windows::Foundation::Uri uri,
+            std::optional<uint64_t> override_age,
+            bool uri_as_result,
+            bool uri_return_abs,
+            bool allow_stale
         ) {
             // TODO: Issue: https://github.com/microsoft/microsoft-ui-xaml/issues/633
             auto progress_token = co_await winrt::get_progress_token();
@@ -399,35 +1861,24 @@ namespace BiliUWP {
             *       open;
             *   }
             *   if (open failed) { throw; }
+            *   lock key shared; lock file shared;
             *   while (true) {
-            *       lock file shared;
             *       if (lookup db && not expired) { return (file as stream); }
-            *       unlock file;
-            *       lock file unique;
-            *       if (lookup db && not expired) {
-            *           unlock file;
-            *           continue;
+            *       if (already fetched) { throw; }
+            *       unlock file; unlock key;
+            *       lock key unique; lock file unique;
+            *       if (!(lookup db && not expired)) {
+            *           fetch remote resource;
+            *           write file;     // Or return a tee stream and continue in background
+            *           update db;
             *       }
-            *       fetch remote resource;
-            *       write file;
-            *       update db;
-            *       unlock file;
+            *       downgrade key lock; downgrade file lock;
             *   }
+            *   NOTE: Key locks coordinate within the process without blocking threads;
+            *         file locks only matter for other processes
             */
-            //auto full_path = m_cache_dir_path + local_path;
-            std::wstring full_path{ local_path };
-            for (auto& ch : full_path) {
-                if (ch != L'/') { continue; }
-                ch = L'\\';
-            }
-            full_path = m_cache_dir_path + std::move(full_path);
-            auto create_dirs_fn = [&] {
-                std::wstring_view full_path_view = full_path;
-                winrt::hstring path_base_dir{ full_path_view.substr(0, full_path_view.rfind(L'\\')) };
-                if (!util::fs::create_dir_all(path_base_dir.c_str())) {
-                    throw winrt::hresult_error(E_FAIL, L"HttpCache: Failed to create directories");
-                }
-            };
+            auto entry_file_path = make_entry_file_path(local_path);
+            auto full_path = m_cache_dir_path + entry_file_path;
             auto open_file_fn = [=] {
                 // NOTE: Don't open in asynchronous mode
                 return CreateFile2FromAppW(
@@ -438,244 +1889,164 @@ namespace BiliUWP {
                     nullptr
                 );
             };
-            auto lock_file_fn = [](winrt::file_handle const& hfile, bool exclusive) {
-                OVERLAPPED ol;
-                ol.hEvent = nullptr;
-                ol.Offset = 0;
-                ol.OffsetHigh = 0;
-                winrt::check_bool(LockFileEx(
-                    hfile.get(),
-                    exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0,
-                    0,
-                    16, 0,
-                    &ol
-                ));
-            };
-            auto unlock_file_fn = [](winrt::file_handle const& hfile) {
-                OVERLAPPED ol;
-                ol.hEvent = nullptr;
-                ol.Offset = 0;
-                ol.OffsetHigh = 0;
-                winrt::check_bool(UnlockFileEx(hfile.get(), 0, 16, 0, &ol));
-            };
-            auto is_file_empty_fn = [](winrt::file_handle const& hfile) {
-                LARGE_INTEGER li;
-                winrt::check_bool(GetFileSizeEx(hfile.get(), &li));
-                return li.QuadPart == 0;
+            // NOTE: A record is only valid if its body file is intact
+            auto is_record_body_intact_fn = [&](TableRecord const& record) {
+                return !record.file.empty() && get_body_size(record.file) == record.size;
             };
+            bool needs_revalidation = false;
+            std::optional<TableRecord> cur_record;
             auto is_entry_record_fresh = [&] {
-                auto ov = lookup_record(local_path);
-                if (!ov) { return false; }
-                if (cur_ts > ov->age + ov->life_start_ts) { return false; }
-                return true;
+                needs_revalidation = false;
+                cur_record = lookup_record(local_path);
+                auto& ov = cur_record;
+                if (!ov || !is_record_body_intact_fn(*ov)) { return false; }
+                auto expiry_ts = ov->age + ov->life_start_ts;
+                if (cur_ts <= expiry_ts) { return true; }
+                if (allow_stale && cur_ts <= expiry_ts + ov->stale_ttl) {
+                    needs_revalidation = true;
+                    return true;
+                }
+                return false;
             };
             winrt::file_handle hfile{ open_file_fn() };
             if (!hfile) {
-                create_dirs_fn();
+                create_parent_dirs(full_path);
                 *hfile.put() = open_file_fn();
             }
             if (!hfile) { winrt::throw_last_error(); }
             auto require_fetch_fn = [&] {
-                return is_file_empty_fn(hfile) || !is_entry_record_fresh();
+                return !is_entry_record_fresh();
             };
-            const uint32_t MAX_LOOP_CNT = 10;
-            uint32_t loop_cnt = 0;
-            while (loop_cnt++ < MAX_LOOP_CNT) {
-                lock_file_fn(hfile, false);
+            auto key_guard = co_await m_key_locks.lock_shared(local_path);
+            co_await lock_file_async(hfile.get(), false);
+            bool fetched = false;
+            while (true) {
                 if (!require_fetch_fn()) {
+                    touch_record(local_path, cur_ts);
+                    if (needs_revalidation) {
+                        schedule_revalidation(uri, local_path, override_age);
+                    }
+                    auto body_file = cur_record->file;
                     if (uri_as_result) {
-                        if (uri_return_abs) {
-                            co_return Uri(full_path);
-                        }
-                        std::wstring local_path_buf{ local_path };
-                        for (auto& i : local_path_buf) {
-                            if (i != L'\\') { continue; }
-                            i = L'/';
-                        }
-                        co_return Uri(m_cache_dir_uri_str, local_path_buf);
+                        co_return make_result_uri(body_file, uri_return_abs);
                     }
-                    struct Win32FileReadOnlyRandomAccessStream :
-                        winrt::implements<Win32FileReadOnlyRandomAccessStream,
-                        IRandomAccessStream, IClosable, IInputStream, IOutputStream>
-                    {
-                        Win32FileReadOnlyRandomAccessStream(
-                            winrt::file_handle hfile,
-                            std::function<winrt::file_handle(winrt::file_handle const&)> file_cloner) :
-                            m_hfile(std::move(hfile)), m_file_cloner(std::move(file_cloner)) {}
-                        Win32FileReadOnlyRandomAccessStream(winrt::file_handle hfile,
-                            std::function<winrt::file_handle(winrt::file_handle const&)> file_cloner,
-                            uint64_t position) :
-                            Win32FileReadOnlyRandomAccessStream(std::move(hfile), std::move(file_cloner))
-                        {
-                            this->Seek(position);
-                        }
-                        ~Win32FileReadOnlyRandomAccessStream() { Close(); }
-                        void Close() { m_hfile.close(); }
-                        IAsyncOperationWithProgress<IBuffer, uint32_t> ReadAsync(
-                            IBuffer buffer, uint32_t count, InputStreamOptions options
-                        ) {
-                            // TODO: Maybe optimize thread scheduling
-                            //co_await winrt::resume_background();
-                            buffer.Length(count);
-                            auto actual_size = buffer.Length();
-                            DWORD dwRead;
-                            winrt::check_bool(ReadFile(
-                                m_hfile.get(), buffer.data(), actual_size, &dwRead, nullptr));
-                            buffer.Length(dwRead);
-                            co_return buffer;
-                        }
-                        IAsyncOperationWithProgress<uint32_t, uint32_t> WriteAsync(IBuffer const& buffer) {
-                            throw winrt::hresult_illegal_method_call();
-                        }
-                        IAsyncOperation<bool> FlushAsync() {
-                            co_return true;
-                        }
-                        uint64_t Size() {
-                            LARGE_INTEGER li;
-                            winrt::check_bool(GetFileSizeEx(m_hfile.get(), &li));
-                            return static_cast<uint64_t>(li.QuadPart);
-                        }
-                        void Size(uint64_t value) {
-                            throw winrt::hresult_illegal_method_call();
-                        }
-                        ::winrt::Windows::Storage::Streams::IInputStream GetInputStreamAt(uint64_t position) {
-                            return winrt::make<Win32FileReadOnlyRandomAccessStream>(
-                                m_file_cloner(m_hfile), m_file_cloner, position);
-                        }
-                        ::winrt::Windows::Storage::Streams::IOutputStream GetOutputStreamAt(uint64_t position) {
-                            throw winrt::hresult_illegal_method_call();
-                        }
-                        uint64_t Position() {
-                            LARGE_INTEGER li;
-                            winrt::check_bool(SetFilePointerEx(m_hfile.get(), {}, &li, FILE_CURRENT));
-                            return static_cast<uint64_t>(li.QuadPart);
-                        }
-                        void Seek(uint64_t position) {
-                            winrt::check_bool(SetFilePointerEx(
-                                m_hfile.get(),
-                                { .QuadPart = static_cast<LONGLONG>(position) },
-                                nullptr,
-                                FILE_BEGIN)
-                            );
-                        }
-                        IRandomAccessStream CloneStream() {
-                            return winrt::make<Win32FileReadOnlyRandomAccessStream>(
-                                m_file_cloner(m_hfile), m_file_cloner);
-                        }
-                        bool CanRead() { return true; }
-                        bool CanWrite() { return false; }
-                    private:
-                        winrt::file_handle m_hfile;
-                        std::function<winrt::file_handle(winrt::file_handle const&)> m_file_cloner;
-                    };
-                    co_return winrt::make<Win32FileReadOnlyRandomAccessStream>(std::move(hfile),
-                        [=](winrt::file_handle const&) {
-                            winrt::file_handle hfile{ open_file_fn() };
-                            if (!hfile) { winrt::throw_last_error(); }
-                            lock_file_fn(hfile, false);
-                            return hfile;
-                        }
-                    );
-                    /*auto file_stream = winrt::make<Win32FileReadOnlyRandomAccessStream>(std::move(hfile),
-                        [=](winrt::file_handle const&) {
-                            winrt::file_handle hfile{ open_file_fn() };
-                            if (!hfile) { winrt::throw_last_error(); }
-                            lock_file_fn(hfile, false);
-                            return hfile;
-                        }
-                    );
-                    InMemoryRandomAccessStream mem_stream;
-                    mem_stream.Size(file_stream.Size());
-                    RandomAccessStream::CopyAsync(file_stream, mem_stream);
-                    co_return mem_stream;*/
+                    if (is_blob_path(body_file)) {
+                        co_return make_body_stream(body_file, nullptr);
+                    }
+                    // NOTE: Writers are kept out for as long as the stream (or any of its clones)
+                    //       is alive, by holding the shared entry lock
+                    co_return make_body_stream(body_file,
+                        make_entry_file_lock(std::move(key_guard), std::move(hfile)));
+                }
+                if (fetched) {
+                    throw winrt::hresult_error(E_FAIL, L"HttpCache: Fetched resource is not usable");
                 }
-                unlock_file_fn(hfile);
-                lock_file_fn(hfile, true);
+                unlock_file(hfile.get());
+                key_guard.unlock();
+                key_guard = co_await m_key_locks.lock(local_path);
+                co_await lock_file_async(hfile.get(), true);
                 if (!require_fetch_fn()) {
-                    unlock_file_fn(hfile);
+                    // Fetched by someone else in the meantime
+                    key_guard.downgrade();
+                    unlock_file(hfile.get());
+                    co_await lock_file_async(hfile.get(), false);
                     continue;
                 }
-                deferred([&] { unlock_file_fn(hfile); });
+                fetched = true;
                 // Fetch & store resource
-                uint64_t res_max_age;
+                // NOTE: An existing entry with validators is revalidated instead of refetched
+                auto prev_record = lookup_record(local_path);
+                if (prev_record && !is_record_body_intact_fn(*prev_record)) { prev_record = std::nullopt; }
+                uint64_t res_max_age, res_stale_ttl;
+                winrt::hstring res_etag, res_last_modified;
+                bool not_modified = false;
                 {
-                    util::debug::log_trace(std::format(L"HttpCache: Fetching resource `{}`...", uri));
+                    util::debug::log_trace(L"HttpCache: Fetching resource `{}`...", uri);
                     auto http_req = HttpRequestMessage();
                     http_req.Method(HttpMethod::Get());
                     http_req.RequestUri(uri);
+                    if (prev_record) {
+                        auto http_req_hdr = http_req.Headers();
+                        if (!prev_record->etag.empty()) {
+                            http_req_hdr.TryAppendWithoutValidation(L"If-None-Match", prev_record->etag);
+                        }
+                        if (!prev_record->last_modified.empty()) {
+                            http_req_hdr.TryAppendWithoutValidation(L"If-Modified-Since", prev_record->last_modified);
+                        }
+                    }
                     auto http_resp = co_await m_http_client.SendRequestAsync(
                         http_req, HttpCompletionOption::ResponseHeadersRead
                     );
-                    http_resp.EnsureSuccessStatusCode();
-                    auto http_resp_hdr = http_resp.Headers();
-                    auto http_resp_cache_control_hdr = http_resp_hdr.CacheControl();
-                    auto nullable_max_age = http_resp_cache_control_hdr.MaxAge();
-                    if (nullable_max_age) {
-                        res_max_age = static_cast<uint64_t>(std::chrono::floor<std::chrono::seconds>(
-                            nullable_max_age.Value()).count());
+                    not_modified = prev_record && http_resp.StatusCode() == HttpStatusCode::NotModified;
+                    if (!not_modified) {
+                        http_resp.EnsureSuccessStatusCode();
                     }
-                    else {
-                        res_max_age = 0;
+                    auto http_resp_hdr = http_resp.Headers();
+                    std::tie(res_max_age, res_stale_ttl) = get_response_lifetime(http_resp);
+                    if (http_resp_hdr.HasKey(L"ETag")) {
+                        res_etag = http_resp_hdr.Lookup(L"ETag");
                     }
-                    struct Win32FileOutputStream :
-                        winrt::implements<Win32FileOutputStream, IOutputStream, IClosable>
-                    {
-                        Win32FileOutputStream(winrt::file_handle const& hfile) : m_hfile(hfile) {}
-                        void Close() {}
-                        IAsyncOperationWithProgress<uint32_t, uint32_t> WriteAsync(IBuffer const& buffer) {
-                            auto progress_token = co_await winrt::get_progress_token();
-                            // TODO: Maybe avoid blocked reading?
-                            auto data_len = buffer.Length();
-                            DWORD dwWritten;
-                            progress_token(0);
-                            WriteFile(m_hfile.get(), buffer.data(), data_len, &dwWritten, nullptr);
-                            progress_token(dwWritten);
-                            co_return dwWritten;
+                    if (auto http_cont = http_resp.Content()) {
+                        auto http_cont_hdr = http_cont.Headers();
+                        if (http_cont_hdr.HasKey(L"Last-Modified")) {
+                            res_last_modified = http_cont_hdr.Lookup(L"Last-Modified");
                         }
-                        IAsyncOperation<bool> FlushAsync() {
-                            co_return FlushFileBuffers(m_hfile.get());
+                    }
+                    if (not_modified) {
+                        util::debug::log_trace(L"HttpCache: Resource `{}` not modified", uri);
+                        // NOTE: 304 responses may omit headers; keep what we already know
+                        if (res_max_age == 0 && !http_resp_hdr.CacheControl().MaxAge()) {
+                            res_max_age = prev_record->default_age;
                         }
-                    private:
-                        winrt::file_handle const& m_hfile;
-                    };
-                    auto http_cont = http_resp.Content();
-                    auto op = http_cont.WriteToStreamAsync(winrt::make<Win32FileOutputStream>(hfile));
-                    HttpProgress http_progress{
-                        .Stage = HttpProgressStage::ReceivingContent,
-                        .BytesSent = 0,
-                        .TotalBytesToSend = nullptr,
-                        .BytesReceived = 0,
-                        .TotalBytesToReceive = http_cont.Headers().ContentLength(),
-                        .Retries = loop_cnt - 1,
-                    };
-                    progress_token(http_progress);
-                    op.Progress([&](auto const&, uint64_t progress) {
-                        http_progress.BytesReceived = progress;
-                        progress_token(http_progress);
-                    });
-                    co_await std::move(op);
-                    SetFilePointer(hfile.get(), 0, nullptr, FILE_BEGIN);
-                }
-                if (is_file_empty_fn(hfile)) {
-                    throw winrt::hresult_not_implemented(L"HttpCache does not support caching empty files");
-                }
-                // Update database
-                if (auto ov = lookup_record(local_path)) {
-                    ov->default_age = res_max_age;
-                    ov->age = override_age.value_or(res_max_age);
-                    ov->life_start_ts = cur_ts;
-                    update_record(local_path, *ov);
-                }
-                else {
-                    TableRecord rec{
-                        .default_age = res_max_age,
-                        .age = override_age.value_or(res_max_age),
-                        .life_start_ts = cur_ts,
+                        if (res_etag.empty()) { res_etag = prev_record->etag; }
+                        if (res_last_modified.empty()) { res_last_modified = prev_record->last_modified; }
+                    }
+                    bool dedup = m_dedup_bodies.load();
+                    BodyStoreArgs args{
+                        .local_path = local_path,
+                        .entry_file_path = entry_file_path,
+                        .write_path = dedup ? make_tmp_file_path(entry_file_path) : entry_file_path,
+                        .dedup = dedup,
+                        .override_age = override_age,
+                        .cur_ts = cur_ts,
+                        .http_resp = http_resp,
+                        .prev_record = prev_record,
+                        .max_age = res_max_age,
+                        .stale_ttl = res_stale_ttl,
+                        .etag = res_etag,
+                        .last_modified = res_last_modified,
                     };
-                    insert_record(local_path, rec);
+                    if (not_modified) {
+                        write_entry_record(args, prev_record->file);
+                    }
+                    else {
+                        auto content_length = http_resp.Content().Headers().ContentLength();
+                        if (!uri_as_result && content_length && content_length.Value() > 0) {
+                            // Hand out the body while it is still being downloaded
+                            auto out_file = open_body_out_file(args);
+                            auto tee_file = util::win32::overlapped_file::open(
+                                (m_cache_dir_path + args.write_path).c_str(),
+                                GENERIC_READ,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                OPEN_EXISTING
+                            );
+                            if (!tee_file) { winrt::throw_last_error(); }
+                            auto entry_lock = make_entry_file_lock(std::move(key_guard), std::move(hfile));
+                            auto tee = std::make_shared<HttpCacheTee>(
+                                std::move(tee_file), content_length.Value(), entry_lock);
+                            // SAFETY: store_body_detached_async resumes in background before doing anything
+                            store_body_detached_async(std::move(entry_lock), std::move(out_file), std::move(args), tee);
+                            co_return winrt::make<HttpCacheTeeStream>(std::move(tee));
+                        }
+                        auto out_file = open_body_out_file(args);
+                        co_await store_body_async(hfile, std::move(out_file), std::move(args), nullptr,
+                            [&](HttpProgress const& progress) { progress_token(progress); });
+                    }
                 }
+                key_guard.downgrade();
+                unlock_file(hfile.get());
+                co_await lock_file_async(hfile.get(), false);
             }
-            throw winrt::hresult_error(E_FAIL, L"Detected potential loop bug in HttpCache::fetch_async");
         }
 
         winrt::Windows::Storage::StorageFolder m_root;
@@ -685,15 +2056,44 @@ namespace BiliUWP {
         winrt::hstring m_cache_dir_path;
         winrt::Windows::Web::Http::HttpClient m_http_client;
         sqlite3* m_db;
+        Sqlite3StatementPool m_stmt_pool;
+        // NOTE: Serializes flush_pending_writes, which owns the write transaction, and
+        //       other statements modifying entries on the shared connection
+        std::mutex m_mutex_flush;
+        // Sum of entry sizes, maintained by flush_pending_writes
+        // NOTE: Guarded by m_mutex_flush; nullopt if it must be recomputed
+        std::optional<uint64_t> m_total_size;
+        std::mutex m_mutex_pending_writes;
+        std::map<winrt::hstring, std::optional<TableRecord>> m_pending_writes;
+        bool m_writer_scheduled = false;
+        util::winrt::task<> m_writer;
+        HttpCacheHotTier m_hot_tier{ HOT_TIER_CAPACITY };
+        std::mutex m_mutex_inflight;
+        std::map<winrt::hstring, std::shared_ptr<InflightFetch>> m_inflight_fetches;
+        std::set<winrt::hstring> m_revalidating;
+        std::atomic<bool> m_dedup_bodies{ false };
+        std::mutex m_mutex_orphans;
+        std::set<winrt::hstring> m_orphan_blobs;
+        HttpCacheKeyLocks m_key_locks;
+        std::atomic<uint64_t> m_capacity;
+        std::mutex m_mutex_evictor;
+        bool m_evictor_running = false;
+        util::winrt::task<> m_evictor;
+        std::atomic<size_t> m_regular_fetches{ 0 };
+        std::mutex m_mutex_prefetch;
+        // NOTE: Indexed by HttpCachePrefetchPriority
+        std::deque<PrefetchItem> m_prefetch_queues[2];
+        size_t m_prefetchers_running = 0;
     };
 
     util::winrt::task<HttpCache> HttpCache::create_async(
         winrt::Windows::Storage::StorageFolder const& root,
         winrt::hstring const& name,
-        winrt::Windows::Web::Http::Filters::IHttpFilter const& http_filter
+        winrt::Windows::Web::Http::Filters::IHttpFilter const& http_filter,
+        uint64_t capacity
     ) {
         HttpCache result(nullptr);
-        result.m_impl = std::make_shared<details::HttpCacheImpl>(root, name, http_filter);
+        result.m_impl = std::make_shared<details::HttpCacheImpl>(root, name, http_filter, capacity);
         co_await result.m_impl->init_async();
         co_return result;
     }
@@ -754,6 +2154,12 @@ namespace BiliUWP {
         op.Progress([&](auto&&, auto&& progress) { progress_token(progress); });
         co_return co_await std::move(op);
     }
+    IAsyncAction HttpCache::prefetch_async(
+        std::span<winrt::Windows::Foundation::Uri const> uris,
+        HttpCachePrefetchPriority priority
+    ) const {
+        return m_impl->prefetch_async({ uris.begin(), uris.end() }, priority);
+    }
     util::winrt::task<> HttpCache::remove_expired_async(void) const {
         auto strong_this = m_impl;
         co_return co_await strong_this->remove_expired_async();
@@ -762,4 +2168,20 @@ namespace BiliUWP {
         auto strong_this = m_impl;
         co_return co_await strong_this->clear_async();
     }
+    uint64_t HttpCache::capacity(void) const {
+        return m_impl->m_capacity.load();
+    }
+    void HttpCache::capacity(uint64_t value) const {
+        m_impl->m_capacity.store(value);
+        m_impl->kick_evictor();
+    }
+    bool HttpCache::dedup_bodies(void) const {
+        return m_impl->m_dedup_bodies.load();
+    }
+    void HttpCache::dedup_bodies(bool value) const {
+        m_impl->m_dedup_bodies.store(value);
+    }
+    HttpCacheStats HttpCache::stats(void) const {
+        return m_impl->m_hot_tier.stats();
+    }
 }
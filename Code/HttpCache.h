@@ -1,21 +1,35 @@
 #pragma once
 
 #include "util.hpp"
+#include <span>
 
 // TODO: HttpCache
 
 namespace BiliUWP {
     namespace details { struct HttpCacheImpl; }
+    struct HttpCacheStats {
+        uint64_t hot_hits;
+        uint64_t hot_misses;
+        uint64_t hot_evictions;
+        uint64_t coalesced_fetches;     // Requests which joined an already running fetch
+        uint64_t hot_size;              // Bytes currently held by the memory tier
+    };
+    enum class HttpCachePrefetchPriority {
+        Low,        // Resources which may be needed later
+        Normal,     // Resources which will be needed soon
+    };
     struct HttpCache {
         HttpCache(std::nullptr_t) : m_impl(nullptr) {}
         ~HttpCache() {}
         static util::winrt::task<HttpCache> create_async(
             winrt::Windows::Storage::StorageFolder const& root,
             winrt::hstring const& name,
-            winrt::Windows::Web::Http::Filters::IHttpFilter const& http_filter
+            winrt::Windows::Web::Http::Filters::IHttpFilter const& http_filter,
+            uint64_t capacity   // In bytes; least recently used entries are evicted beyond that
         );
         // NOTE: The default age of cache is obtained from Cache-Control in HTTP response.
-        //       If not present, `Cache-Control: no-cache` will be assumed
+        //       If not present, a lifetime is guessed from Last-Modified, or
+        //       `Cache-Control: no-cache` will be assumed
         // NOTE: Only received bytes are used in HttpProgress
         winrt::Windows::Foundation::IAsyncOperationWithProgress<
             winrt::Windows::Storage::Streams::IRandomAccessStream,
@@ -59,8 +73,25 @@ namespace BiliUWP {
             winrt::Windows::Foundation::Uri const& uri,
             uint64_t override_age   // In seconds
         ) const;
+        // Fetches resources into the cache in background, so that later fetches are
+        // served locally
+        // NOTE: Only a few prefetches run at a time, and none are started while
+        //       regular fetches are running
+        // NOTE: Cancelling drops resources which are still queued; the returned
+        //       operation completes once all resources have been handled
+        winrt::Windows::Foundation::IAsyncAction prefetch_async(
+            std::span<winrt::Windows::Foundation::Uri const> uris,
+            HttpCachePrefetchPriority priority
+        ) const;
         util::winrt::task<> remove_expired_async(void) const;
         util::winrt::task<> clear_async(void) const;
+        uint64_t capacity(void) const;
+        void capacity(uint64_t value) const;
+        // If enabled, identical bodies fetched from now on are stored only once
+        bool dedup_bodies(void) const;
+        void dedup_bodies(bool value) const;
+        // NOTE: Recently used small resources are also kept in memory
+        HttpCacheStats stats(void) const;
 
         operator bool() const { return static_cast<bool>(m_impl); }
         bool operator==(std::nullptr_t) const { return m_impl == nullptr; }
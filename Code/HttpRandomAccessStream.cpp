@@ -3,11 +3,55 @@
 #include "HttpRandomAccessStream.g.cpp"
 #include "NewUriRequestedEventArgs.g.cpp"
 #include "util.hpp"
+#include "MediaCache.h"
 #include <numeric>
 #include <deque>
+#include <random>
 
 constexpr uint64_t DEFAULT_METRICS_EVENTS_COUNT = 16384;
+// NOTE: Only used until the throughput has been measured
 constexpr uint64_t DEFAULT_HTTP_CHUNK_SIZE = 262144;
+// Http requests are sized from measured throughput to take about this long
+constexpr auto HTTP_CHUNK_TARGET_DURATION = std::chrono::milliseconds(500);
+constexpr uint64_t HTTP_CHUNK_ALIGNMENT = 65536;
+// Seeks favor latency, while sequential reads favor fewer round trips
+constexpr uint64_t SEEK_HTTP_CHUNK_SIZE_MIN = 65536;
+constexpr uint64_t SEEK_HTTP_CHUNK_SIZE_MAX = 1048576;
+constexpr uint64_t SEQUENTIAL_HTTP_CHUNK_SIZE_MIN = 262144;
+constexpr uint64_t SEQUENTIAL_HTTP_CHUNK_SIZE_MAX = 16777216;
+constexpr uint64_t THROUGHPUT_MIN_SAMPLE_SIZE = 65536;
+constexpr double THROUGHPUT_EWMA_ALPHA = 0.3;
+constexpr uint64_t DEFAULT_SEGMENT_SIZE = 1048576;
+// NOTE: Sized buffers always keep at least this many segments, even if
+//       cache_capacity is smaller than that
+constexpr size_t MIN_SEGMENTS_COUNT = 4;
+// Segments within [playhead - BEHIND, playhead + AHEAD] get a second chance in eviction
+constexpr uint64_t SEGMENT_PLAYHEAD_WINDOW_BEHIND = 2;
+constexpr uint64_t SEGMENT_PLAYHEAD_WINDOW_AHEAD = 8;
+// Large reads are split into chunks of this size and spread across uris
+constexpr uint64_t PARALLEL_CHUNK_SIZE = 262144;
+constexpr size_t MAX_PARALLEL_CONNECTIONS = 4;
+constexpr double HOST_SCORE_EWMA_ALPHA = 0.3;
+// Throughput samples from smaller responses are too noisy to be useful
+constexpr uint64_t HOST_SCORE_MIN_SAMPLE_SIZE = 65536;
+// Hosts slower than this fraction of the fastest host are quarantined
+constexpr double SLOW_HOST_THRESHOLD_RATIO = 0.25;
+constexpr double HOST_ERROR_RATE_THRESHOLD = 0.5;
+constexpr auto HOST_QUARANTINE_DURATION = std::chrono::seconds(30);
+// Automatic prefetch window may grow up to this multiple of the configured size
+constexpr uint64_t PREFETCH_WINDOW_MAX_FACTOR = 16;
+constexpr double PREFETCH_WINDOW_GROW_RATIO = 2.0;
+constexpr double PREFETCH_WINDOW_SHRINK_RATIO = 1.2;
+constexpr double PREFETCH_RATE_EWMA_ALPHA = 0.3;
+// Retry delays grow exponentially from RetryPolicy.RetryDelay up to this value
+constexpr auto MAX_RETRY_BACKOFF = std::chrono::seconds(10);
+constexpr uint32_t MAX_RETRY_BACKOFF_SHIFT = 16;
+// How often request watchdogs check for timeouts, relative to TimeoutValue
+constexpr uint32_t WATCHDOG_CHECKS_PER_TIMEOUT = 4;
+constexpr auto MIN_WATCHDOG_INTERVAL = std::chrono::milliseconds(50);
+constexpr auto MAX_WATCHDOG_INTERVAL = std::chrono::seconds(1);
+// Data is moved between the persistent cache and the network in pieces of at most this size
+constexpr uint64_t PERSISTENT_CACHE_IO_CHUNK_SIZE = 4194304;
 
 using namespace winrt;
 using namespace Windows::Foundation;
@@ -15,120 +59,386 @@ using namespace Windows::Web::Http;
 using namespace Windows::Storage::Streams;
 
 namespace winrt::BiliUWP::implementation {
-    // No caching
-    struct HttpRandomAccessStreamImpl_Direct : HttpRandomAccessStreamImpl {
-        HttpRandomAccessStreamImpl_Direct(
+    namespace details {
+        // Bookkeeping for a fixed pool of equal-sized segments mapped onto a resource
+        // NOTE: Segment storage and synchronization are managed by the caller
+        struct HrasSegmentPool {
+            static constexpr size_t npos = std::numeric_limits<size_t>::max();
+            enum class SlotState : uint8_t {
+                Empty, Fetching, Ready,
+            };
+            struct Slot {
+                uint64_t seg_idx;
+                SlotState state;
+                bool referenced;
+                uint32_t pin_count;
+            };
+
+            HrasSegmentPool(uint64_t segments_count, size_t slots_count) :
+                m_slots(slots_count, Slot{ npos, SlotState::Empty, false, 0 }),
+                m_seg_to_slot(static_cast<size_t>(segments_count), npos),
+                m_free_slots(), m_clock_hand(0)
+            {
+                m_free_slots.reserve(slots_count);
+                for (size_t i = slots_count; i > 0; i--) {
+                    m_free_slots.push_back(i - 1);
+                }
+            }
+            size_t slots_count(void) const { return m_slots.size(); }
+            Slot& slot(size_t slot_idx) { return m_slots[slot_idx]; }
+            Slot const& slot(size_t slot_idx) const { return m_slots[slot_idx]; }
+            size_t find(uint64_t seg_idx) const { return m_seg_to_slot[static_cast<size_t>(seg_idx)]; }
+            // Assigns a slot in Fetching state to the segment, evicting an old segment if required.
+            // Returns npos if all slots are currently in use.
+            size_t acquire(uint64_t seg_idx, uint64_t playhead_seg_idx, uint64_t* evicted_seg_idx = nullptr) {
+                size_t victim = npos;
+                if (!m_free_slots.empty()) {
+                    victim = m_free_slots.back();
+                    m_free_slots.pop_back();
+                }
+                else {
+                    victim = pick_victim(playhead_seg_idx);
+                    if (victim == npos) { return npos; }
+                    m_seg_to_slot[static_cast<size_t>(m_slots[victim].seg_idx)] = npos;
+                    if (evicted_seg_idx) { *evicted_seg_idx = m_slots[victim].seg_idx; }
+                }
+                auto& s = m_slots[victim];
+                s.seg_idx = seg_idx;
+                s.state = SlotState::Fetching;
+                s.referenced = true;
+                s.pin_count = 0;
+                m_seg_to_slot[static_cast<size_t>(seg_idx)] = victim;
+                return victim;
+            }
+            void mark_ready(size_t slot_idx) {
+                m_slots[slot_idx].state = SlotState::Ready;
+            }
+            // Drops the segment held by the slot (used when fetching failed)
+            void release(size_t slot_idx) {
+                auto& s = m_slots[slot_idx];
+                if (s.seg_idx != npos) {
+                    m_seg_to_slot[static_cast<size_t>(s.seg_idx)] = npos;
+                }
+                s = Slot{ npos, SlotState::Empty, false, 0 };
+                m_free_slots.push_back(slot_idx);
+            }
+
+        private:
+            static bool is_near_playhead(uint64_t seg_idx, uint64_t playhead_seg_idx) {
+                if (seg_idx >= playhead_seg_idx) {
+                    return seg_idx - playhead_seg_idx <= SEGMENT_PLAYHEAD_WINDOW_AHEAD;
+                }
+                return playhead_seg_idx - seg_idx <= SEGMENT_PLAYHEAD_WINDOW_BEHIND;
+            }
+            // NOTE: Segments behind the playhead are less likely to be read again
+            static uint64_t eviction_distance(uint64_t seg_idx, uint64_t playhead_seg_idx) {
+                if (seg_idx >= playhead_seg_idx) { return seg_idx - playhead_seg_idx; }
+                return (playhead_seg_idx - seg_idx) * 4;
+            }
+            // CLOCK sweep; segments near the playhead survive the first round
+            size_t pick_victim(uint64_t playhead_seg_idx) {
+                const auto n = m_slots.size();
+                for (size_t i = 0; i < n * 2; i++) {
+                    auto idx = m_clock_hand;
+                    m_clock_hand = (m_clock_hand + 1) % n;
+                    auto& s = m_slots[idx];
+                    if (s.state != SlotState::Ready || s.pin_count > 0) { continue; }
+                    if (s.referenced) {
+                        s.referenced = false;
+                        continue;
+                    }
+                    if (i < n && is_near_playhead(s.seg_idx, playhead_seg_idx)) { continue; }
+                    return idx;
+                }
+                // Every candidate is close to the playhead; evict the farthest one
+                size_t victim = npos;
+                uint64_t victim_dist = 0;
+                for (size_t idx = 0; idx < n; idx++) {
+                    auto& s = m_slots[idx];
+                    if (s.state != SlotState::Ready || s.pin_count > 0) { continue; }
+                    auto dist = eviction_distance(s.seg_idx, playhead_seg_idx);
+                    if (victim == npos || dist > victim_dist) {
+                        victim = idx;
+                        victim_dist = dist;
+                    }
+                }
+                return victim;
+            }
+
+            std::vector<Slot> m_slots;
+            std::vector<size_t> m_seg_to_slot;
+            std::vector<size_t> m_free_slots;
+            size_t m_clock_hand;
+        };
+
+        // Decides the range to be kept filled ahead of the playhead
+        // NOTE: Pure logic without any clock access, so that it can be driven by a simulated clock
+        struct HrasPrefetchWindowPolicy {
+            using clock = std::chrono::steady_clock;
+
+            void configure(uint64_t base_window, uint64_t max_window) {
+                m_base_window = base_window;
+                m_max_window = std::max(base_window, max_window);
+                m_window = std::clamp(m_window, m_base_window, m_max_window);
+            }
+            uint64_t base_window(void) const { return m_base_window; }
+            uint64_t window_size(void) const { return m_window; }
+            uint64_t last_read_end(void) const { return m_last_end; }
+            // Returns whether the read is discontinuous with previous reads (i.e. a seek)
+            // NOTE: The first read also counts as a seek
+            bool on_read(uint64_t start, uint64_t end, clock::time_point now) {
+                bool is_seek = !m_has_reads ||
+                    start < m_last_start || start > m_last_end + std::max(m_window, m_base_window);
+                if (is_seek) {
+                    m_window = m_base_window;
+                    m_consume_bytes_per_sec = 0;
+                    m_last_end = end;
+                }
+                else if (end > m_last_end) {
+                    auto secs = std::chrono::duration<double>(now - m_last_ts).count();
+                    if (secs > 0) {
+                        update_ewma(m_consume_bytes_per_sec, (end - m_last_end) / secs);
+                    }
+                    m_last_end = end;
+                    adapt();
+                }
+                m_last_start = start;
+                m_last_ts = now;
+                m_has_reads = true;
+                return is_seek;
+            }
+            void on_transfer(uint64_t bytes, clock::duration duration) {
+                auto secs = std::chrono::duration<double>(duration).count();
+                if (secs <= 0) { return; }
+                update_ewma(m_link_bytes_per_sec, bytes / secs);
+                adapt();
+            }
+            // Returns [start, end) of the window, or an empty range if nothing should be prefetched
+            std::pair<uint64_t, uint64_t> window(uint64_t size) const {
+                if (!m_has_reads || m_window == 0) { return { 0, 0 }; }
+                auto start = std::min(m_last_end, size);
+                return { start, start + std::min(m_window, size - start) };
+            }
+
+        private:
+            static void update_ewma(double& value, double sample) {
+                value = value == 0 ? sample :
+                    PREFETCH_RATE_EWMA_ALPHA * sample + (1 - PREFETCH_RATE_EWMA_ALPHA) * value;
+            }
+            // Grow the window when the link is much faster than playback, shrink it otherwise
+            void adapt(void) {
+                if (m_base_window == 0) { return; }
+                if (m_link_bytes_per_sec <= 0 || m_consume_bytes_per_sec <= 0) { return; }
+                if (m_link_bytes_per_sec > m_consume_bytes_per_sec * PREFETCH_WINDOW_GROW_RATIO) {
+                    m_window = std::min(m_window * 2, m_max_window);
+                }
+                else if (m_link_bytes_per_sec < m_consume_bytes_per_sec * PREFETCH_WINDOW_SHRINK_RATIO) {
+                    m_window = std::max(m_window / 2, m_base_window);
+                }
+            }
+
+            uint64_t m_base_window = 0;
+            uint64_t m_max_window = 0;
+            uint64_t m_window = 0;
+            bool m_has_reads = false;
+            uint64_t m_last_start = 0;
+            uint64_t m_last_end = 0;
+            clock::time_point m_last_ts{};
+            double m_consume_bytes_per_sec = 0;
+            double m_link_bytes_per_sec = 0;
+        };
+
+        // Sizes http requests so that each one takes roughly HTTP_CHUNK_TARGET_DURATION
+        // NOTE: Pure logic without any clock access, so that it can be driven by a simulated clock
+        struct HrasChunkSizePolicy {
+            void on_throughput_sample(uint64_t bytes, std::chrono::duration<double> duration) {
+                auto secs = duration.count();
+                if (secs <= 0) { return; }
+                auto sample = bytes / secs;
+                m_bytes_per_sec = m_bytes_per_sec == 0 ? sample :
+                    THROUGHPUT_EWMA_ALPHA * sample + (1 - THROUGHPUT_EWMA_ALPHA) * m_bytes_per_sec;
+            }
+            double bytes_per_sec(void) const { return m_bytes_per_sec; }
+            uint64_t chunk_size(bool is_seek) const {
+                auto min_size = is_seek ? SEEK_HTTP_CHUNK_SIZE_MIN : SEQUENTIAL_HTTP_CHUNK_SIZE_MIN;
+                auto max_size = is_seek ? SEEK_HTTP_CHUNK_SIZE_MAX : SEQUENTIAL_HTTP_CHUNK_SIZE_MAX;
+                if (m_bytes_per_sec <= 0) {
+                    return std::clamp(DEFAULT_HTTP_CHUNK_SIZE, min_size, max_size);
+                }
+                auto target_secs = std::chrono::duration<double>(HTTP_CHUNK_TARGET_DURATION).count();
+                auto size = m_bytes_per_sec * target_secs;
+                if (size >= static_cast<double>(max_size)) { return max_size; }
+                auto aligned_size = static_cast<uint64_t>(size) / HTTP_CHUNK_ALIGNMENT * HTTP_CHUNK_ALIGNMENT;
+                return std::clamp(aligned_size, min_size, max_size);
+            }
+
+        private:
+            double m_bytes_per_sec = 0;
+        };
+
+        // Exponential backoff with jitter; failures_count starts from 1
+        // NOTE: jitter is in [0, 1); half of the delay is randomized so that
+        //       concurrent requests don't retry all at once
+        inline TimeSpan calc_retry_backoff(TimeSpan base_delay, uint32_t failures_count, double jitter) {
+            if (base_delay <= TimeSpan::zero() || failures_count == 0) { return TimeSpan::zero(); }
+            auto shift = std::min(failures_count - 1, MAX_RETRY_BACKOFF_SHIFT);
+            auto max_delay = std::max(base_delay, std::chrono::duration_cast<TimeSpan>(MAX_RETRY_BACKOFF));
+            auto delay = base_delay.count() > (max_delay.count() >> shift) ?
+                max_delay : base_delay * (int64_t{ 1 } << shift);
+            return delay / 2 + std::chrono::duration_cast<TimeSpan>(delay / 2 * jitter);
+        }
+
+        // Per-host statistics, smoothed with EWMA
+        struct HrasHostScore {
+            bool has_samples = false;
+            double bytes_per_sec = 0;
+            double ttfb_ms = 0;
+            double error_rate = 0;
+            uint32_t active_requests = 0;
+            std::chrono::steady_clock::time_point quarantined_until{};
+
+            bool is_quarantined(std::chrono::steady_clock::time_point now) const {
+                return now < quarantined_until;
+            }
+            // Higher is better
+            double rank(void) const {
+                if (!has_samples) {
+                    // Probe unmeasured hosts, but only one request at a time
+                    return active_requests == 0 ? std::numeric_limits<double>::infinity() : 0;
+                }
+                return bytes_per_sec * (1 - error_rate) / (1 + active_requests);
+            }
+        };
+    }
+
+    // Shared plumbing (uris, metrics, fetching) for impls backed by http uris
+    struct HttpRandomAccessStreamImpl_HttpBase : HttpRandomAccessStreamImpl {
+        HttpRandomAccessStreamImpl_HttpBase(
             Uri http_uri,
             HttpClient http_client,
-            uint64_t size,
-            bool extra_integrity_check
+            uint64_t size
         ) : m_http_uris{ std::move(http_uri) }, m_http_client(std::move(http_client)), m_size(size),
-            m_extra_integrity_check(extra_integrity_check), m_enable_metrics_collection(false),
-            m_metrics()
-        {
-            if (extra_integrity_check) {
-                throw hresult_not_implemented(
-                    L"HttpRandomAccessStreamImpl_Direct: extra_integrity_check not implemented"
-                );
-            }
-        }
+            m_enable_metrics_collection(false), m_metrics(),
+            m_retry_policy{
+                .Conditions = static_cast<HttpRandomAccessStreamRetryCondition>(
+                    std::to_underlying(HttpRandomAccessStreamRetryCondition::RetryOnTimeout) |
+                    std::to_underlying(HttpRandomAccessStreamRetryCondition::RetryOnFetchFailure)),
+                .OnRetrySuccessOperation = HttpRandomAccessStreamOnRetrySuccessOperation::ClearFailureCounter,
+                .MaxRetryCount = 3,
+                .RetryDelay = std::chrono::milliseconds(100),
+                .TimeoutPolicy = {
+                    .Conditions = HttpRandomAccessStreamTimeoutCondition::TimeoutOnInactivity,
+                    .TimeoutValue = std::chrono::seconds(15),
+                },
+            } {}
         void SupplyNewUri(array_view<Uri const> new_uris) {
-            // TODO: Introduce uri ranking
             std::unique_lock guard(m_mutex_http_uris);
             for (auto& i : new_uris) {
                 m_http_uris.push_back(i);
             }
         }
+        // NOTE: Uris are ordered by rank, best first
         com_array<Uri> GetActiveUris() {
             std::shared_lock guard(m_mutex_http_uris);
-            return { m_http_uris.begin(), m_http_uris.end() };
+            std::vector<Uri> uris{ m_http_uris.begin(), m_http_uris.end() };
+            auto now = std::chrono::steady_clock::now();
+            auto score_of_fn = [&](Uri const& uri) {
+                auto it = m_host_scores.find(uri.Host());
+                return it != m_host_scores.end() ? it->second : details::HrasHostScore{};
+            };
+            std::stable_sort(uris.begin(), uris.end(), [&](Uri const& a, Uri const& b) {
+                auto sa = score_of_fn(a), sb = score_of_fn(b);
+                auto qa = sa.is_quarantined(now), qb = sb.is_quarantined(now);
+                if (qa != qb) { return qb; }
+                return sa.rank() > sb.rank();
+            });
+            return { uris.begin(), uris.end() };
+        }
+        com_array<HttpRandomAccessStreamUriScore> GetUriScores() {
+            std::shared_lock guard(m_mutex_http_uris);
+            std::vector<HttpRandomAccessStreamUriScore> result;
+            auto now = std::chrono::steady_clock::now();
+            for (auto const& uri : m_http_uris) {
+                auto it = m_host_scores.find(uri.Host());
+                auto score = it != m_host_scores.end() ? it->second : details::HrasHostScore{};
+                result.push_back({
+                    .Uri = uri.ToString(),
+                    .InboundBitsPerSecond = static_cast<uint64_t>(std::llround(score.bytes_per_sec * 8)),
+                    .TimeToFirstByte = std::chrono::duration_cast<TimeSpan>(
+                        std::chrono::duration<double, std::milli>(score.ttfb_ms)),
+                    .ErrorRate = score.error_rate,
+                    .ActiveRequestsCount = score.active_requests,
+                    .IsQuarantined = score.is_quarantined(now),
+                });
+            }
+            return { result.begin(), result.end() };
         }
         event_token NewUriRequested(EventHandlerType_NUR const& handler) {
             return m_ev_new_uri_requested.add(handler);
         }
         void NewUriRequested(event_token const& token) noexcept { m_ev_new_uri_requested.remove(token); }
-        IAsyncOperationWithProgress<IBuffer, uint32_t> ReadAtAsync(
-            IBuffer buffer,
-            uint64_t start, uint64_t end,
-            InputStreamOptions options
-        ) {
-            auto cancellation_token = co_await get_cancellation_token();
-            cancellation_token.enable_propagation();
-            auto progress_token = co_await get_progress_token();
-
-            util::debug::log_trace(std::format(L"Fetching http range {}-{}", start, end));
-
-            while (true) {
-                // Check whether we have uris
-                Uri cur_uri = nullptr;
-                {
-                    std::shared_lock guard_uri(m_mutex_http_uris);
-                    if (!m_http_uris.empty()) {
-                        cur_uri = m_http_uris.front();
-                    }
-                }
-                if (cur_uri == nullptr) {
-                    // No uris, try to get some
-                    co_await trigger_new_uri_requested();
-                    // If we cannot get more uris, mark as failed
-                    std::shared_lock guard_uri(m_mutex_http_uris);
-                    if (m_http_uris.empty()) {
-                        throw hresult_error(E_FAIL, L"No uris available after NewUriRequested fired");
-                    }
-                    cur_uri = m_http_uris.front();
-                }
-                // Try to fetch content
-                try {
-                    {
-                        std::scoped_lock guard_metrics(m_mutex_metrics);
-                        if (m_enable_metrics_collection.load()) {
-                            m_metrics.requests_delta++;
-                        }
-                        if (m_metrics.active_connections++ == 0) {
-                            m_metrics.last_start_ts = std::chrono::high_resolution_clock::now();
-                        }
-                    }
-                    deferred([&] {
-                        std::scoped_lock guard_metrics(m_mutex_metrics);
-                        if (--m_metrics.active_connections == 0) {
-                            if (m_enable_metrics_collection.load()) {
-                                m_metrics.connection_duration +=
-                                    std::chrono::high_resolution_clock::now() - m_metrics.last_start_ts;
-                            }
-                        }
-                    });
-                    auto http_content = co_await util::winrt::fetch_partial_http_content(
-                        cur_uri, m_http_client, start, end - start);
-                    auto op = http_content.WriteToStreamAsync(
-                        make<util::winrt::BufferBackedRandomAccessStream>(buffer));
-                    uint64_t op_req_bytes = 0;
-                    op.Progress([&](auto const&, auto progress) {
-                        progress_token(static_cast<uint32_t>(progress));
-                        if (m_enable_metrics_collection.load()) {
-                            std::scoped_lock guard_metrics(m_mutex_metrics);
-                            m_metrics.bytes_delta += progress - op_req_bytes;
-                        }
-                        op_req_bytes = progress;
-                    });
-                    co_await std::move(op);
-                    co_return buffer;
-                }
-                catch (hresult_canceled const&) { throw; }
-                catch (hresult_error const& e) {
-                    util::debug::log_debug(std::format(
-                        L"HRAS: Failed to fetch `{}` with range {}-{} (0x{:08x}: {})",
-                        cur_uri.ToString(), start, end,
-                        static_cast<uint32_t>(e.code()), e.message()
-                    ));
-                    // Fetch failed, drop current uri
-                    std::unique_lock guard_uri(m_mutex_http_uris);
-                    if (!m_http_uris.empty() && cur_uri == m_http_uris.front()) {
-                        m_http_uris.pop_front();
-                    }
+        uint64_t Size() { return m_size; }
+        void Prefetch(uint64_t start, uint64_t length, HttpRandomAccessStreamPrefetchPriority priority) {
+            if (start >= m_size || length == 0) { return; }
+            auto end = start + std::min(length, m_size - start);
+            {
+                std::scoped_lock guard(m_mutex_prefetch);
+                // Keep requests ordered by priority, FIFO within the same priority
+                auto it = std::find_if(m_prefetch_requests.begin(), m_prefetch_requests.end(),
+                    [&](PrefetchRequest const& e) { return e.priority < priority; });
+                m_prefetch_requests.insert(it, { start, end, priority });
+            }
+            kick_prefetch_worker();
+        }
+        uint64_t PrefetchWindowSize() {
+            std::scoped_lock guard(m_mutex_prefetch);
+            return m_prefetch_policy.base_window();
+        }
+        void PrefetchWindowSize(uint64_t value) {
+            {
+                std::scoped_lock guard(m_mutex_prefetch);
+                auto max_window = value > std::numeric_limits<uint64_t>::max() / PREFETCH_WINDOW_MAX_FACTOR ?
+                    std::numeric_limits<uint64_t>::max() : value * PREFETCH_WINDOW_MAX_FACTOR;
+                max_window = std::max(value, std::min(max_window, max_prefetch_window()));
+                m_prefetch_policy.configure(value, max_window);
+            }
+            kick_prefetch_worker();
+        }
+        void shutdown() {
+            util::winrt::task<bool> cur_op = nullptr;
+            {
+                std::scoped_lock guard(m_mutex_prefetch);
+                m_prefetch_stopped = true;
+                m_prefetch_requests.clear();
+                cur_op = m_prefetch_cur_op;
+            }
+            // NOTE: Fetches joined by the prefetch are cancelled as well, unless readers
+            //       are still waiting for them
+            if (cur_op) { cur_op.cancel(); }
+        }
+        HttpRandomAccessStreamRetryPolicy RetryPolicy() {
+            std::scoped_lock guard(m_mutex_retry_policy);
+            return m_retry_policy;
+        }
+        void RetryPolicy(HttpRandomAccessStreamRetryPolicy const& value) {
+            if (value.RetryDelay < TimeSpan::zero() || value.TimeoutPolicy.TimeoutValue < TimeSpan::zero()) {
+                throw hresult_invalid_argument(L"Negative durations are not allowed in RetryPolicy");
+            }
+            std::scoped_lock guard(m_mutex_retry_policy);
+            m_retry_policy = value;
+        }
+        void EnablePersistentCache(hstring const& key) {
+            ::BiliUWP::MediaCache cache = nullptr;
+            if (!key.empty()) {
+                cache = ::BiliUWP::get_media_cache();
+                if (!cache) {
+                    util::debug::log_warn(L"HttpRandomAccessStream: Persistent cache is not available");
                 }
             }
+            std::scoped_lock guard(m_mutex_persistent_cache);
+            m_persistent_cache = std::move(cache);
+            m_persistent_cache_key = key;
         }
-        uint64_t Size() { return m_size; }
         void EnableMetricsCollection(bool enable, uint64_t max_events_count) {
             if (m_enable_metrics_collection.exchange(enable) == enable) {
                 return;
@@ -152,6 +462,12 @@ namespace winrt::BiliUWP::implementation {
             if (!m_enable_metrics_collection.load()) {
                 throw hresult_error(E_FAIL, L"Metrics collection is not enabled");
             }
+            auto [allocated_buf_size, used_buf_size] = get_buffer_usage();
+            uint64_t unused_prefetched_size;
+            {
+                std::scoped_lock guard_prefetch(m_mutex_prefetch);
+                unused_prefetched_size = m_prefetched_unused_ranges.total_length();
+            }
             std::scoped_lock guard(m_mutex_metrics);
             auto actual_duration = m_metrics.connection_duration;
             if (m_metrics.active_connections > 0) {
@@ -164,22 +480,478 @@ namespace winrt::BiliUWP::implementation {
                 .SentRequestsDelta = m_metrics.requests_delta,
                 .InboundBitsPerSecond = static_cast<uint64_t>(std::llround(inbound_bytes_per_sec * 8)),
                 .DownloadedBytesDelta = m_metrics.bytes_delta,
-                .AllocatedBufferSize = 0,
-                .UsedBufferSize = 0,
+                .AllocatedBufferSize = allocated_buf_size,
+                .UsedBufferSize = used_buf_size,
+                .CoalescedRequestsDelta = m_metrics.coalesced_requests_delta,
+                .UnusedPrefetchedBytes = unused_prefetched_size,
+                .CopiedBytesDelta = m_metrics.copied_bytes_delta,
+                .PersistentCacheBytesDelta = m_metrics.persistent_cache_bytes_delta,
             };
             if (clear_events) {
                 m_metrics.last_start_ts = std::chrono::high_resolution_clock::now();
                 m_metrics.connection_duration = {};
                 m_metrics.requests_delta = 0;
                 m_metrics.bytes_delta = 0;
+                m_metrics.coalesced_requests_delta = 0;
+                m_metrics.copied_bytes_delta = 0;
+                m_metrics.persistent_cache_bytes_delta = 0;
             }
             return result;
         }
 
     private:
+        enum class FetchOutcome {
+            Aborted, Succeeded, Failed,
+        };
+        struct PrefetchRequest {
+            uint64_t start, end;
+            HttpRandomAccessStreamPrefetchPriority priority;
+        };
+        // Cancels the current operation of a request once the request times out
+        struct RequestWatchdog {
+            RequestWatchdog(HttpRandomAccessStreamTimeoutPolicy policy) : m_policy(std::move(policy)),
+                m_start_ts(std::chrono::steady_clock::now()), m_last_activity_ts(m_start_ts) {}
+            bool is_enabled(void) const {
+                return m_policy.Conditions != HttpRandomAccessStreamTimeoutCondition::None &&
+                    m_policy.TimeoutValue > TimeSpan::zero();
+            }
+            void watch(IAsyncInfo const& op) {
+                {
+                    std::scoped_lock guard(m_mutex);
+                    if (!m_timed_out) {
+                        m_cur_op = op;
+                        return;
+                    }
+                }
+                op.Cancel();
+            }
+            void touch(void) {
+                std::scoped_lock guard(m_mutex);
+                m_last_activity_ts = std::chrono::steady_clock::now();
+            }
+            void finish(void) {
+                std::scoped_lock guard(m_mutex);
+                m_done = true;
+                m_cur_op = nullptr;
+            }
+            bool timed_out(void) {
+                std::scoped_lock guard(m_mutex);
+                return m_timed_out;
+            }
+            // NOTE: Keeps running until finish() is called or the request times out
+            static IAsyncAction run(std::shared_ptr<RequestWatchdog> self) {
+                auto timeout = self->m_policy.TimeoutValue;
+                auto interval = std::clamp(
+                    std::chrono::duration_cast<std::chrono::milliseconds>(timeout / WATCHDOG_CHECKS_PER_TIMEOUT),
+                    std::chrono::milliseconds(MIN_WATCHDOG_INTERVAL),
+                    std::chrono::milliseconds(MAX_WATCHDOG_INTERVAL)
+                );
+                auto has_condition_fn = [&](HttpRandomAccessStreamTimeoutCondition cond) {
+                    return (std::to_underlying(self->m_policy.Conditions) & std::to_underlying(cond)) != 0;
+                };
+                while (true) {
+                    co_await interval;
+                    IAsyncInfo op{ nullptr };
+                    {
+                        std::scoped_lock guard(self->m_mutex);
+                        if (self->m_done) { co_return; }
+                        auto now = std::chrono::steady_clock::now();
+                        bool expired =
+                            (has_condition_fn(HttpRandomAccessStreamTimeoutCondition::TimeoutOnInactivity) &&
+                                now - self->m_last_activity_ts >= timeout) ||
+                            (has_condition_fn(HttpRandomAccessStreamTimeoutCondition::TimeoutOnExpiry) &&
+                                now - self->m_start_ts >= timeout);
+                        if (!expired) { continue; }
+                        self->m_timed_out = true;
+                        op = std::move(self->m_cur_op);
+                    }
+                    // NOTE: Cancel outside the lock, as completion handlers may run synchronously
+                    if (op) { op.Cancel(); }
+                    co_return;
+                }
+            }
+
+        private:
+            const HttpRandomAccessStreamTimeoutPolicy m_policy;
+            std::mutex m_mutex;
+            IAsyncInfo m_cur_op{ nullptr };
+            std::chrono::steady_clock::time_point m_start_ts, m_last_activity_ts;
+            bool m_done = false;
+            bool m_timed_out = false;
+        };
+        struct ParallelFetchState {
+            ParallelFetchState(uint64_t start, uint64_t end) :
+                next_pos(start), end(end), done_bytes(0), failed(false) {}
+            std::atomic<uint64_t> next_pos;
+            const uint64_t end;
+            std::atomic<uint64_t> done_bytes;
+            std::atomic_bool failed;
+            // Called with done_bytes whenever some data has landed
+            std::function<void(uint64_t)> on_progress;
+            // NOTE: Only accessed by join_parallel_fetch_workers, and by the owner after joining
+            std::exception_ptr error;
+        };
+
+        size_t available_uris_count(void) {
+            std::shared_lock guard(m_mutex_http_uris);
+            auto now = std::chrono::steady_clock::now();
+            return static_cast<size_t>(std::count_if(m_http_uris.begin(), m_http_uris.end(),
+                [&](Uri const& uri) {
+                    auto it = m_host_scores.find(uri.Host());
+                    return it == m_host_scores.end() || !it->second.is_quarantined(now);
+                }
+            ));
+        }
+        // Picks the best ranked uri and counts a new request on it; quarantined
+        // uris are only used when there is nothing else
+        Uri acquire_best_uri(void) {
+            std::unique_lock guard(m_mutex_http_uris);
+            auto now = std::chrono::steady_clock::now();
+            Uri best_uri = nullptr;
+            details::HrasHostScore* best_score = nullptr;
+            for (auto const& uri : m_http_uris) {
+                auto& score = m_host_scores[uri.Host()];
+                if (best_score) {
+                    auto q = score.is_quarantined(now), best_q = best_score->is_quarantined(now);
+                    if (q && !best_q) { continue; }
+                    if (q == best_q && !(score.rank() > best_score->rank())) { continue; }
+                }
+                best_uri = uri;
+                best_score = &score;
+            }
+            if (best_score) { best_score->active_requests++; }
+            return best_uri;
+        }
+        // Counts a failed request against uri, and drops uri once the retry policy no
+        // longer allows retrying it; returns whether uri has been dropped
+        bool record_uri_failure(Uri const& uri, bool is_timeout, HttpRandomAccessStreamRetryPolicy const& policy) {
+            auto condition = is_timeout ?
+                HttpRandomAccessStreamRetryCondition::RetryOnTimeout :
+                HttpRandomAccessStreamRetryCondition::RetryOnFetchFailure;
+            bool can_retry = (std::to_underlying(policy.Conditions) & std::to_underlying(condition)) != 0;
+            std::unique_lock guard(m_mutex_http_uris);
+            auto key = uri.AbsoluteUri();
+            auto failures_count = ++m_uri_failure_counts[key];
+            if (can_retry && failures_count <= policy.MaxRetryCount) { return false; }
+            m_uri_failure_counts.erase(key);
+            auto it = std::find(m_http_uris.begin(), m_http_uris.end(), uri);
+            if (it != m_http_uris.end()) {
+                m_http_uris.erase(it);
+            }
+            return true;
+        }
+        void record_uri_success(Uri const& uri, HttpRandomAccessStreamRetryPolicy const& policy) {
+            if (policy.OnRetrySuccessOperation != HttpRandomAccessStreamOnRetrySuccessOperation::ClearFailureCounter) {
+                return;
+            }
+            std::unique_lock guard(m_mutex_http_uris);
+            m_uri_failure_counts.erase(uri.AbsoluteUri());
+        }
+        void release_uri(
+            Uri const& uri, FetchOutcome outcome,
+            std::chrono::steady_clock::duration ttfb,
+            std::chrono::steady_clock::duration transfer_duration,
+            uint64_t transferred_bytes
+        ) {
+            auto ewma_fn = [](double& value, double sample) {
+                value = HOST_SCORE_EWMA_ALPHA * sample + (1 - HOST_SCORE_EWMA_ALPHA) * value;
+            };
+            std::unique_lock guard(m_mutex_http_uris);
+            auto host = uri.Host();
+            auto& score = m_host_scores[host];
+            score.active_requests--;
+            if (outcome == FetchOutcome::Aborted) { return; }
+            ewma_fn(score.error_rate, outcome == FetchOutcome::Failed ? 1 : 0);
+            if (outcome == FetchOutcome::Succeeded) {
+                auto ttfb_ms = std::chrono::duration<double, std::milli>(ttfb).count();
+                auto transfer_secs = std::chrono::duration<double>(transfer_duration).count();
+                if (!score.has_samples) { score.ttfb_ms = ttfb_ms; }
+                else { ewma_fn(score.ttfb_ms, ttfb_ms); }
+                if (transferred_bytes >= HOST_SCORE_MIN_SAMPLE_SIZE && transfer_secs > 0) {
+                    auto bytes_per_sec = transferred_bytes / transfer_secs;
+                    if (!score.has_samples) { score.bytes_per_sec = bytes_per_sec; }
+                    else { ewma_fn(score.bytes_per_sec, bytes_per_sec); }
+                    score.has_samples = true;
+                }
+            }
+            // Quarantine hosts which are failing or much slower than the others, as
+            // long as there are other hosts left to use
+            auto now = std::chrono::steady_clock::now();
+            double best_bytes_per_sec = 0;
+            bool has_alternatives = false;
+            for (auto const& i : m_http_uris) {
+                auto other_host = i.Host();
+                if (other_host == host) { continue; }
+                auto const& other_score = m_host_scores[other_host];
+                if (other_score.is_quarantined(now)) { continue; }
+                has_alternatives = true;
+                if (other_score.has_samples) {
+                    best_bytes_per_sec = std::max(best_bytes_per_sec, other_score.bytes_per_sec);
+                }
+            }
+            if (!has_alternatives || score.is_quarantined(now)) { return; }
+            bool is_failing = score.error_rate > HOST_ERROR_RATE_THRESHOLD;
+            bool is_slow = score.has_samples &&
+                score.bytes_per_sec < best_bytes_per_sec * SLOW_HOST_THRESHOLD_RATIO;
+            if (is_failing || is_slow) {
+                score.quarantined_until = now + HOST_QUARANTINE_DURATION;
+                util::debug::log_debug(
+                    L"HRAS: Quarantining host `{}` (speed: {:.0f} B/s, ttfb: {:.0f} ms, error rate: {:.2f})",
+                    host, score.bytes_per_sec, score.ttfb_ms, score.error_rate
+                );
+            }
+        }
+        IAsyncAction parallel_fetch_worker(
+            std::shared_ptr<ParallelFetchState> state,
+            IRandomAccessStream stream, uint64_t stream_base
+        ) {
+            auto strong_this = shared_from_this();
+            auto cancellation_token = co_await get_cancellation_token();
+            cancellation_token.enable_propagation();
+            while (!state->failed.load()) {
+                auto chunk_start = state->next_pos.fetch_add(PARALLEL_CHUNK_SIZE);
+                if (chunk_start >= state->end) { break; }
+                auto chunk_end = std::min(chunk_start + PARALLEL_CHUNK_SIZE, state->end);
+                uint64_t chunk_done = 0;
+                auto add_progress_fn = [&](uint64_t progress) {
+                    if (progress <= chunk_done) { return; }
+                    auto done_bytes = state->done_bytes += progress - chunk_done;
+                    chunk_done = progress;
+                    state->on_progress(done_bytes);
+                };
+                auto op = fetch_http_range(chunk_start, chunk_end, stream, stream_base);
+                op.Progress([&](auto const&, auto progress) { add_progress_fn(progress); });
+                co_await std::move(op);
+                add_progress_fn(chunk_end - chunk_start);
+            }
+        }
+        // Awaits the operation returned by spawn_fn, which is only called once suspended
+        struct spawn_and_join_awaiter {
+            std::function<IAsyncAction()> spawn_fn;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) {
+                spawn_fn().Completed([handle](auto&&, auto&&) { handle(); });
+            }
+            void await_resume() const noexcept {}
+        };
+        // Waits for all workers to stop; the first failure is stored and stops the other workers
+        static IAsyncAction join_parallel_fetch_workers(
+            std::shared_ptr<ParallelFetchState> state,
+            std::vector<IAsyncAction> workers
+        ) {
+            for (auto& worker : workers) {
+                try { co_await worker; }
+                catch (...) {
+                    if (!state->error) { state->error = std::current_exception(); }
+                    state->failed.store(true);
+                    for (auto& i : workers) { i.Cancel(); }
+                }
+            }
+        }
+
+        void kick_prefetch_worker(void) {
+            std::scoped_lock guard(m_mutex_prefetch);
+            if (m_prefetch_worker_running || m_prefetch_stopped) { return; }
+            m_prefetch_worker_running = true;
+            // SAFETY: prefetch_worker resumes in background before taking the lock
+            m_prefetch_worker = prefetch_worker();
+        }
+        // NOTE: The worker exits when there is nothing left to prefetch, and gets
+        //       restarted by new reads or requests
+        util::winrt::task<> prefetch_worker(void) {
+            auto strong_this = shared_from_this();
+            co_await resume_background();
+            while (true) {
+                std::optional<PrefetchRequest> request;
+                std::pair<uint64_t, uint64_t> window{};
+                {
+                    std::scoped_lock guard(m_mutex_prefetch);
+                    if (m_prefetch_stopped) {
+                        m_prefetch_worker_running = false;
+                        co_return;
+                    }
+                    if (!m_prefetch_requests.empty()) {
+                        request = m_prefetch_requests.front();
+                        m_prefetch_requests.pop_front();
+                    }
+                    else {
+                        window = m_prefetch_policy.window(m_size);
+                    }
+                }
+                auto target = request ?
+                    first_missing_range(request->start, request->end) :
+                    first_missing_range(window.first, window.second);
+                if (!target) {
+                    if (request) { continue; }
+                    std::scoped_lock guard(m_mutex_prefetch);
+                    if (!m_prefetch_requests.empty()) { continue; }
+                    m_prefetch_worker_running = false;
+                    co_return;
+                }
+                auto [start, end] = *target;
+                // NOTE: Chunks are sized by duration, so that stale prefetches can be cancelled early
+                end = std::min(end, start + http_chunk_size(false));
+                auto op = prefetch_range(start, end);
+                bool is_stopped;
+                {
+                    std::scoped_lock guard(m_mutex_prefetch);
+                    is_stopped = m_prefetch_stopped;
+                    if (request && end < request->end && !is_stopped) {
+                        // Serve the rest of the request later, with the same priority
+                        m_prefetch_requests.push_front({ end, request->end, request->priority });
+                    }
+                    m_prefetch_cur_op = op;
+                    m_prefetch_cur_op_is_window = !request;
+                }
+                // NOTE: shutdown() ran before the op was published, so cancel it here
+                if (is_stopped) { op.cancel(); }
+                auto start_ts = std::chrono::steady_clock::now();
+                bool succeeded = false, cancelled = false;
+                try {
+                    succeeded = co_await op;
+                }
+                catch (hresult_canceled const&) { cancelled = true; }
+                catch (concurrency::task_canceled const&) { cancelled = true; }
+                catch (...) { util::winrt::log_current_exception(); }
+                if (cancelled) {
+                    util::debug::log_trace(L"HRAS: Cancelled stale prefetch {}-{}", start, end);
+                }
+                std::scoped_lock guard(m_mutex_prefetch);
+                m_prefetch_cur_op = nullptr;
+                if (!succeeded && !cancelled) {
+                    // Failed, or impl cannot make progress now (e.g. buffer is full); retry on next read
+                    m_prefetch_worker_running = false;
+                    co_return;
+                }
+                if (succeeded) {
+                    m_prefetch_policy.on_transfer(end - start, std::chrono::steady_clock::now() - start_ts);
+                    // NOTE: Data before the last read position has been consumed already
+                    start = std::clamp(m_prefetch_policy.last_read_end(), start, end);
+                    m_prefetched_unused_ranges.insert(start, end);
+                }
+            }
+        }
+
+    protected:
+        // Returns (allocated, used) buffer sizes in bytes
+        virtual std::pair<uint64_t, uint64_t> get_buffer_usage(void) { return { 0, 0 }; }
+        // Prefetch hooks; impls without buffers simply ignore prefetching
+        virtual uint64_t max_prefetch_window(void) { return std::numeric_limits<uint64_t>::max(); }
+        // Returns the first part of [start, end) which is neither buffered nor being fetched
+        virtual std::optional<std::pair<uint64_t, uint64_t>> first_missing_range(uint64_t start, uint64_t end) {
+            return std::nullopt;
+        }
+        // Returns false if no data could be fetched at the moment
+        virtual util::winrt::task<bool> prefetch_range(uint64_t start, uint64_t end) { co_return false; }
+        // A fetch shared by all the reads and prefetches which need its data
+        struct SharedFetch {
+            util::winrt::task<> op;
+            // NOTE: Signaled by the fetch itself once it has fully completed, including cleanups
+            util::winrt::awaitable_event done;
+            std::exception_ptr error;
+            // NOTE: Only incremented under the lock guarding the table which owns the fetch
+            std::atomic<uint32_t> waiters_count{ 0 };
+        };
+        // Waits for a shared fetch which the caller has been counted as a waiter of, or until
+        // the caller gets cancelled, whichever comes first. The fetch itself is cancelled only
+        // when its last waiter leaves. Returns normally if the fetch was cancelled by others,
+        // so that the caller can look up the data again.
+        // NOTE: The caller should disable cancellation propagation while awaiting this
+        template<typename CancellationToken>
+        static util::winrt::task<> wait_shared_fetch(
+            std::shared_ptr<SharedFetch> fetch, CancellationToken cancellation_token
+        ) {
+            auto wake_event = std::make_shared<util::winrt::awaitable_event>();
+            auto is_cancelled = std::make_shared<std::atomic_bool>(false);
+            [](std::shared_ptr<SharedFetch> fetch,
+                std::shared_ptr<util::winrt::awaitable_event> wake_event
+            ) -> util::winrt::fire_forget_except {
+                co_await fetch->done;
+                wake_event->set();
+            }(fetch, wake_event);
+            cancellation_token.callback([wake_event, is_cancelled] {
+                is_cancelled->store(true);
+                wake_event->set();
+            });
+            co_await *wake_event;
+            if (is_cancelled->load()) {
+                if (--fetch->waiters_count == 0) { fetch->op.cancel(); }
+                throw hresult_canceled();
+            }
+            fetch->waiters_count--;
+            if (!fetch->error) { co_return; }
+            try { std::rethrow_exception(fetch->error); }
+            catch (hresult_canceled const&) {}
+        }
+        // Should be called by buffered impls on every read, to drive automatic prefetching
+        // Returns whether the read is a seek
+        bool notify_read(uint64_t start, uint64_t end) {
+            util::winrt::task<bool> stale_op = nullptr;
+            bool is_seek, should_prefetch;
+            {
+                std::scoped_lock guard(m_mutex_prefetch);
+                m_prefetched_unused_ranges.erase(start, end);
+                is_seek = m_prefetch_policy.on_read(start, end, std::chrono::steady_clock::now());
+                if (is_seek) {
+                    // Seeked away; prefetching the old window is pointless now
+                    if (m_prefetch_cur_op_is_window) { stale_op = m_prefetch_cur_op; }
+                }
+                // NOTE: With automatic prefetching disabled, only explicit requests are served
+                should_prefetch = m_prefetch_policy.base_window() > 0 || !m_prefetch_requests.empty();
+            }
+            // NOTE: Fetches joined by the stale op are cancelled as well, unless readers
+            //       are still waiting for them
+            if (stale_op) { stale_op.cancel(); }
+            if (should_prefetch) { kick_prefetch_worker(); }
+            return is_seek;
+        }
+        // Returns the preferred size of a single http fetch, based on recent throughput
+        uint64_t http_chunk_size(bool is_seek) {
+            std::scoped_lock guard_metrics(m_mutex_metrics);
+            // NOTE: Throughput is measured the same way as InboundBitsPerSecond in GetMetrics,
+            //       but regardless of whether metrics collection is enabled
+            auto& rate = m_metrics.rate_sample;
+            if (m_metrics.active_connections > 0) {
+                auto now = std::chrono::high_resolution_clock::now();
+                rate.duration += now - rate.last_start_ts;
+                rate.last_start_ts = now;
+            }
+            if (rate.bytes >= THROUGHPUT_MIN_SAMPLE_SIZE) {
+                m_chunk_size_policy.on_throughput_sample(rate.bytes, rate.duration);
+                rate.bytes = 0;
+                rate.duration = {};
+            }
+            return m_chunk_size_policy.chunk_size(is_seek);
+        }
+        // Should be called when buffered data is dropped
+        void notify_evicted(uint64_t start, uint64_t end) {
+            std::scoped_lock guard(m_mutex_prefetch);
+            m_prefetched_unused_ranges.erase(start, end);
+        }
+        // Called when a read joins a fetch started by another read instead of sending a new request
+        void record_coalesced_request(void) {
+            if (!m_enable_metrics_collection.load()) { return; }
+            std::scoped_lock guard_metrics(m_mutex_metrics);
+            m_metrics.coalesced_requests_delta++;
+        }
+        // Called when buffered data is copied into the caller's buffer
+        void record_copied_bytes(uint64_t count) {
+            if (!m_enable_metrics_collection.load()) { return; }
+            std::scoped_lock guard_metrics(m_mutex_metrics);
+            m_metrics.copied_bytes_delta += count;
+        }
+        // Called when data is served from the persistent cache instead of network
+        void record_persistent_cache_bytes(uint64_t count) {
+            if (!m_enable_metrics_collection.load()) { return; }
+            std::scoped_lock guard_metrics(m_mutex_metrics);
+            m_metrics.persistent_cache_bytes_delta += count;
+        }
+
         IAsyncAction trigger_new_uri_requested(void) {
             com_ptr<NewUriRequestedEventArgs> ea_nur = nullptr;
             bool owns_ea = false;
+            auto correlation_id = static_cast<uint32_t>(util::num::gen_global_seqid());
             {
                 std::scoped_lock guard(m_mutex_ea_nur);
                 ea_nur = m_ea_nur;
@@ -195,18 +967,329 @@ namespace winrt::BiliUWP::implementation {
                 }
             });
             if (owns_ea) {
+                util::debug::log_trace(L"Triggering event NewUriRequested (CorrelationId: {:08x})", correlation_id);
                 m_ev_new_uri_requested(make<HttpRandomAccessStream>(shared_from_this(), L""), *ea_nur);
             }
-            co_return co_await ea_nur->wait_for_deferrals();
+            // WARN: winrt::deferrable_event_args::wait_for_deferrals() does not support
+            //       multiple awaiters, don't use it
+            co_await ea_nur->wait_for_deferrals();
+            if (owns_ea) {
+                util::debug::log_trace(L"Finished event NewUriRequested (CorrelationId: {:08x})", correlation_id);
+            }
+        }
+        // NOTE: This method only writes the specified range of the resource into stream,
+        //       where data at position pos goes to pos - stream_base.
+        //       Buffer ranges should be managed outside the method.
+        // NOTE: Failed requests are retried according to RetryPolicy; data received before
+        //       a failure is kept, and only the rest is requested again.
+        IAsyncActionWithProgress<uint64_t> fetch_http_range(
+            uint64_t start, uint64_t end,
+            IRandomAccessStream stream, uint64_t stream_base
+        ) {
+            auto cancellation_token = co_await get_cancellation_token();
+            cancellation_token.enable_propagation();
+            auto progress_token = co_await get_progress_token();
+
+            if (end > m_size) {
+                throw hresult_invalid_argument(L"Invalid read operation (out-of-bounds read)");
+            }
+            if (start > end) {
+                throw hresult_invalid_argument(L"Invalid read operation (negative-sized read)");
+            }
+            if (start == end) { co_return; }
+
+            auto correlation_id = static_cast<uint32_t>(util::num::gen_global_seqid());
+            util::debug::log_trace(L"Fetching http range {}-{} (CorrelationId: {:08x})", start, end, correlation_id);
+
+            uint64_t cur_start = start;
+            // Consecutive failures within this fetch, used for backoff
+            uint32_t failures_count = 0;
+            TimeSpan retry_delay{};
+            while (true) {
+                // NOTE: Delayed here instead of at the end of the previous attempt, so that
+                //       the failed request has released its uri before sleeping
+                if (retry_delay > TimeSpan::zero()) {
+                    co_await retry_delay;
+                }
+                // Check whether we have uris
+                Uri cur_uri = acquire_best_uri();
+                if (cur_uri == nullptr) {
+                    // No uris, try to get some
+                    co_await trigger_new_uri_requested();
+                    // If we cannot get more uris, mark as failed
+                    cur_uri = acquire_best_uri();
+                    if (cur_uri == nullptr) {
+                        throw hresult_error(E_FAIL, L"No uris available after NewUriRequested fired");
+                    }
+                }
+                auto policy = RetryPolicy();
+                auto watchdog = std::make_shared<RequestWatchdog>(policy.TimeoutPolicy);
+                if (watchdog->is_enabled()) {
+                    RequestWatchdog::run(watchdog);
+                }
+                deferred([&] { watchdog->finish(); });
+                // Try to fetch content
+                auto outcome = FetchOutcome::Aborted;
+                bool is_transient_failure = false;
+                auto req_start_ts = std::chrono::steady_clock::now();
+                std::chrono::steady_clock::duration ttfb{};
+                uint64_t op_req_bytes = 0;
+                deferred([&] {
+                    release_uri(cur_uri, outcome, ttfb,
+                        std::chrono::steady_clock::now() - req_start_ts - ttfb, op_req_bytes);
+                });
+                try {
+                    {
+                        std::scoped_lock guard_metrics(m_mutex_metrics);
+                        if (m_enable_metrics_collection.load()) {
+                            m_metrics.requests_delta++;
+                        }
+                        if (m_metrics.active_connections++ == 0) {
+                            m_metrics.last_start_ts = std::chrono::high_resolution_clock::now();
+                            m_metrics.rate_sample.last_start_ts = m_metrics.last_start_ts;
+                        }
+                    }
+                    deferred([&] {
+                        std::scoped_lock guard_metrics(m_mutex_metrics);
+                        if (--m_metrics.active_connections == 0) {
+                            auto now = std::chrono::high_resolution_clock::now();
+                            if (m_enable_metrics_collection.load()) {
+                                m_metrics.connection_duration += now - m_metrics.last_start_ts;
+                            }
+                            m_metrics.rate_sample.duration += now - m_metrics.rate_sample.last_start_ts;
+                        }
+                    });
+                    // TODO: Known issue: HttpClient does not support concurrent requests
+                    auto req_op = util::winrt::fetch_partial_http_content(
+                        cur_uri, m_http_client, cur_start, end - cur_start);
+                    req_op.Progress([&](auto const&, auto const&) { watchdog->touch(); });
+                    watchdog->watch(req_op);
+                    auto http_content = co_await std::move(req_op);
+                    ttfb = std::chrono::steady_clock::now() - req_start_ts;
+                    watchdog->touch();
+                    auto op = http_content.WriteToStreamAsync(stream.GetOutputStreamAt(cur_start - stream_base));
+                    op.Progress([&](auto const&, auto progress) {
+                        watchdog->touch();
+                        progress_token(cur_start - start + progress);
+                        {
+                            std::scoped_lock guard_metrics(m_mutex_metrics);
+                            if (m_enable_metrics_collection.load()) {
+                                m_metrics.bytes_delta += progress - op_req_bytes;
+                            }
+                            m_metrics.rate_sample.bytes += progress - op_req_bytes;
+                        }
+                        op_req_bytes = progress;
+                    });
+                    watchdog->watch(op);
+                    op_req_bytes = co_await std::move(op);
+                    if (op_req_bytes != end - cur_start) {
+                        throw hresult_error(E_FAIL, std::format(
+                            L"Incomplete response ({} of {} bytes)", op_req_bytes, end - cur_start));
+                    }
+                    outcome = FetchOutcome::Succeeded;
+                    record_uri_success(cur_uri, policy);
+                    util::debug::log_trace(L"Done fetching http range {}-{} (CorrelationId: {:08x})", start, end, correlation_id);
+                    co_return;
+                }
+                catch (hresult_canceled const&) {
+                    // NOTE: Only cancellations from the watchdog are handled here
+                    if (!watchdog->timed_out()) { throw; }
+                }
+                catch (hresult_error const& e) {
+                    util::debug::log_debug(
+                        L"HRAS: Failed to fetch `{}` with range {}-{} (0x{:08x}: {}) (CorrelationId: {:08x})",
+                        util::debug::lazy_arg([&] { return cur_uri.ToString(); }), cur_start, end,
+                        static_cast<uint32_t>(e.code()), util::debug::lazy_arg([&] { return e.message(); }),
+                        correlation_id
+                    );
+                    if (!watchdog->timed_out()) {
+                        if (e.code() == E_CHANGED_STATE) {
+                            // Workaround HttpClient concurrency issue by ignoring E_CHANGED_STATE
+                            util::debug::log_debug(L"HRAS: Ignoring E_CHANGED_STATE exception");
+                            is_transient_failure = true;
+                        }
+                        if (e.code() == E_ABORT || e.code() == E_HANDLE) {
+                            // HttpClient is reallocating resources; don't treat this as an error
+                            util::debug::log_debug(L"HRAS: Ignoring E_ABORT / E_HANDLE exception");
+                            is_transient_failure = true;
+                        }
+                    }
+                }
+
+                // Keep what has been received, and resume from there
+                // NOTE: Progress is reported only after data has been written to stream
+                if (op_req_bytes > 0 && op_req_bytes < end - cur_start) {
+                    util::debug::log_debug(
+                        L"HRAS: Resuming http range {}-{} from {} (CorrelationId: {:08x})",
+                        start, end, cur_start + op_req_bytes, correlation_id
+                    );
+                    cur_start += op_req_bytes;
+                    failures_count = 0;
+                }
+                failures_count++;
+                thread_local std::minstd_rand jitter_rng{ std::random_device{}() };
+                auto jitter = std::uniform_real_distribution<double>(0, 1)(jitter_rng);
+                retry_delay = details::calc_retry_backoff(policy.RetryDelay, failures_count, jitter);
+                if (is_transient_failure) { continue; }
+                outcome = FetchOutcome::Failed;
+                bool is_timeout = watchdog->timed_out();
+                if (is_timeout) {
+                    util::debug::log_debug(
+                        L"HRAS: Request to `{}` timed out (CorrelationId: {:08x})",
+                        util::debug::lazy_arg([&] { return cur_uri.ToString(); }), correlation_id
+                    );
+                }
+                if (record_uri_failure(cur_uri, is_timeout, policy)) {
+                    util::debug::log_debug(
+                        L"HRAS: Dropped uri `{}` as retry policy does not allow retrying it (CorrelationId: {:08x})",
+                        util::debug::lazy_arg([&] { return cur_uri.ToString(); }), correlation_id
+                    );
+                }
+            }
+        }
+        // NOTE: Same as fetch_http_range, except that large ranges are split into chunks
+        //       and fetched from multiple uris at once. Chunks are pulled by workers on
+        //       demand, so faster hosts naturally serve more of them.
+        //       Data at position pos is written to stream at pos - stream_base.
+        IAsyncActionWithProgress<uint64_t> fetch_http_range_parallel(
+            uint64_t start, uint64_t end,
+            IRandomAccessStream stream, uint64_t stream_base
+        ) {
+            auto cancellation_token = co_await get_cancellation_token();
+            cancellation_token.enable_propagation();
+            auto progress_token = co_await get_progress_token();
+
+            if (end > m_size) {
+                throw hresult_invalid_argument(L"Invalid read operation (out-of-bounds read)");
+            }
+            if (start > end) {
+                throw hresult_invalid_argument(L"Invalid read operation (negative-sized read)");
+            }
+
+            auto chunks_count = (end - start + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE;
+            auto workers_count = static_cast<size_t>(std::min<uint64_t>(
+                { available_uris_count(), MAX_PARALLEL_CONNECTIONS, chunks_count }));
+            if (workers_count <= 1) {
+                auto op = fetch_http_range(start, end, stream, stream_base);
+                op.Progress([&](auto const&, auto progress) { progress_token(progress); });
+                co_await std::move(op);
+                co_return;
+            }
+
+            auto state = std::make_shared<ParallelFetchState>(start, end);
+            // SAFETY: Workers are always joined before returning
+            state->on_progress = [&](uint64_t done_bytes) { progress_token(done_bytes); };
+            // NOTE: Workers write into the caller's stream, so all of them must have stopped
+            //       before returning, even on failure or cancellation. Cancellation is thus
+            //       forwarded to the workers instead of aborting the wait. As co_await throws
+            //       without waiting once we are cancelled, workers are only spawned after
+            //       the wait has begun, so that the join can never be skipped.
+            cancellation_token.enable_propagation(false);
+            auto is_cancelled = std::make_shared<std::atomic_bool>(false);
+            co_await spawn_and_join_awaiter{ [&] {
+                std::vector<IAsyncAction> workers;
+                for (size_t i = 0; i < workers_count; i++) {
+                    workers.push_back(parallel_fetch_worker(state, stream, stream_base));
+                }
+                cancellation_token.callback([state, workers, is_cancelled] {
+                    is_cancelled->store(true);
+                    state->failed.store(true);
+                    for (auto& worker : workers) { worker.Cancel(); }
+                });
+                return join_parallel_fetch_workers(state, std::move(workers));
+            } };
+            if (is_cancelled->load()) { throw hresult_canceled(); }
+            if (state->error) { std::rethrow_exception(state->error); }
+        }
+        // NOTE: Same as fetch_http_range_parallel, except that the persistent cache (if enabled)
+        //       is consulted first, and data fetched from network is written back to it.
+        //       Failures of the persistent cache are logged and never fail the fetch.
+        IAsyncActionWithProgress<uint64_t> fetch_range_cached(
+            uint64_t start, uint64_t end,
+            IRandomAccessStream stream, uint64_t stream_base
+        ) {
+            auto cancellation_token = co_await get_cancellation_token();
+            cancellation_token.enable_propagation();
+            auto progress_token = co_await get_progress_token();
+
+            ::BiliUWP::MediaCache cache = nullptr;
+            hstring cache_key;
+            {
+                std::scoped_lock guard(m_mutex_persistent_cache);
+                cache = m_persistent_cache;
+                cache_key = m_persistent_cache_key;
+            }
+            auto disable_cache_fn = [&] {
+                util::winrt::log_current_exception();
+                util::debug::log_warn(L"HttpRandomAccessStream: Persistent cache failed; bypassing it");
+                cache = nullptr;
+            };
+
+            auto cur_pos = start;
+            while (cur_pos < end) {
+                std::optional<std::pair<uint64_t, uint64_t>> gap;
+                if (cache) {
+                    try { gap = cache.first_missing_range(cache_key, m_size, cur_pos, end); }
+                    catch (...) { disable_cache_fn(); }
+                }
+                if (!cache) {
+                    auto done_size = cur_pos - start;
+                    auto op = fetch_http_range_parallel(cur_pos, end, stream, stream_base);
+                    op.Progress([&](auto const&, auto progress) { progress_token(done_size + progress); });
+                    co_await std::move(op);
+                    co_return;
+                }
+                if (!gap || gap->first > cur_pos) {
+                    // Serve cached data
+                    auto cached_end = gap ? gap->first : end;
+                    auto chunk_size = static_cast<uint32_t>(
+                        std::min(cached_end - cur_pos, PERSISTENT_CACHE_IO_CHUNK_SIZE));
+                    Buffer buf(chunk_size);
+                    bool is_read = false;
+                    try { is_read = cache.read(cache_key, m_size, cur_pos, buf.data(), chunk_size); }
+                    catch (...) { disable_cache_fn(); }
+                    if (!cache) { continue; }
+                    if (is_read) {
+                        buf.Length(chunk_size);
+                        co_await stream.GetOutputStreamAt(cur_pos - stream_base).WriteAsync(buf);
+                        record_persistent_cache_bytes(chunk_size);
+                        cur_pos += chunk_size;
+                        progress_token(cur_pos - start);
+                        continue;
+                    }
+                    // Evicted in the meantime; fall back to network
+                    gap = std::pair{ cur_pos, cached_end };
+                }
+                // Fetch missing data, then store it into both the persistent cache and stream
+                auto fetch_end = std::min(gap->second, cur_pos + PERSISTENT_CACHE_IO_CHUNK_SIZE);
+                auto fetch_size = static_cast<uint32_t>(fetch_end - cur_pos);
+                Buffer buf(fetch_size);
+                {
+                    auto done_size = cur_pos - start;
+                    auto op = fetch_http_range_parallel(cur_pos, fetch_end,
+                        make<util::winrt::BufferBackedRandomAccessStream>(buf), cur_pos);
+                    op.Progress([&](auto const&, auto progress) { progress_token(done_size + progress); });
+                    co_await std::move(op);
+                }
+                buf.Length(fetch_size);
+                try { cache.write(cache_key, m_size, cur_pos, buf.data(), fetch_size); }
+                catch (...) { disable_cache_fn(); }
+                co_await stream.GetOutputStreamAt(cur_pos - stream_base).WriteAsync(buf);
+                cur_pos = fetch_end;
+                progress_token(cur_pos - start);
+            }
         }
 
         std::mutex m_mutex_ea_nur;
         com_ptr<NewUriRequestedEventArgs> m_ea_nur;
         std::shared_mutex m_mutex_http_uris;
         std::deque<Uri> m_http_uris;
+        // NOTE: Also guarded by m_mutex_http_uris
+        std::map<hstring, details::HrasHostScore> m_host_scores;
+        // NOTE: Also guarded by m_mutex_http_uris; keyed by absolute uri
+        std::map<hstring, uint32_t> m_uri_failure_counts;
         HttpClient m_http_client;
         uint64_t m_size;
-        bool m_extra_integrity_check;
         event<EventHandlerType_NUR> m_ev_new_uri_requested;
         std::atomic_bool m_enable_metrics_collection;
         std::mutex m_mutex_metrics;
@@ -216,7 +1299,81 @@ namespace winrt::BiliUWP::implementation {
             std::chrono::high_resolution_clock::duration connection_duration;
             uint64_t requests_delta;
             uint64_t bytes_delta;
+            uint64_t coalesced_requests_delta;
+            uint64_t copied_bytes_delta;
+            uint64_t persistent_cache_bytes_delta;
+            struct {
+                std::chrono::high_resolution_clock::time_point last_start_ts;
+                std::chrono::high_resolution_clock::duration duration;
+                uint64_t bytes;
+            } rate_sample;
         } m_metrics;
+        // NOTE: Also guarded by m_mutex_metrics
+        details::HrasChunkSizePolicy m_chunk_size_policy;
+        std::mutex m_mutex_retry_policy;
+        HttpRandomAccessStreamRetryPolicy m_retry_policy;
+        std::mutex m_mutex_persistent_cache;
+        ::BiliUWP::MediaCache m_persistent_cache = nullptr;
+        hstring m_persistent_cache_key;
+        std::mutex m_mutex_prefetch;
+        details::HrasPrefetchWindowPolicy m_prefetch_policy;
+        std::deque<PrefetchRequest> m_prefetch_requests;
+        util::container::range_set<uint64_t> m_prefetched_unused_ranges;
+        bool m_prefetch_worker_running = false;
+        // NOTE: Set once all streams using the impl have been closed
+        bool m_prefetch_stopped = false;
+        util::winrt::task<> m_prefetch_worker;
+        util::winrt::task<bool> m_prefetch_cur_op;
+        bool m_prefetch_cur_op_is_window = false;
+    };
+
+    // No caching
+    struct HttpRandomAccessStreamImpl_Direct : HttpRandomAccessStreamImpl_HttpBase {
+        HttpRandomAccessStreamImpl_Direct(
+            Uri http_uri,
+            HttpClient http_client,
+            uint64_t size,
+            bool extra_integrity_check
+        ) : HttpRandomAccessStreamImpl_HttpBase(std::move(http_uri), std::move(http_client), size),
+            m_extra_integrity_check(extra_integrity_check)
+        {
+            if (extra_integrity_check) {
+                throw hresult_not_implemented(
+                    L"HttpRandomAccessStreamImpl_Direct: extra_integrity_check not implemented"
+                );
+            }
+        }
+        IAsyncOperationWithProgress<IBuffer, uint32_t> ReadAtAsync(
+            IBuffer buffer,
+            uint64_t start, uint64_t end,
+            InputStreamOptions options
+        ) {
+            auto cancellation_token = co_await get_cancellation_token();
+            cancellation_token.enable_propagation();
+            auto progress_token = co_await get_progress_token();
+
+            if (start > end) {
+                throw hresult_invalid_argument(L"Invalid read operation (negative-sized read)");
+            }
+            if (end > m_size) {
+                // NOTE: Silently clamp the range to be compatible with MediaPlayer out-of-range fetching
+                end = m_size;
+                if (start > end) { start = end; }
+            }
+
+            auto op = fetch_range_cached(start, end,
+                make<util::winrt::BufferBackedRandomAccessStream>(buffer), start);
+            op.Progress([&](auto const&, auto progress) {
+                progress_token(static_cast<uint32_t>(progress));
+            });
+            co_await std::move(op);
+            // NOTE: Chunks may complete out of order, so set the final length explicitly
+            buffer.Length(static_cast<uint32_t>(end - start));
+            co_return buffer;
+        }
+
+    private:
+        bool m_extra_integrity_check;
     };
 
     // Caching via provided memory stream
@@ -256,6 +1413,10 @@ namespace winrt::BiliUWP::implementation {
                 .DownloadedBytesDelta = 0,
                 .AllocatedBufferSize = size,
                 .UsedBufferSize = size,
+                .CoalescedRequestsDelta = 0,
+                .UnusedPrefetchedBytes = 0,
+                .CopiedBytesDelta = 0,
+                .PersistentCacheBytesDelta = 0,
             };
         }
 
@@ -266,55 +1427,220 @@ namespace winrt::BiliUWP::implementation {
     };
 
     // Caching via memory stream
-    struct HttpRandomAccessStreamImpl_StreamBased : HttpRandomAccessStreamImpl {
+    struct HttpRandomAccessStreamImpl_StreamBased : HttpRandomAccessStreamImpl_HttpBase {
         HttpRandomAccessStreamImpl_StreamBased(
             Uri http_uri,
             HttpClient http_client,
             uint64_t size,
             bool extra_integrity_check
-        ) : m_http_uris{ std::move(http_uri) }, m_http_client(std::move(http_client)), m_size(size),
-            m_extra_integrity_check(extra_integrity_check), m_enable_metrics_collection(false),
-            m_metrics(), m_buf_stream(InMemoryRandomAccessStream()),
-            m_unbuffered_intervals{ { 0, size } }
+        ) : HttpRandomAccessStreamImpl_HttpBase(std::move(http_uri), std::move(http_client), size),
+            m_extra_integrity_check(extra_integrity_check), m_buf_mem_stream(),
+            m_buf_stream(m_buf_mem_stream.as_random_access_stream()),
+            m_buffered_ranges(), m_pending_fetches()
+        {
+            if (extra_integrity_check) {
+                throw hresult_not_implemented(
+                    L"HttpRandomAccessStreamImpl_StreamBased: extra_integrity_check not implemented"
+                );
+            }
+
+            // NOTE: Pages are allocated lazily, so this does not commit any memory yet
+            m_buf_mem_stream.size(size);
+        }
+        IAsyncOperationWithProgress<IBuffer, uint32_t> ReadAtAsync(
+            IBuffer buffer,
+            uint64_t start, uint64_t end,
+            InputStreamOptions options
+        ) {
+            auto cancellation_token = co_await get_cancellation_token();
+            cancellation_token.enable_propagation();
+            auto progress_token = co_await get_progress_token();
+
+            /*util::debug::log_trace(std::format(L"Fetching stream range {}-{} with option {}",
+                start, end, std::to_underlying(options)));*/
+
+            if (start > end) {
+                throw hresult_invalid_argument(L"Invalid read operation (negative-sized read)");
+            }
+            if (end > m_size) {
+                // NOTE: Silently clamp the range to be compatible with MediaPlayer out-of-range fetching
+                end = m_size;
+                if (start > end) { start = end; }
+            }
+
+            // NOTE: Fetch a larger chunk than requested to save round trips; seeks
+            //       use smaller chunks so that playback can resume sooner
+            auto chunk_size = http_chunk_size(notify_read(start, end));
+
+            // Fetch or wait for only a signle part in each iteration
+            while (true) {
+                std::shared_ptr<SharedFetch> pending_fetch;
+                uint64_t progress_start_pos = 0;
+                {
+                    std::scoped_lock guard(m_mutex_ranges);
+                    auto final_end = std::clamp(start + chunk_size, end, m_size);
+                    uint64_t gap_start;
+                    std::tie(pending_fetch, gap_start) = join_or_start_fetch_nolock(start, end, final_end);
+                    progress_start_pos = gap_start - start;
+                }
+                // All data are fetched, stop iteration
+                if (!pending_fetch) { break; }
+                // NOTE: The fetch may be shared with other readers, so our cancellation
+                //       only stops the wait, and leaves the fetch to them
+                cancellation_token.enable_propagation(false);
+                deferred([&] { cancellation_token.enable_propagation(true); });
+                progress_token(static_cast<uint32_t>(progress_start_pos));
+                co_await wait_shared_fetch(std::move(pending_fetch), cancellation_token);
+            }
+
+            buffer.Length(static_cast<uint32_t>(end - start));
+            auto actual_count = m_buf_mem_stream.read_at(buffer.data(), start, buffer.Length());
+            buffer.Length(static_cast<uint32_t>(actual_count));
+            record_copied_bytes(actual_count);
+            co_return buffer;
+        }
+
+    protected:
+        std::pair<uint64_t, uint64_t> get_buffer_usage(void) {
+            uint64_t buffered_total_size;
+            {
+                std::scoped_lock guard(m_mutex_ranges);
+                buffered_total_size = m_buffered_ranges.total_length();
+            }
+            return { m_buf_mem_stream.allocated_size(), buffered_total_size };
+        }
+        std::optional<std::pair<uint64_t, uint64_t>> first_missing_range(uint64_t start, uint64_t end) {
+            std::scoped_lock guard(m_mutex_ranges);
+            for (auto [gap_start, gap_end] : m_buffered_ranges.gaps(start, end)) {
+                // Skip parts covered by pending fetches
+                auto it = m_pending_fetches.upper_bound(gap_start);
+                if (it != m_pending_fetches.begin()) {
+                    gap_start = std::max(gap_start, std::prev(it)->second.end);
+                }
+                for (; gap_start < gap_end; it++) {
+                    if (it == m_pending_fetches.end() || it->first > gap_start) {
+                        auto next_start = it == m_pending_fetches.end() ? gap_end : std::min(gap_end, it->first);
+                        return std::pair{ gap_start, next_start };
+                    }
+                    gap_start = std::max(gap_start, it->second.end);
+                }
+            }
+            return std::nullopt;
+        }
+        util::winrt::task<bool> prefetch_range(uint64_t start, uint64_t end) {
+            auto strong_this = shared_from_this();
+            auto cancellation_token = co_await get_cancellation_token();
+            co_await resume_background();
+            while (true) {
+                std::shared_ptr<SharedFetch> pending_fetch;
+                {
+                    std::scoped_lock guard(m_mutex_ranges);
+                    pending_fetch = join_or_start_fetch_nolock(start, end, end).first;
+                }
+                if (!pending_fetch) { co_return true; }
+                co_await wait_shared_fetch(std::move(pending_fetch), cancellation_token);
+            }
+        }
+
+    private:
+        struct PendingFetch {
+            uint64_t end;
+            std::shared_ptr<SharedFetch> fetch;
+        };
+
+        // Finds the first missing part of [start, end), and either joins or starts the fetch
+        // covering it; a started fetch may extend up to max_end. The caller is counted as a
+        // waiter of the returned fetch, which is null if [start, end) is fully buffered.
+        std::pair<std::shared_ptr<SharedFetch>, uint64_t> join_or_start_fetch_nolock(
+            uint64_t start, uint64_t end, uint64_t max_end
+        ) {
+            auto gap = m_buffered_ranges.first_gap(start, max_end);
+            if (!gap || gap->first >= end) { return { nullptr, end }; }
+            auto it = m_pending_fetches.upper_bound(gap->first);
+            if (it != m_pending_fetches.begin() && std::prev(it)->second.end > gap->first) {
+                // Someone is already fetching this part
+                record_coalesced_request();
+                auto& fetch = std::prev(it)->second.fetch;
+                fetch->waiters_count++;
+                return { fetch, gap->first };
+            }
+            // Only fetch up to where another pending fetch starts
+            auto target_end = gap->second;
+            if (it != m_pending_fetches.end()) {
+                target_end = std::min(target_end, it->first);
+            }
+            auto fetch = std::make_shared<SharedFetch>();
+            fetch->waiters_count++;
+            // SAFETY: fetch_range resumes in background before touching the table
+            fetch->op = fetch_range(gap->first, target_end, fetch);
+            m_pending_fetches.emplace(gap->first, PendingFetch{ target_end, fetch });
+            return { std::move(fetch), gap->first };
+        }
+
+        // NOTE: Runs detached from the initiating reader, so that other readers
+        //       waiting for the same range are not affected by cancellation;
+        //       only cancelled once all of its waiters have left
+        util::winrt::task<> fetch_range(uint64_t start, uint64_t end, std::shared_ptr<SharedFetch> fetch) {
+            auto strong_this = shared_from_this();
+            auto cancellation_token = co_await get_cancellation_token();
+            cancellation_token.enable_propagation();
+            co_await resume_background();
+            deferred([&] { fetch->done.set(); });
+            deferred([&] {
+                std::scoped_lock guard(m_mutex_ranges);
+                m_pending_fetches.erase(start);
+            });
+            try { co_await fetch_range_cached(start, end, m_buf_stream, 0); }
+            catch (...) {
+                fetch->error = std::current_exception();
+                throw;
+            }
+            std::scoped_lock guard(m_mutex_ranges);
+            m_buffered_ranges.insert(start, end);
+        }
+
+        bool m_extra_integrity_check;
+        util::winrt::InMemoryStream m_buf_mem_stream;
+        IRandomAccessStream m_buf_stream;
+        std::mutex m_mutex_ranges;
+        util::container::range_set<uint64_t> m_buffered_ranges;
+        // Fetches currently running, keyed by range start; readers needing any
+        // part of them wait for the fetch instead of sending another request
+        std::map<uint64_t, PendingFetch> m_pending_fetches;
+    };
+
+    // Caching via a bounded pool of equal-sized segments
+    struct HttpRandomAccessStreamImpl_SegmentBased : HttpRandomAccessStreamImpl_HttpBase {
+        HttpRandomAccessStreamImpl_SegmentBased(
+            Uri http_uri,
+            HttpClient http_client,
+            uint64_t size,
+            uint64_t cache_capacity,
+            bool extra_integrity_check
+        ) : HttpRandomAccessStreamImpl_HttpBase(std::move(http_uri), std::move(http_client), size),
+            m_extra_integrity_check(extra_integrity_check), m_seg_size(DEFAULT_SEGMENT_SIZE),
+            m_pool(calc_segments_count(size), calc_slots_count(size, cache_capacity)),
+            m_seg_bufs(m_pool.slots_count(), nullptr), m_seg_fetches(m_pool.slots_count()),
+            m_slot_freed_event(std::make_shared<util::winrt::awaitable_event>()),
+            m_allocated_segs_count(0), m_playhead_seg_idx(0)
         {
             if (extra_integrity_check) {
                 throw hresult_not_implemented(
-                    L"HttpRandomAccessStreamImpl_StreamBased: extra_integrity_check not implemented"
+                    L"HttpRandomAccessStreamImpl_SegmentBased: extra_integrity_check not implemented"
                 );
             }
-
-            // WARN: InMemoryRandomAccessStream does not support >4GB data
-            // TODO: Use custom stream which supports >4GB data
-            m_buf_stream = util::winrt::InMemoryStream().as_random_access_stream();
-            m_buf_stream.Size(size);
-        }
-        void SupplyNewUri(array_view<Uri const> new_uris) {
-            // TODO: Introduce uri ranking
-            std::unique_lock guard(m_mutex_http_uris);
-            for (auto& i : new_uris) {
-                m_http_uris.push_back(i);
-            }
-        }
-        com_array<Uri> GetActiveUris() {
-            std::shared_lock guard(m_mutex_http_uris);
-            return { m_http_uris.begin(), m_http_uris.end() };
-        }
-        event_token NewUriRequested(EventHandlerType_NUR const& handler) {
-            return m_ev_new_uri_requested.add(handler);
         }
-        void NewUriRequested(event_token const& token) noexcept { m_ev_new_uri_requested.remove(token); }
         IAsyncOperationWithProgress<IBuffer, uint32_t> ReadAtAsync(
             IBuffer buffer,
             uint64_t start, uint64_t end,
             InputStreamOptions options
         ) {
+            using details::HrasSegmentPool;
+
             auto cancellation_token = co_await get_cancellation_token();
             cancellation_token.enable_propagation();
             auto progress_token = co_await get_progress_token();
 
-            /*util::debug::log_trace(std::format(L"Fetching stream range {}-{} with option {}",
-                start, end, std::to_underlying(options)));*/
-
             if (start > end) {
                 throw hresult_invalid_argument(L"Invalid read operation (negative-sized read)");
             }
@@ -324,321 +1650,302 @@ namespace winrt::BiliUWP::implementation {
                 if (start > end) { start = end; }
             }
 
-            // NOTE: Never invoke multithreaded downloading, unless explicitly allowed (currently not considered)
+            buffer.Length(static_cast<uint32_t>(end - start));
+            auto buf_ptr = buffer.data();
+            if (start < end) {
+                m_playhead_seg_idx.store(start / m_seg_size);
+            }
+            notify_read(start, end);
 
-            // Fetch only a signle part in each iteration
-            while (true) {
-                std::optional<std::pair<uint64_t, uint64_t>> target_interval = std::nullopt;
-                auto get_its_pair_nolock_fn = [this](uint64_t start, uint64_t end) {
-                    auto itb = std::upper_bound(
-                        m_unbuffered_intervals.begin(), m_unbuffered_intervals.end(),
-                        start,
-                        [](uint64_t const& a, std::pair<uint64_t, uint64_t> const& b) { return a < b.second; }
-                    );
-                    auto ite = std::lower_bound(
-                        m_unbuffered_intervals.begin(), m_unbuffered_intervals.end(),
-                        end,
-                        [](std::pair<uint64_t, uint64_t> const& a, uint64_t const& b) { return a.first < b; }
-                    );
-                    return std::pair(itb, ite);
-                };
-                {   // Calculate and set interval to be fetched, if there's one
-                    std::shared_lock guard(m_mutex_unbuffered_intervals);
-                    auto [itb, ite] = get_its_pair_nolock_fn(start, end);
-                    if (itb < ite) {
-                        // Found intersecting intervals
-                        // NOTE: Temporary fix for slow downloading by fetching a larger chunk
-                        // TODO: Use a better way to optimize http fetching
-                        // TODO: Add a prefetch API for optimal video fetching
-                        //       (requires waiting on pending requests, etc.)
-                        auto final_start = start;
-                        auto final_end = std::clamp(start + DEFAULT_HTTP_CHUNK_SIZE, end, m_size);
-                        std::tie(itb, ite) = get_its_pair_nolock_fn(final_start, final_end);
-                        ite--;
-                        if (itb == ite) {
-                            target_interval = {
-                                std::max(final_start, itb->first), std::min(final_end, ite->second) };
-                        }
-                        else {
-                            target_interval = { std::max(final_start, itb->first), itb->second };
-                        }
+            uint64_t cur_pos = start;
+            while (cur_pos < end) {
+                auto seg_idx = cur_pos / m_seg_size;
+                auto seg_start = seg_idx * m_seg_size;
+                auto copy_end = std::min(seg_start + m_seg_size, end);
+                size_t slot_idx;
+                while (true) {
+                    std::shared_ptr<SharedFetch> pending_fetch;
+                    std::shared_ptr<util::winrt::awaitable_event> slot_freed_event;
+                    slot_idx = try_pin_segment(seg_idx, pending_fetch, slot_freed_event);
+                    if (slot_idx != HrasSegmentPool::npos) { break; }
+                    if (!pending_fetch) {
+                        // All segments are in use; wait for some of them to be released
+                        co_await *slot_freed_event;
+                        continue;
                     }
+                    // NOTE: The fetch may be shared with other readers, so our cancellation
+                    //       only stops the wait, and leaves the fetch to them
+                    cancellation_token.enable_propagation(false);
+                    deferred([&] { cancellation_token.enable_propagation(true); });
+                    // Segment may have been evicted afterwards, so look it up again
+                    co_await wait_shared_fetch(std::move(pending_fetch), cancellation_token);
                 }
-                // All data are fetched, stop iteration
-                if (!target_interval) { break; }
-                // Try to fill buffer
-                try {
-                    auto op = populate_buf_stream(target_interval->first, target_interval->second);
-                    auto progress_start_pos = target_interval->first - start;
-                    op.Progress([&](auto const&, auto progress) {
-                        progress_token(static_cast<uint32_t>(progress_start_pos + progress));
-                    });
-                    co_await std::move(op);
-                }
-                catch (hresult_canceled const&) { throw; }
-                catch (hresult_error const&) {
-                    // Failed, just propagate the exception
-                    throw;
-                }
-                {   // Update unbuffered intervals
-                    std::unique_lock guard(m_mutex_unbuffered_intervals);
-                    auto [itb, ite] = get_its_pair_nolock_fn(target_interval->first, target_interval->second);
-                    if (itb < ite) {
-                        // Found intersecting intervals
-                        ite--;
-                        if (itb == ite) {
-                            uint64_t temp;
-                            // Split into multiple parts / one part / erase part
-                            switch (((target_interval->first > itb->first) << 1) |
-                                (target_interval->second < ite->second))
-                            {
-                            case 0b00:
-                                m_unbuffered_intervals.erase(itb);
-                                break;
-                            case 0b01:
-                                ite->first = target_interval->second;
-                                break;
-                            case 0b10:
-                                itb->second = target_interval->first;
-                                break;
-                            case 0b11:
-                                temp = itb->first;
-                                itb->first = target_interval->second;
-                                m_unbuffered_intervals.insert(itb, { temp, target_interval->first });
-                                break;
-                            }
-                        }
-                        else {
-                            if (target_interval->first > itb->first) {
-                                itb->second = target_interval->first;
-                                itb++;
-                            }
-                            if (target_interval->second < ite->second) {
-                                ite->first = target_interval->second;
-                            }
-                            else {
-                                ite++;
-                            }
-                            m_unbuffered_intervals.erase(itb, ite);
-                        }
-                        // Release intermediate memory when done
-                        if (m_unbuffered_intervals.empty()) { m_unbuffered_intervals.shrink_to_fit(); }
-                    }
+                {   // Segment is pinned, copy data out
+                    deferred([&] { unpin_segment(slot_idx); });
+                    std::memcpy(
+                        buf_ptr + (cur_pos - start),
+                        m_seg_bufs[slot_idx].data() + (cur_pos - seg_start),
+                        static_cast<size_t>(copy_end - cur_pos)
+                    );
                 }
+                record_copied_bytes(copy_end - cur_pos);
+                cur_pos = copy_end;
+                progress_token(static_cast<uint32_t>(cur_pos - start));
             }
 
-            co_return co_await m_buf_stream.GetInputStreamAt(start).ReadAsync(
-                std::move(buffer), static_cast<uint32_t>(end - start), options);
+            co_return buffer;
         }
-        uint64_t Size() { return m_size; }
-        void EnableMetricsCollection(bool enable, uint64_t max_events_count) {
-            if (m_enable_metrics_collection.exchange(enable) == enable) {
-                return;
-            }
-            std::scoped_lock guard_metrics(m_mutex_metrics);
-            if (m_enable_metrics_collection.load() != enable) {
-                // Value has changed, leaving current state stale
-                return;
+        // NOTE: Reads within a single segment are served by a view pinning the segment
+        IAsyncOperation<IBuffer> ReadBufferAtAsync(uint64_t start, uint64_t end) {
+            using details::HrasSegmentPool;
+
+            auto cancellation_token = co_await get_cancellation_token();
+            cancellation_token.enable_propagation();
+
+            if (end > m_size) {
+                end = m_size;
+                if (start > end) { start = end; }
             }
-            if (enable) {
-                m_metrics.last_start_ts = std::chrono::high_resolution_clock::now();
+            auto seg_idx = start / m_seg_size;
+            if (start >= end || (end - 1) / m_seg_size != seg_idx) {
+                // Views can't span multiple segments; copy instead
+                co_return co_await HttpRandomAccessStreamImpl_HttpBase::ReadBufferAtAsync(start, end);
             }
-            else {
-                if (m_metrics.active_connections > 0) {
-                    m_metrics.connection_duration +=
-                        std::chrono::high_resolution_clock::now() - m_metrics.last_start_ts;
+            auto seg_start = seg_idx * m_seg_size;
+
+            m_playhead_seg_idx.store(seg_idx);
+            notify_read(start, end);
+
+            while (true) {
+                std::shared_ptr<SharedFetch> pending_fetch;
+                std::shared_ptr<util::winrt::awaitable_event> slot_freed_event;
+                auto slot_idx = try_pin_segment(seg_idx, pending_fetch, slot_freed_event);
+                if (slot_idx != HrasSegmentPool::npos) {
+                    // SAFETY: Pinned segments are neither evicted nor refetched
+                    auto pin = std::make_shared<SegmentPin>(
+                        std::static_pointer_cast<HttpRandomAccessStreamImpl_SegmentBased>(shared_from_this()),
+                        slot_idx
+                    );
+                    auto data = m_seg_bufs[slot_idx].data() + (start - seg_start);
+                    co_return make<util::winrt::BufferView>(
+                        std::move(pin), data, static_cast<uint32_t>(end - start));
                 }
-            }
-        }
-        HttpRandomAccessStreamMetrics GetMetrics(bool clear_events) {
-            if (!m_enable_metrics_collection.load()) {
-                throw hresult_error(E_FAIL, L"Metrics collection is not enabled");
-            }
-            std::scoped_lock guard(m_mutex_metrics);
-            auto actual_duration = m_metrics.connection_duration;
-            if (m_metrics.active_connections > 0) {
-                actual_duration += std::chrono::high_resolution_clock::now() - m_metrics.last_start_ts;
-            }
-            auto actual_dur_secs = std::chrono::duration<double>(actual_duration).count();
-            auto inbound_bytes_per_sec = actual_dur_secs == 0 ? 0 : m_metrics.bytes_delta / actual_dur_secs;
-            uint64_t unallocated_buf_total_size = 0;
-            {
-                std::shared_lock guard_buf_ints(m_mutex_unbuffered_intervals);
-                for (auto const& i : m_unbuffered_intervals) {
-                    unallocated_buf_total_size += i.second - i.first;
+                if (!pending_fetch) {
+                    // All segments are in use; wait for some of them to be released
+                    co_await *slot_freed_event;
+                    continue;
                 }
+                // NOTE: The fetch may be shared with other readers, so our cancellation
+                //       only stops the wait, and leaves the fetch to them
+                cancellation_token.enable_propagation(false);
+                deferred([&] { cancellation_token.enable_propagation(true); });
+                co_await wait_shared_fetch(std::move(pending_fetch), cancellation_token);
             }
-            auto buf_total_size = m_buf_stream.Size();
-            HttpRandomAccessStreamMetrics result{
-                .ActiveConnectionsCount = m_metrics.active_connections,
-                .SentRequestsDelta = m_metrics.requests_delta,
-                .InboundBitsPerSecond = static_cast<uint64_t>(std::llround(inbound_bytes_per_sec * 8)),
-                .DownloadedBytesDelta = m_metrics.bytes_delta,
-                .AllocatedBufferSize = buf_total_size,
-                .UsedBufferSize = buf_total_size - unallocated_buf_total_size,
-            };
-            if (clear_events) {
-                m_metrics.last_start_ts = std::chrono::high_resolution_clock::now();
-                m_metrics.connection_duration = {};
-                m_metrics.requests_delta = 0;
-                m_metrics.bytes_delta = 0;
-            }
-            return result;
         }
 
-    private:
-        IAsyncAction trigger_new_uri_requested(void) {
-            com_ptr<NewUriRequestedEventArgs> ea_nur = nullptr;
-            bool owns_ea = false;
-            auto correlation_id = static_cast<uint32_t>(util::num::gen_global_seqid());
+    protected:
+        std::pair<uint64_t, uint64_t> get_buffer_usage(void) {
+            using details::HrasSegmentPool;
+            uint64_t used_buf_size = 0;
             {
-                std::scoped_lock guard(m_mutex_ea_nur);
-                ea_nur = m_ea_nur;
-                if (!ea_nur) {
-                    ea_nur = m_ea_nur = make_self<NewUriRequestedEventArgs>();
-                    owns_ea = true;
-                }
-            }
-            deferred([&] {
-                if (owns_ea) {
-                    std::scoped_lock guard(m_mutex_ea_nur);
-                    m_ea_nur = nullptr;
+                std::scoped_lock guard(m_mutex_pool);
+                for (size_t i = 0; i < m_pool.slots_count(); i++) {
+                    auto const& slot = m_pool.slot(i);
+                    if (slot.state != HrasSegmentPool::SlotState::Ready) { continue; }
+                    auto seg_start = slot.seg_idx * m_seg_size;
+                    used_buf_size += std::min(seg_start + m_seg_size, m_size) - seg_start;
                 }
-            });
-            if (owns_ea) {
-                util::debug::log_trace(std::format(L"Triggering event NewUriRequested (CorrelationId: {:08x})", correlation_id));
-                m_ev_new_uri_requested(make<HttpRandomAccessStream>(shared_from_this(), L""), *ea_nur);
             }
-            // WARN: winrt::deferrable_event_args::wait_for_deferrals() does not support
-            //       multiple awaiters, don't use it
-            co_await ea_nur->wait_for_deferrals();
-            if (owns_ea) {
-                util::debug::log_trace(std::format(L"Finished event NewUriRequested (CorrelationId: {:08x})", correlation_id));
+            return { m_allocated_segs_count.load() * m_seg_size, used_buf_size };
+        }
+        uint64_t max_prefetch_window(void) {
+            // Leave room for data around the playhead
+            return m_pool.slots_count() * m_seg_size / 2;
+        }
+        std::optional<std::pair<uint64_t, uint64_t>> first_missing_range(uint64_t start, uint64_t end) {
+            using details::HrasSegmentPool;
+            if (start >= end) { return std::nullopt; }
+            std::scoped_lock guard(m_mutex_pool);
+            for (auto seg_idx = start / m_seg_size; seg_idx * m_seg_size < end; seg_idx++) {
+                if (m_pool.find(seg_idx) != HrasSegmentPool::npos) { continue; }
+                auto seg_start = seg_idx * m_seg_size;
+                return std::pair{ std::max(start, seg_start), std::min(end, seg_start + m_seg_size) };
             }
+            return std::nullopt;
         }
-        // NOTE: This method only fills the specified part of buffer stream. Buffer ranges
-        //       should be managed outside the method.
-        IAsyncActionWithProgress<uint64_t> populate_buf_stream(uint64_t start, uint64_t end) {
+        util::winrt::task<bool> prefetch_range(uint64_t start, uint64_t end) {
+            using details::HrasSegmentPool;
+            auto strong_this = shared_from_this();
             auto cancellation_token = co_await get_cancellation_token();
-            cancellation_token.enable_propagation();
-            auto progress_token = co_await get_progress_token();
-
-            auto correlation_id = static_cast<uint32_t>(util::num::gen_global_seqid());
-            util::debug::log_trace(std::format(L"Fetching http range {}-{} (CorrelationId: {:08x})", start, end, correlation_id));
-
-            if (end > m_size) {
-                throw hresult_invalid_argument(L"Invalid read operation (out-of-bounds read)");
-            }
-            if (start > end) {
-                throw hresult_invalid_argument(L"Invalid read operation (negative-sized read)");
-            }
-
-            while (true) {
-                // Check whether we have uris
-                Uri cur_uri = nullptr;
+            co_await resume_background();
+            bool made_progress = false;
+            for (auto seg_idx = start / m_seg_size; seg_idx * m_seg_size < end; seg_idx++) {
+                std::shared_ptr<SharedFetch> pending_fetch;
+                uint64_t evicted_seg_idx = HrasSegmentPool::npos;
                 {
-                    std::shared_lock guard_uri(m_mutex_http_uris);
-                    if (!m_http_uris.empty()) {
-                        cur_uri = m_http_uris.front();
+                    std::scoped_lock guard(m_mutex_pool);
+                    auto slot_idx = m_pool.find(seg_idx);
+                    if (slot_idx == HrasSegmentPool::npos) {
+                        slot_idx = m_pool.acquire(seg_idx, m_playhead_seg_idx.load(), &evicted_seg_idx);
+                        if (slot_idx == HrasSegmentPool::npos) {
+                            // No room for more data; don't evict what readers are using
+                            co_return made_progress;
+                        }
+                        pending_fetch = start_fetch_segment_nolock(slot_idx, seg_idx);
                     }
-                }
-                if (cur_uri == nullptr) {
-                    // No uris, try to get some
-                    co_await trigger_new_uri_requested();
-                    // If we cannot get more uris, mark as failed
-                    std::shared_lock guard_uri(m_mutex_http_uris);
-                    if (m_http_uris.empty()) {
-                        throw hresult_error(E_FAIL, L"No uris available after NewUriRequested fired");
+                    else if (m_pool.slot(slot_idx).state == HrasSegmentPool::SlotState::Fetching) {
+                        pending_fetch = m_seg_fetches[slot_idx];
+                        pending_fetch->waiters_count++;
                     }
-                    cur_uri = m_http_uris.front();
                 }
-                // Try to fetch content
-                try {
-                    {
-                        std::scoped_lock guard_metrics(m_mutex_metrics);
-                        if (m_enable_metrics_collection.load()) {
-                            m_metrics.requests_delta++;
-                        }
-                        if (m_metrics.active_connections++ == 0) {
-                            m_metrics.last_start_ts = std::chrono::high_resolution_clock::now();
-                        }
-                    }
-                    deferred([&] {
-                        std::scoped_lock guard_metrics(m_mutex_metrics);
-                        if (--m_metrics.active_connections == 0) {
-                            if (m_enable_metrics_collection.load()) {
-                                m_metrics.connection_duration +=
-                                    std::chrono::high_resolution_clock::now() - m_metrics.last_start_ts;
-                            }
-                        }
-                    });
-                    // TODO: Known issue: HttpClient does not support concurrent requests
-                    auto http_content = co_await util::winrt::fetch_partial_http_content(
-                        cur_uri, m_http_client, start, end - start);
-                    auto op = http_content.WriteToStreamAsync(m_buf_stream.GetOutputStreamAt(start));
-                    uint64_t op_req_bytes = 0;
-                    op.Progress([&](auto const&, auto progress) {
-                        progress_token(static_cast<uint32_t>(progress));
-                        if (m_enable_metrics_collection.load()) {
-                            std::scoped_lock guard_metrics(m_mutex_metrics);
-                            m_metrics.bytes_delta += progress - op_req_bytes;
-                        }
-                        op_req_bytes = progress;
-                    });
-                    co_await std::move(op);
-                    util::debug::log_trace(std::format(L"Done fetching http range {}-{} (CorrelationId: {:08x})", start, end, correlation_id));
-                    co_return;
+                if (evicted_seg_idx != HrasSegmentPool::npos) {
+                    notify_segment_evicted(evicted_seg_idx);
                 }
-                catch (hresult_canceled const&) { throw; }
-                catch (hresult_error const& e) {
-                    util::debug::log_debug(std::format(
-                        L"HRAS: Failed to fetch `{}` with range {}-{} (0x{:08x}: {}) (CorrelationId: {:08x})",
-                        cur_uri.ToString(), start, end,
-                        static_cast<uint32_t>(e.code()), e.message(),
-                        correlation_id
-                    ));
-                    if (e.code() == E_CHANGED_STATE) {
-                        // Workaround HttpClient concurrency issue by ignoring E_CHANGED_STATE
-                        util::debug::log_debug(L"HRAS: Ignoring E_CHANGED_STATE exception");
-                        continue;
+                if (pending_fetch) {
+                    co_await wait_shared_fetch(std::move(pending_fetch), cancellation_token);
+                    made_progress = true;
+                }
+            }
+            co_return true;
+        }
+
+    private:
+        // Keeps a segment from being evicted while alive
+        struct SegmentPin {
+            SegmentPin(std::shared_ptr<HttpRandomAccessStreamImpl_SegmentBased> owner, size_t slot_idx) :
+                m_owner(std::move(owner)), m_slot_idx(slot_idx) {}
+            SegmentPin(SegmentPin const&) = delete;
+            SegmentPin& operator=(SegmentPin const&) = delete;
+            ~SegmentPin() { m_owner->unpin_segment(m_slot_idx); }
+        private:
+            std::shared_ptr<HttpRandomAccessStreamImpl_SegmentBased> m_owner;
+            size_t m_slot_idx;
+        };
+
+        // Pins the segment and returns its slot if it is ready. Otherwise returns npos, with
+        // pending_fetch set to the fetch to wait for (counting the caller as its waiter), or
+        // null if all slots are in use, in which case slot_freed_event is set to an event
+        // signaled once a slot may be available.
+        size_t try_pin_segment(
+            uint64_t seg_idx, std::shared_ptr<SharedFetch>& pending_fetch,
+            std::shared_ptr<util::winrt::awaitable_event>& slot_freed_event
+        ) {
+            using details::HrasSegmentPool;
+            size_t slot_idx;
+            uint64_t evicted_seg_idx = HrasSegmentPool::npos;
+            {
+                std::scoped_lock guard(m_mutex_pool);
+                slot_idx = m_pool.find(seg_idx);
+                if (slot_idx == HrasSegmentPool::npos) {
+                    slot_idx = m_pool.acquire(seg_idx, m_playhead_seg_idx.load(), &evicted_seg_idx);
+                    if (slot_idx != HrasSegmentPool::npos) {
+                        pending_fetch = start_fetch_segment_nolock(slot_idx, seg_idx);
                     }
-                    if (e.code() == E_ABORT || e.code() == E_HANDLE) {
-                        // HttpClient is reallocating resources; don't treat this as an error
-                        util::debug::log_debug(L"HRAS: Ignoring E_ABORT / E_HANDLE exception");
-                        continue;
+                    else {
+                        // NOTE: Taken under the lock, so that no release can be missed
+                        slot_freed_event = m_slot_freed_event;
                     }
-                    // Fetch failed, drop current uri
-                    // TODO: Implement retry policy
-                    std::unique_lock guard_uri(m_mutex_http_uris);
-                    if (!m_http_uris.empty() && cur_uri == m_http_uris.front()) {
-                        m_http_uris.pop_front();
+                }
+                else {
+                    auto& slot = m_pool.slot(slot_idx);
+                    if (slot.state == HrasSegmentPool::SlotState::Ready) {
+                        slot.pin_count++;
+                        slot.referenced = true;
+                    }
+                    else {
+                        pending_fetch = m_seg_fetches[slot_idx];
+                        pending_fetch->waiters_count++;
+                        record_coalesced_request();
                     }
                 }
+            }
+            if (evicted_seg_idx != HrasSegmentPool::npos) {
+                notify_segment_evicted(evicted_seg_idx);
+            }
+            return pending_fetch ? HrasSegmentPool::npos : slot_idx;
+        }
+        // Starts fetching into a newly acquired slot, counting the caller as a waiter
+        std::shared_ptr<SharedFetch> start_fetch_segment_nolock(size_t slot_idx, uint64_t seg_idx) {
+            auto fetch = std::make_shared<SharedFetch>();
+            fetch->waiters_count++;
+            // SAFETY: fetch_segment resumes in background before touching the pool
+            fetch->op = fetch_segment(slot_idx, seg_idx, fetch);
+            m_seg_fetches[slot_idx] = fetch;
+            return fetch;
+        }
+        void unpin_segment(size_t slot_idx) {
+            std::scoped_lock guard(m_mutex_pool);
+            if (--m_pool.slot(slot_idx).pin_count == 0) {
+                notify_slot_freed_nolock();
+            }
+        }
+        // Wakes up readers waiting for a slot; they will retry and wait again if necessary
+        void notify_slot_freed_nolock(void) {
+            m_slot_freed_event->set();
+            m_slot_freed_event = std::make_shared<util::winrt::awaitable_event>();
+        }
+        void notify_segment_evicted(uint64_t seg_idx) {
+            auto seg_start = seg_idx * m_seg_size;
+            notify_evicted(seg_start, std::min(seg_start + m_seg_size, m_size));
+        }
+
+        static uint64_t calc_segments_count(uint64_t size) {
+            return (size + DEFAULT_SEGMENT_SIZE - 1) / DEFAULT_SEGMENT_SIZE;
+        }
+        static size_t calc_slots_count(uint64_t size, uint64_t cache_capacity) {
+            auto segs_count = calc_segments_count(size);
+            auto slots_count = std::max<uint64_t>(cache_capacity / DEFAULT_SEGMENT_SIZE, MIN_SEGMENTS_COUNT);
+            return static_cast<size_t>(std::min(slots_count, segs_count));
+        }
 
-                co_await std::chrono::milliseconds(100);
+        // NOTE: Runs detached from the initiating reader, so that other readers
+        //       waiting for the same segment are not affected by cancellation;
+        //       only cancelled once all of its waiters have left
+        util::winrt::task<> fetch_segment(size_t slot_idx, uint64_t seg_idx, std::shared_ptr<SharedFetch> fetch) {
+            auto strong_this = shared_from_this();
+            auto cancellation_token = co_await get_cancellation_token();
+            cancellation_token.enable_propagation();
+            co_await resume_background();
+            deferred([&] { fetch->done.set(); });
+            auto seg_start = seg_idx * m_seg_size;
+            auto seg_end = std::min(seg_start + m_seg_size, m_size);
+            try {
+                // SAFETY: Slots in Fetching state are exclusively owned by the fetcher
+                auto& seg_buf = m_seg_bufs[slot_idx];
+                if (!seg_buf) {
+                    seg_buf = Buffer(static_cast<uint32_t>(m_seg_size));
+                    m_allocated_segs_count++;
+                }
+                seg_buf.Length(0);
+                co_await fetch_range_cached(seg_start, seg_end,
+                    make<util::winrt::BufferBackedRandomAccessStream>(seg_buf), seg_start);
+                // NOTE: Completeness is already checked for every request
+                seg_buf.Length(static_cast<uint32_t>(seg_end - seg_start));
             }
+            catch (...) {
+                fetch->error = std::current_exception();
+                std::scoped_lock guard(m_mutex_pool);
+                m_pool.release(slot_idx);
+                m_seg_fetches[slot_idx] = nullptr;
+                notify_slot_freed_nolock();
+                throw;
+            }
+            std::scoped_lock guard(m_mutex_pool);
+            m_pool.mark_ready(slot_idx);
+            m_seg_fetches[slot_idx] = nullptr;
+            notify_slot_freed_nolock();
         }
 
-        IRandomAccessStream m_buf_stream;
-        std::mutex m_mutex_ea_nur;
-        com_ptr<NewUriRequestedEventArgs> m_ea_nur;
-        std::shared_mutex m_mutex_http_uris;
-        std::deque<Uri> m_http_uris;
-        std::shared_mutex m_mutex_unbuffered_intervals;
-        std::vector<std::pair<uint64_t, uint64_t>> m_unbuffered_intervals;
-        HttpClient m_http_client;
-        uint64_t m_size;
         bool m_extra_integrity_check;
-        event<EventHandlerType_NUR> m_ev_new_uri_requested;
-        std::atomic_bool m_enable_metrics_collection;
-        std::mutex m_mutex_metrics;
-        struct {
-            uint64_t active_connections;
-            std::chrono::high_resolution_clock::time_point last_start_ts;
-            std::chrono::high_resolution_clock::duration connection_duration;
-            uint64_t requests_delta;
-            uint64_t bytes_delta;
-        } m_metrics;
+        const uint64_t m_seg_size;
+        std::mutex m_mutex_pool;
+        details::HrasSegmentPool m_pool;
+        std::vector<IBuffer> m_seg_bufs;
+        std::vector<std::shared_ptr<SharedFetch>> m_seg_fetches;
+        // NOTE: Replaced with a new event every time it is signaled
+        std::shared_ptr<util::winrt::awaitable_event> m_slot_freed_event;
+        std::atomic<uint64_t> m_allocated_segs_count;
+        std::atomic<uint64_t> m_playhead_seg_idx;
     };
 }
 
@@ -647,7 +1954,10 @@ namespace winrt::BiliUWP::implementation {
         std::shared_ptr<HttpRandomAccessStreamImpl> impl,
         hstring content_type,
         uint64_t start_pos
-    ) : m_impl(std::move(impl)), m_content_type(std::move(content_type)), m_cur_pos(start_pos) {}
+    ) : m_impl(std::move(impl)), m_content_type(std::move(content_type)), m_cur_pos(start_pos)
+    {
+        m_impl->m_open_streams_count++;
+    }
     IAsyncOperation<BiliUWP::HttpRandomAccessStream> HttpRandomAccessStream::CreateAsync(
         Uri http_uri,
         HttpClient http_client,
@@ -659,8 +1969,9 @@ namespace winrt::BiliUWP::implementation {
         case HttpRandomAccessStreamBufferOptions::None:
             break;
         case HttpRandomAccessStreamBufferOptions::Sized:
-            // TODO: Implement this
-            throw hresult_not_implemented();
+            if (cache_capacity == 0) {
+                throw hresult_invalid_argument(L"cache_capacity must be non-zero for Sized buffers");
+            }
             break;
         case HttpRandomAccessStreamBufferOptions::DynamicallySized:
             // TODO: Implement this
@@ -705,21 +2016,21 @@ namespace winrt::BiliUWP::implementation {
         auto status_code = http_resp.StatusCode();
         if (!http_resp.IsSuccessStatusCode()) {
             // Hack: retry with HTTP GET method
-            util::debug::log_warn(std::format(
+            util::debug::log_warn(
                 L"HRAS: Requested resource is invalid (HTTP {}), retrying",
                 std::to_underlying(status_code)
-            ));
+            );
             http_resp = co_await http_client.SendRequestAsync(
                 make_partial_http_req_fn(http_uri, false), HttpCompletionOption::ResponseHeadersRead
             );
         }
         status_code = http_resp.EnsureSuccessStatusCode().StatusCode();
         if (status_code != HttpStatusCode::PartialContent) {
-            util::debug::log_warn(std::format(
+            util::debug::log_warn(
                 L"HRAS: Requested resource does not support partial downloading (HTTP {}), "
                 "ignoring as a workaround",
                 std::to_underlying(status_code)
-            ));
+            );
             /*throw hresult_error(E_FAIL, std::format(
                 L"Requested resource does not support partial downloading (HTTP {})",
                 std::to_underlying(status_code)
@@ -735,7 +2046,7 @@ namespace winrt::BiliUWP::implementation {
         }
         auto cont_len = nullable_cont_len.Value();
 
-        util::debug::log_trace(std::format(L"New HttpRandomAccessStream: {}, {} Bytes", cont_type, cont_len));
+        util::debug::log_trace(L"New HttpRandomAccessStream: {}, {} Bytes", cont_type, cont_len);
 
         if (buffer_options == HttpRandomAccessStreamBufferOptions::None) {
             co_return make<HttpRandomAccessStream>(std::make_shared<HttpRandomAccessStreamImpl_Direct>(
@@ -745,6 +2056,10 @@ namespace winrt::BiliUWP::implementation {
             co_return make<HttpRandomAccessStream>(std::make_shared<HttpRandomAccessStreamImpl_StreamBased>(
                 http_uri, http_client, cont_len, false), cont_type);
         }
+        else if (buffer_options == HttpRandomAccessStreamBufferOptions::Sized) {
+            co_return make<HttpRandomAccessStream>(std::make_shared<HttpRandomAccessStreamImpl_SegmentBased>(
+                http_uri, http_client, cont_len, cache_capacity, false), cont_type);
+        }
         else {
             // TODO...
             throw hresult_not_implemented();
@@ -762,6 +2077,21 @@ namespace winrt::BiliUWP::implementation {
         if (!m_impl) { throw hresult_illegal_method_call(); }
         return m_impl->GetActiveUris();
     }
+    com_array<HttpRandomAccessStreamUriScore> HttpRandomAccessStream::GetUriScores() {
+        std::shared_lock guard_impl(m_impl_mutex);
+        if (!m_impl) { throw hresult_illegal_method_call(); }
+        return m_impl->GetUriScores();
+    }
+    IAsyncOperation<IBuffer> HttpRandomAccessStream::ReadBufferAtAsync(uint64_t position, uint32_t count) {
+        auto cancellation_token = co_await get_cancellation_token();
+        cancellation_token.enable_propagation(true);
+
+        m_impl_mutex.lock_shared();
+        std::shared_ptr<HttpRandomAccessStreamImpl> impl = m_impl;
+        m_impl_mutex.unlock_shared();
+        if (!impl) { throw hresult_illegal_method_call(); }
+        co_return co_await impl->ReadBufferAtAsync(position, position + count);
+    }
     void HttpRandomAccessStream::EnableMetricsCollection(bool enable, uint64_t max_events_count) {
         std::shared_lock guard_impl(m_impl_mutex);
         if (!m_impl) { throw hresult_illegal_method_call(); }
@@ -782,6 +2112,28 @@ namespace winrt::BiliUWP::implementation {
         if (!m_impl) { throw hresult_illegal_method_call(); }
         return m_impl->RetryPolicy(value);
     }
+    void HttpRandomAccessStream::EnablePersistentCache(hstring const& key) {
+        std::shared_lock guard_impl(m_impl_mutex);
+        if (!m_impl) { throw hresult_illegal_method_call(); }
+        return m_impl->EnablePersistentCache(key);
+    }
+    void HttpRandomAccessStream::Prefetch(
+        uint64_t start, uint64_t length, HttpRandomAccessStreamPrefetchPriority priority
+    ) {
+        std::shared_lock guard_impl(m_impl_mutex);
+        if (!m_impl) { throw hresult_illegal_method_call(); }
+        return m_impl->Prefetch(start, length, priority);
+    }
+    uint64_t HttpRandomAccessStream::PrefetchWindowSize() {
+        std::shared_lock guard_impl(m_impl_mutex);
+        if (!m_impl) { throw hresult_illegal_method_call(); }
+        return m_impl->PrefetchWindowSize();
+    }
+    void HttpRandomAccessStream::PrefetchWindowSize(uint64_t value) {
+        std::shared_lock guard_impl(m_impl_mutex);
+        if (!m_impl) { throw hresult_illegal_method_call(); }
+        return m_impl->PrefetchWindowSize(value);
+    }
     event_token HttpRandomAccessStream::NewUriRequested(EventHandlerType_NUR const& handler) {
         std::shared_lock guard_impl(m_impl_mutex);
         if (!m_impl) { throw hresult_illegal_method_call(); }
@@ -799,9 +2151,15 @@ namespace winrt::BiliUWP::implementation {
         m_impl_mutex.unlock();
         if (!impl) { return; }
         // Clean up running async tasks and destruct impl
-        std::scoped_lock guard_async(m_pending_async_mutex);
-        if (m_pending_async) {
-            m_pending_async.Cancel();
+        {
+            std::scoped_lock guard_async(m_pending_async_mutex);
+            if (m_pending_async) {
+                m_pending_async.Cancel();
+            }
+        }
+        // NOTE: Impls are shared by clones, so only the last one stops background work
+        if (--impl->m_open_streams_count == 0) {
+            impl->shutdown();
         }
     }
     IAsyncOperationWithProgress<IBuffer, uint32_t> HttpRandomAccessStream::ReadAsync(
@@ -14,6 +14,7 @@ namespace winrt::BiliUWP::implementation {
     struct HttpRandomAccessStreamImpl : std::enable_shared_from_this<HttpRandomAccessStreamImpl> {
         virtual void SupplyNewUri(array_view<Windows::Foundation::Uri const> new_uris) = 0;
         virtual com_array<Windows::Foundation::Uri> GetActiveUris() = 0;
+        virtual com_array<HttpRandomAccessStreamUriScore> GetUriScores() { return {}; }
         virtual event_token NewUriRequested(EventHandlerType_NUR const& handler) = 0;
         virtual void NewUriRequested(event_token const& token) noexcept = 0;
         virtual Windows::Foundation::IAsyncOperationWithProgress<Windows::Storage::Streams::IBuffer, uint32_t> ReadAtAsync(
@@ -21,17 +22,34 @@ namespace winrt::BiliUWP::implementation {
             uint64_t start, uint64_t end,
             Windows::Storage::Streams::InputStreamOptions options
         ) = 0;
+        // NOTE: Impls may return views into their buffers instead of copies
+        virtual Windows::Foundation::IAsyncOperation<Windows::Storage::Streams::IBuffer> ReadBufferAtAsync(
+            uint64_t start, uint64_t end
+        ) {
+            auto buffer = Windows::Storage::Streams::Buffer(static_cast<uint32_t>(end - start));
+            co_return co_await ReadAtAsync(std::move(buffer), start, end,
+                Windows::Storage::Streams::InputStreamOptions::None);
+        }
         virtual uint64_t Size() = 0;
         virtual void EnableMetricsCollection(bool enable, uint64_t max_events_count) = 0;
         virtual HttpRandomAccessStreamMetrics GetMetrics(bool clear_events) = 0;
-        virtual HttpRandomAccessStreamRetryPolicy RetryPolicy() { 
-            // TODO: RetryPolicy.Get
+        // NOTE: Only impls which fetch over http have a retry policy
+        virtual HttpRandomAccessStreamRetryPolicy RetryPolicy() {
             throw hresult_not_implemented(L"RetryPolicy.Get");
         }
         virtual void RetryPolicy(HttpRandomAccessStreamRetryPolicy const& value) {
-            // TODO: RetryPolicy.Set
             throw hresult_not_implemented(L"RetryPolicy.Set");
         }
+        // NOTE: Impls which never fetch after creation ignore the persistent cache
+        virtual void EnablePersistentCache(hstring const& key) {}
+        virtual void Prefetch(uint64_t start, uint64_t length, HttpRandomAccessStreamPrefetchPriority priority) {}
+        virtual uint64_t PrefetchWindowSize() { return 0; }
+        virtual void PrefetchWindowSize(uint64_t value) {}
+        // Stops background work, such as prefetching; called once the last stream is closed
+        virtual void shutdown() {}
+
+        // NOTE: Maintained by HttpRandomAccessStream, as impls are shared by clones
+        std::atomic<uint32_t> m_open_streams_count{ 0 };
     };
 
     struct HttpRandomAccessStream : HttpRandomAccessStreamT<HttpRandomAccessStream> {
@@ -50,10 +68,18 @@ namespace winrt::BiliUWP::implementation {
         );
         void SupplyNewUri(array_view<Windows::Foundation::Uri const> new_uris);
         com_array<Windows::Foundation::Uri> GetActiveUris();
+        com_array<HttpRandomAccessStreamUriScore> GetUriScores();
         void EnableMetricsCollection(bool enable, uint64_t max_events_count);
         HttpRandomAccessStreamMetrics GetMetrics(bool clear_events);
+        Windows::Foundation::IAsyncOperation<Windows::Storage::Streams::IBuffer> ReadBufferAtAsync(
+            uint64_t position, uint32_t count
+        );
         HttpRandomAccessStreamRetryPolicy RetryPolicy();
         void RetryPolicy(HttpRandomAccessStreamRetryPolicy const& value);
+        void EnablePersistentCache(hstring const& key);
+        void Prefetch(uint64_t start, uint64_t length, HttpRandomAccessStreamPrefetchPriority priority);
+        uint64_t PrefetchWindowSize();
+        void PrefetchWindowSize(uint64_t value);
         event_token NewUriRequested(EventHandlerType_NUR const& handler);
         void NewUriRequested(event_token const& token) noexcept;
         void Close();
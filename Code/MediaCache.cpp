@@ -0,0 +1,701 @@
+#include "pch.h"
+#include "MediaCache.h"
+
+#include "sqlite3_util.hpp"
+#include <shared_mutex>
+#include <set>
+
+namespace BiliUWP {
+    using namespace winrt::Windows::Foundation;
+    using namespace winrt::Windows::Storage;
+
+    constexpr uint64_t MEDIA_CACHE_CAPACITY = 2ull * 1024 * 1024 * 1024;
+    // NOTE: Written data stays in memory for a while, so that it is committed in batches
+    constexpr auto WRITE_BEHIND_DELAY = std::chrono::milliseconds(500);
+    // Writes beyond this amount of pending data are dropped instead of queued
+    constexpr uint64_t WRITE_BEHIND_MAX_PENDING_SIZE = 64 * 1024 * 1024;
+    // Last access time of streams is only recorded at this granularity (in seconds), so
+    // that reads don't cause a database write every time
+    constexpr uint64_t LAST_ACCESS_UPDATE_INTERVAL = 60;
+    // Streams not accessed for this long (in seconds) have their data files closed
+    constexpr uint64_t IDLE_ENTRY_TIMEOUT = 5 * 60;
+    // NOTE: ReadFile / WriteFile cannot transfer more than 4 GiB at once
+    constexpr size_t FILE_IO_MAX_CHUNK_SIZE = 64 * 1024 * 1024;
+
+    static bool read_file_at(HANDLE hfile, uint64_t pos, void* buf, size_t count) {
+        auto out = static_cast<uint8_t*>(buf);
+        while (count > 0) {
+            auto chunk_size = static_cast<DWORD>(std::min(count, FILE_IO_MAX_CHUNK_SIZE));
+            OVERLAPPED ol{};
+            ol.Offset = static_cast<DWORD>(pos);
+            ol.OffsetHigh = static_cast<DWORD>(pos >> 32);
+            DWORD actual_size;
+            if (!ReadFile(hfile, out, chunk_size, &actual_size, &ol) || actual_size != chunk_size) {
+                return false;
+            }
+            out += chunk_size;
+            pos += chunk_size;
+            count -= chunk_size;
+        }
+        return true;
+    }
+    static void write_file_at(HANDLE hfile, uint64_t pos, const void* buf, size_t count) {
+        auto in = static_cast<const uint8_t*>(buf);
+        while (count > 0) {
+            auto chunk_size = static_cast<DWORD>(std::min(count, FILE_IO_MAX_CHUNK_SIZE));
+            OVERLAPPED ol{};
+            ol.Offset = static_cast<DWORD>(pos);
+            ol.OffsetHigh = static_cast<DWORD>(pos >> 32);
+            DWORD actual_size;
+            winrt::check_bool(WriteFile(hfile, in, chunk_size, &actual_size, &ol));
+            if (actual_size != chunk_size) {
+                throw winrt::hresult_error(E_FAIL, L"MediaCache: Short write to data file");
+            }
+            in += chunk_size;
+            pos += chunk_size;
+            count -= chunk_size;
+        }
+    }
+
+    struct details::MediaCacheImpl : std::enable_shared_from_this<MediaCacheImpl> {
+        MediaCacheImpl(StorageFolder const& root, winrt::hstring const& name, uint64_t capacity) :
+            m_root(root), m_name(name), m_capacity(capacity), m_total_size(0), m_db(nullptr) {}
+        ~MediaCacheImpl() {
+            if (m_db) {
+                m_stmt_pool.clear();
+                check_sqlite3_call(sqlite3_close, m_db);
+            }
+        }
+        std::optional<std::pair<uint64_t, uint64_t>> first_missing_range(
+            winrt::hstring const& key, uint64_t size, uint64_t start, uint64_t end
+        ) {
+            if (start >= end) { return std::nullopt; }
+            auto entry = open_entry(key, size, false);
+            if (!entry) { return std::pair{ start, end }; }
+            std::shared_lock guard(entry->mutex);
+            auto cur_pos = start;
+            auto it = entry->chunks.upper_bound(cur_pos);
+            if (it != entry->chunks.begin()) {
+                cur_pos = std::max(cur_pos, std::prev(it)->second.end);
+            }
+            // NOTE: Chunks never overlap, but adjacent chunks are not always merged
+            while (cur_pos < end && it != entry->chunks.end() && it->first == cur_pos) {
+                cur_pos = it->second.end;
+                ++it;
+            }
+            if (cur_pos > start) { touch_entry(key, *entry); }
+            if (cur_pos >= end) { return std::nullopt; }
+            auto gap_end = it != entry->chunks.end() ? std::min(it->first, end) : end;
+            return std::pair{ cur_pos, gap_end };
+        }
+        bool read(winrt::hstring const& key, uint64_t size, uint64_t pos, void* buf, size_t count) {
+            if (count == 0) { return true; }
+            auto entry = open_entry(key, size, false);
+            if (!entry) { return false; }
+            std::shared_lock guard(entry->mutex);
+            if (entry->evicted) { return false; }
+            auto end = pos + count;
+            auto it = entry->chunks.upper_bound(pos);
+            if (it == entry->chunks.begin()) { return false; }
+            --it;
+            auto out = static_cast<uint8_t*>(buf);
+            while (pos < end) {
+                if (it == entry->chunks.end() || it->first > pos || it->second.end <= pos) {
+                    return false;
+                }
+                auto chunk_size = std::min(it->second.end, end) - pos;
+                auto file_pos = it->second.file_offset + (pos - it->first);
+                if (!read_file_at(entry->hfile.get(), file_pos, out, static_cast<size_t>(chunk_size))) {
+                    return false;
+                }
+                out += chunk_size;
+                pos += chunk_size;
+                ++it;
+            }
+            touch_entry(key, *entry);
+            return true;
+        }
+        // NOTE: Data is queued and written by a background writer, so it only becomes
+        //       readable after a short delay
+        void write(winrt::hstring const& key, uint64_t size, uint64_t pos, const void* buf, size_t count) {
+            if (count == 0) { return; }
+            if (pos + count > size) {
+                throw winrt::hresult_out_of_bounds(L"MediaCache: Write out of stream bounds");
+            }
+            check_key(key);
+            auto in = static_cast<const uint8_t*>(buf);
+            std::scoped_lock guard(m_mutex_pending_writes);
+            if (m_pending_writes_size + count > WRITE_BEHIND_MAX_PENDING_SIZE) {
+                // The writer cannot keep up; it's only a cache, so just drop the data
+                util::debug::log_debug(L"MediaCache: Too much pending data, dropping write to `{}`", key);
+                return;
+            }
+            m_pending_writes.push_back({ key, size, pos, std::vector<uint8_t>(in, in + count) });
+            m_pending_writes_size += count;
+            schedule_writer_nolock();
+        }
+        uint64_t total_size(void) {
+            std::scoped_lock guard(m_mutex);
+            return m_total_size;
+        }
+        uint64_t capacity(void) {
+            std::scoped_lock guard(m_mutex);
+            return m_capacity;
+        }
+        void capacity(uint64_t value) {
+            std::scoped_lock guard(m_mutex);
+            m_capacity = value;
+            evict_nolock(L"");
+        }
+        util::winrt::task<> clear_async(void) {
+            co_await winrt::resume_background();
+            {
+                std::scoped_lock guard(m_mutex_pending_writes);
+                m_pending_writes.clear();
+                m_pending_writes_size = 0;
+                m_pending_touches.clear();
+            }
+            // NOTE: Wait for the batch being flushed, if any
+            std::scoped_lock guard_flush(m_mutex_flush);
+            std::scoped_lock guard(m_mutex);
+            std::vector<winrt::hstring> keys;
+            {
+                Sqlite3Statement db_stmt(m_stmt_pool, L"SELECT stream_key FROM streams;");
+                while (db_stmt.step()) {
+                    keys.emplace_back(db_stmt.col_str16(0));
+                }
+            }
+            for (auto const& key : keys) {
+                remove_stream_nolock(key);
+            }
+            m_total_size = 0;
+        }
+
+    private:
+        friend struct MediaCache;
+
+        struct Chunk {
+            uint64_t end;
+            uint64_t file_offset;
+        };
+        struct PendingWrite {
+            winrt::hstring key;
+            uint64_t size;
+            uint64_t pos;
+            std::vector<uint8_t> data;
+        };
+        struct StreamEntry {
+            uint64_t size;
+            winrt::file_handle hfile;
+            // NOTE: Guards chunks & file_size, and serializes appending to the data file
+            std::shared_mutex mutex;
+            // Stream position => chunk
+            std::map<uint64_t, Chunk> chunks;
+            uint64_t file_size;
+            std::atomic_bool evicted{ false };
+            // NOTE: Only kept up to date within LAST_ACCESS_UPDATE_INTERVAL
+            std::atomic<uint64_t> last_access_ts{ 0 };
+        };
+
+        // WARN: Caller must hold m_mutex_pending_writes
+        void schedule_writer_nolock(void) {
+            if (m_writer_scheduled) { return; }
+            m_writer_scheduled = true;
+            // SAFETY: run_writer resumes in background before touching pending writes
+            m_writer = run_writer();
+        }
+        // Records a read from a cached stream, so that it is evicted later
+        // NOTE: The access time is committed along with pending writes
+        void touch_entry(winrt::hstring const& key, StreamEntry& entry) {
+            auto cur_ts = get_cur_ts();
+            auto last_access_ts = entry.last_access_ts.load();
+            if (cur_ts < last_access_ts + LAST_ACCESS_UPDATE_INTERVAL) { return; }
+            // NOTE: Only one of the concurrent readers needs to queue the update
+            if (!entry.last_access_ts.compare_exchange_strong(last_access_ts, cur_ts)) { return; }
+            std::scoped_lock guard(m_mutex_pending_writes);
+            m_pending_touches.insert(key);
+            schedule_writer_nolock();
+        }
+
+        util::winrt::task<> run_writer(void) {
+            auto strong_this = shared_from_this();
+            co_await winrt::resume_background();
+            co_await WRITE_BEHIND_DELAY;
+            try { flush_pending_writes(); }
+            catch (...) {
+                util::winrt::log_current_exception();
+            }
+        }
+        // Appends data of pending writes to the data files, and commits the index in a
+        // single transaction
+        // NOTE: Failed batches are dropped; the data will simply be fetched again
+        void flush_pending_writes(void) {
+            std::scoped_lock guard_flush(m_mutex_flush);
+            std::vector<PendingWrite> batch;
+            std::set<winrt::hstring> touched_keys;
+            {
+                std::scoped_lock guard(m_mutex_pending_writes);
+                m_writer_scheduled = false;
+                batch.swap(m_pending_writes);
+                m_pending_writes_size = 0;
+                touched_keys.swap(m_pending_touches);
+            }
+            if (batch.empty() && touched_keys.empty()) { return; }
+            // NOTE: The stream being written is exempted from eviction, as it is most likely
+            //       the one being played. Cap its size instead, so that the cache stays bounded.
+            auto max_stream_size = capacity();
+            struct ChangedStream {
+                winrt::hstring key;
+                std::shared_ptr<StreamEntry> entry;
+                uint64_t old_file_size;
+                std::set<uint64_t> chunk_starts;
+            };
+            std::vector<ChangedStream> changed_streams;
+            for (auto const& w : batch) {
+                auto entry = open_entry(w.key, w.size, true);
+                std::unique_lock guard(entry->mutex);
+                if (entry->evicted) { continue; }
+                if (entry->file_size + w.data.size() > max_stream_size) {
+                    util::debug::log_debug(L"MediaCache: Stream `{}` is too large, dropping write", w.key);
+                    continue;
+                }
+                auto it = std::find_if(changed_streams.begin(), changed_streams.end(),
+                    [&](ChangedStream const& e) { return e.entry == entry; });
+                if (it == changed_streams.end()) {
+                    it = changed_streams.insert(changed_streams.end(),
+                        ChangedStream{ w.key, entry, entry->file_size, {} });
+                }
+                append_data_nolock(*entry, w.pos, w.data.data(), w.data.size(), it->chunk_starts);
+            }
+            // Take a snapshot of the changed index, so that entries are not locked
+            // while holding m_mutex
+            struct ChunkRow {
+                uint64_t start, end, file_offset;
+            };
+            std::vector<std::vector<ChunkRow>> chunk_rows(changed_streams.size());
+            std::vector<uint64_t> file_sizes(changed_streams.size());
+            for (size_t i = 0; i < changed_streams.size(); i++) {
+                auto const& cs = changed_streams[i];
+                std::shared_lock guard(cs.entry->mutex);
+                for (auto chunk_start : cs.chunk_starts) {
+                    auto const& chunk = cs.entry->chunks.at(chunk_start);
+                    chunk_rows[i].push_back({ chunk_start, chunk.end, chunk.file_offset });
+                }
+                file_sizes[i] = cs.entry->file_size;
+            }
+
+            std::scoped_lock db_guard(m_mutex);
+            Sqlite3Statement(m_db, L"BEGIN;").step();
+            bool committed = false;
+            deferred([&] {
+                if (!committed) { sqlite3_exec(m_db, "ROLLBACK;", nullptr, nullptr, nullptr); }
+            });
+            auto cur_ts = get_cur_ts();
+            uint64_t added_size = 0;
+            for (size_t i = 0; i < changed_streams.size(); i++) {
+                auto const& cs = changed_streams[i];
+                // NOTE: Evicted streams must not be brought back
+                if (cs.entry->evicted) { continue; }
+                for (auto const& row : chunk_rows[i]) {
+                    Sqlite3Statement db_stmt(m_stmt_pool, L"INSERT OR REPLACE INTO chunks"
+                        "(stream_key, start_pos, end_pos, file_offset) VALUES(?, ?, ?, ?);");
+                    db_stmt.bind(1, cs.key, false);
+                    db_stmt.bind(2, static_cast<int64_t>(row.start));
+                    db_stmt.bind(3, static_cast<int64_t>(row.end));
+                    db_stmt.bind(4, static_cast<int64_t>(row.file_offset));
+                    db_stmt.step();
+                }
+                Sqlite3Statement db_stmt(m_stmt_pool,
+                    L"UPDATE streams SET cached_size = ?, last_access_ts = ? WHERE stream_key = ?;");
+                db_stmt.bind(1, static_cast<int64_t>(file_sizes[i]));
+                db_stmt.bind(2, static_cast<int64_t>(cur_ts));
+                db_stmt.bind(3, cs.key, false);
+                db_stmt.step();
+                cs.entry->last_access_ts.store(cur_ts);
+                added_size += file_sizes[i] - cs.old_file_size;
+            }
+            for (auto const& key : touched_keys) {
+                Sqlite3Statement db_stmt(m_stmt_pool,
+                    L"UPDATE streams SET last_access_ts = MAX(last_access_ts, ?) WHERE stream_key = ?;");
+                db_stmt.bind(1, static_cast<int64_t>(cur_ts));
+                db_stmt.bind(2, key, false);
+                db_stmt.step();
+            }
+            Sqlite3Statement(m_db, L"COMMIT;").step();
+            committed = true;
+            m_total_size += added_size;
+            // NOTE: The most recently written stream is most likely the one being played
+            evict_nolock(batch.empty() ? winrt::hstring{} : batch.back().key);
+        }
+        // Closes data files of streams which have not been accessed for a while
+        // NOTE: Entries are reloaded from the database on demand. Runs until no entry is left.
+        util::winrt::task<> run_idle_sweeper(void) {
+            auto strong_this = shared_from_this();
+            co_await winrt::resume_background();
+            while (true) {
+                co_await std::chrono::seconds(IDLE_ENTRY_TIMEOUT);
+                // NOTE: Entries being flushed must stay, as their index may not be committed yet
+                std::scoped_lock guard_flush(m_mutex_flush);
+                std::scoped_lock guard(m_mutex);
+                auto cur_ts = get_cur_ts();
+                std::erase_if(m_entries, [&](auto const& e) {
+                    // NOTE: Entries still in use by readers are kept, so that no stream
+                    //       is ever opened twice
+                    return e.second.use_count() == 1 &&
+                        cur_ts >= e.second->last_access_ts.load() + IDLE_ENTRY_TIMEOUT;
+                });
+                if (m_entries.empty()) {
+                    m_idle_sweeper_running = false;
+                    co_return;
+                }
+            }
+        }
+        // Appends the parts of [pos, pos + count) which are not cached yet to the data file
+        // WARN: Caller must hold entry.mutex exclusively
+        static void append_data_nolock(
+            StreamEntry& entry, uint64_t pos, const uint8_t* in, size_t count,
+            std::set<uint64_t>& changed_chunks
+        ) {
+            auto end = pos + count;
+            auto cur_pos = pos;
+            while (cur_pos < end) {
+                auto it = entry.chunks.upper_bound(cur_pos);
+                if (it != entry.chunks.begin() && std::prev(it)->second.end > cur_pos) {
+                    // Already cached
+                    cur_pos = std::min(std::prev(it)->second.end, end);
+                    continue;
+                }
+                auto gap_end = it != entry.chunks.end() ? std::min(it->first, end) : end;
+                auto file_offset = entry.file_size;
+                write_file_at(entry.hfile.get(), file_offset, in + (cur_pos - pos),
+                    static_cast<size_t>(gap_end - cur_pos));
+                entry.file_size += gap_end - cur_pos;
+                // NOTE: Extend the previous chunk if possible, so that sequential
+                //       writes end up as a single chunk
+                uint64_t chunk_start = cur_pos;
+                auto prev_it = it != entry.chunks.begin() ? std::prev(it) : entry.chunks.end();
+                if (prev_it != entry.chunks.end() && prev_it->second.end == cur_pos &&
+                    prev_it->second.file_offset + (prev_it->second.end - prev_it->first) == file_offset)
+                {
+                    prev_it->second.end = gap_end;
+                    chunk_start = prev_it->first;
+                }
+                else {
+                    entry.chunks.emplace_hint(it, cur_pos, Chunk{ .end = gap_end, .file_offset = file_offset });
+                }
+                changed_chunks.insert(chunk_start);
+                cur_pos = gap_end;
+            }
+        }
+
+        // WARN: Not protected by mutex; caller must guarantee thread safety
+        util::winrt::task<> init_async(void) {
+            if (m_db) { co_return; }
+            co_await winrt::resume_background();
+            auto cache_dir = co_await m_root.CreateFolderAsync(m_name, CreationCollisionOption::OpenIfExists);
+            m_cache_dir_path = cache_dir.Path();
+            if (m_cache_dir_path.back() != L'\\') {
+                m_cache_dir_path = m_cache_dir_path + L'\\';
+            }
+            auto db_path = m_cache_dir_path + L"index.db";
+            if (sqlite3_open16(db_path.data(), &m_db) != SQLITE_OK) {
+                if (!m_db) {
+                    throw winrt::hresult_error(E_OUTOFMEMORY, L"sqlite3 init database out of memory");
+                }
+                deferred([&] { sqlite3_close(m_db); m_db = nullptr; });
+                throw_sqlite3_error(m_db);
+            }
+            configure_sqlite3_db(m_db);
+            m_stmt_pool.attach(m_db);
+            update_database();
+            {
+                Sqlite3Statement db_stmt(m_stmt_pool, L"SELECT COALESCE(SUM(cached_size), 0) FROM streams;");
+                if (db_stmt.step()) {
+                    m_total_size = static_cast<uint64_t>(db_stmt.col_i64(0));
+                }
+            }
+            evict_nolock(L"");
+        }
+        void update_database() {
+            Sqlite3Statement stmt_user_version(m_db, L"PRAGMA user_version;");
+            if (!stmt_user_version.step()) {
+                throw winrt::hresult_error(E_FAIL, L"MediaCache: Cannot retrieve database version");
+            }
+            auto current_version = stmt_user_version.col_i64(0);
+            if (current_version == 0) {
+                // Initialize database
+                Sqlite3Statement(m_db, L""
+                    "CREATE TABLE IF NOT EXISTS streams("
+                    "stream_key TEXT UNIQUE PRIMARY KEY NOT NULL,"
+                    "size INTEGER NOT NULL,"
+                    "cached_size INTEGER NOT NULL,"
+                    "last_access_ts INTEGER NOT NULL);"
+                ).step();
+                Sqlite3Statement(m_db, L""
+                    "CREATE TABLE IF NOT EXISTS chunks("
+                    "stream_key TEXT NOT NULL,"
+                    "start_pos INTEGER NOT NULL,"
+                    "end_pos INTEGER NOT NULL,"
+                    "file_offset INTEGER NOT NULL,"
+                    "PRIMARY KEY(stream_key, start_pos));"
+                ).step();
+                Sqlite3Statement(m_db, L"PRAGMA user_version = 1;").step();
+            }
+            else if (current_version == 1) {
+                // Database is up-to-date
+            }
+            else {
+                throw winrt::hresult_error(E_FAIL, L"MediaCache: Unrecognized database version");
+            }
+        }
+
+        static uint64_t get_cur_ts(void) {
+            return static_cast<uint64_t>(std::chrono::floor<std::chrono::seconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+        }
+        static void check_key(winrt::hstring const& key) {
+            // NOTE: Keys are used as file names directly
+            auto is_valid_ch = [](wchar_t ch) {
+                return (L'0' <= ch && ch <= L'9') || (L'a' <= ch && ch <= L'z') ||
+                    (L'A' <= ch && ch <= L'Z') || ch == L'_' || ch == L'-';
+            };
+            if (key.empty() || !std::all_of(key.begin(), key.end(), is_valid_ch)) {
+                throw winrt::hresult_invalid_argument(L"MediaCache: Invalid stream key");
+            }
+        }
+        std::wstring data_file_path(winrt::hstring const& key) {
+            return std::format(L"{}{}.bin", m_cache_dir_path, key);
+        }
+        static winrt::file_handle open_data_file(std::wstring const& path, DWORD creation_disposition) {
+            // NOTE: FILE_SHARE_DELETE allows evicting streams which are still being read
+            winrt::file_handle hfile{ CreateFile2FromAppW(
+                path.c_str(),
+                GENERIC_READ | GENERIC_WRITE,
+                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                creation_disposition,
+                nullptr
+            ) };
+            if (!hfile) { winrt::throw_last_error(); }
+            return hfile;
+        }
+
+        // Returns nullptr if create is false and the stream is not cached with the given size
+        // NOTE: Without create, nothing is added or discarded; changed streams are only
+        //       replaced once new data is written to them
+        std::shared_ptr<StreamEntry> open_entry(winrt::hstring const& key, uint64_t size, bool create) {
+            std::scoped_lock guard(m_mutex);
+            if (auto it = m_entries.find(key); it != m_entries.end()) {
+                if (it->second->size == size) { return it->second; }
+                if (!create) { return nullptr; }
+                remove_stream_nolock(key);
+            }
+            check_key(key);
+            std::optional<uint64_t> stored_size, stored_cached_size;
+            {
+                Sqlite3Statement db_stmt(m_stmt_pool,
+                    L"SELECT size, cached_size FROM streams WHERE stream_key = ?;");
+                db_stmt.bind(1, key, false);
+                if (db_stmt.step()) {
+                    stored_size = static_cast<uint64_t>(db_stmt.col_i64(0));
+                    stored_cached_size = static_cast<uint64_t>(db_stmt.col_i64(1));
+                }
+            }
+            if (!create && stored_size != size) { return nullptr; }
+            if (stored_size && *stored_size != size) {
+                util::debug::log_debug(L"MediaCache: Discarding changed stream `{}`", key);
+                remove_stream_nolock(key);
+                stored_size = std::nullopt;
+            }
+            auto entry = std::make_shared<StreamEntry>();
+            entry->size = size;
+            auto path = data_file_path(key);
+            auto cur_ts = get_cur_ts();
+            entry->last_access_ts = cur_ts;
+            if (stored_size) {
+                entry->hfile = open_data_file(path, OPEN_ALWAYS);
+                LARGE_INTEGER li;
+                winrt::check_bool(GetFileSizeEx(entry->hfile.get(), &li));
+                entry->file_size = static_cast<uint64_t>(li.QuadPart);
+                Sqlite3Statement db_stmt(m_stmt_pool, L"SELECT start_pos, end_pos, file_offset "
+                    "FROM chunks WHERE stream_key = ?;");
+                db_stmt.bind(1, key, false);
+                while (db_stmt.step()) {
+                    auto start = static_cast<uint64_t>(db_stmt.col_i64(0));
+                    auto end = static_cast<uint64_t>(db_stmt.col_i64(1));
+                    auto file_offset = static_cast<uint64_t>(db_stmt.col_i64(2));
+                    // NOTE: Data may be missing if the file was tampered with
+                    if (start >= end || end > size || file_offset + (end - start) > entry->file_size) {
+                        continue;
+                    }
+                    entry->chunks.emplace(start, Chunk{ .end = end, .file_offset = file_offset });
+                }
+                // NOTE: Bytes written without a matching index record (e.g. due to a crash)
+                //       still occupy disk space, so account them as well
+                Sqlite3Statement db_stmt_update(m_stmt_pool,
+                    L"UPDATE streams SET cached_size = ?, last_access_ts = ? WHERE stream_key = ?;");
+                db_stmt_update.bind(1, static_cast<int64_t>(entry->file_size));
+                db_stmt_update.bind(2, static_cast<int64_t>(cur_ts));
+                db_stmt_update.bind(3, key, false);
+                db_stmt_update.step();
+                m_total_size = m_total_size - std::min(m_total_size, *stored_cached_size) + entry->file_size;
+            }
+            else {
+                entry->hfile = open_data_file(path, CREATE_ALWAYS);
+                entry->file_size = 0;
+                Sqlite3Statement db_stmt(m_stmt_pool, L"INSERT INTO streams"
+                    "(stream_key, size, cached_size, last_access_ts) VALUES(?, ?, 0, ?);");
+                db_stmt.bind(1, key, false);
+                db_stmt.bind(2, static_cast<int64_t>(size));
+                db_stmt.bind(3, static_cast<int64_t>(cur_ts));
+                db_stmt.step();
+            }
+            m_entries.emplace(key, entry);
+            if (!m_idle_sweeper_running) {
+                m_idle_sweeper_running = true;
+                // SAFETY: run_idle_sweeper resumes in background before touching entries
+                m_idle_sweeper = run_idle_sweeper();
+            }
+            return entry;
+        }
+        // WARN: Caller must hold m_mutex
+        void remove_stream_nolock(winrt::hstring const& key) {
+            if (auto it = m_entries.find(key); it != m_entries.end()) {
+                it->second->evicted = true;
+                m_entries.erase(it);
+            }
+            uint64_t cached_size = 0;
+            {
+                Sqlite3Statement db_stmt(m_stmt_pool, L"SELECT cached_size FROM streams WHERE stream_key = ?;");
+                db_stmt.bind(1, key, false);
+                if (db_stmt.step()) {
+                    cached_size = static_cast<uint64_t>(db_stmt.col_i64(0));
+                }
+            }
+            {
+                Sqlite3Statement db_stmt(m_stmt_pool, L"DELETE FROM chunks WHERE stream_key = ?;");
+                db_stmt.bind(1, key, false);
+                db_stmt.step();
+            }
+            {
+                Sqlite3Statement db_stmt(m_stmt_pool, L"DELETE FROM streams WHERE stream_key = ?;");
+                db_stmt.bind(1, key, false);
+                db_stmt.step();
+            }
+            m_total_size -= std::min(m_total_size, cached_size);
+            discard_data_file(key);
+        }
+        // NOTE: Readers may still have the data file open, in which case the deletion stays
+        //       pending and keeps the name taken. Move the file out of the way first, so
+        //       that a new data file can be created for the same key right away.
+        void discard_data_file(winrt::hstring const& key) {
+            auto path = data_file_path(key);
+            auto discarded_path = std::format(L"{}.{}.del", path,
+                util::winrt::to_wstring(util::winrt::gen_random_guid()));
+            auto const& target_path = util::fs::rename_path(path.c_str(), discarded_path.c_str()) ?
+                discarded_path : path;
+            if (!util::fs::delete_file_if_exists(target_path.c_str())) {
+                util::debug::log_warn(L"MediaCache: Cannot remove data file of `{}`", key);
+            }
+        }
+        // WARN: Caller must hold m_mutex
+        void evict_nolock(winrt::hstring const& keep_key) {
+            while (m_total_size > m_capacity) {
+                winrt::hstring victim_key;
+                {
+                    Sqlite3Statement db_stmt(m_stmt_pool, L"SELECT stream_key FROM streams "
+                        "WHERE stream_key != ? ORDER BY last_access_ts ASC LIMIT 1;");
+                    db_stmt.bind(1, keep_key, false);
+                    if (!db_stmt.step()) { break; }
+                    victim_key = db_stmt.col_str16(0);
+                }
+                util::debug::log_debug(L"MediaCache: Evicting stream `{}`", victim_key);
+                remove_stream_nolock(victim_key);
+            }
+        }
+
+        StorageFolder m_root;
+        winrt::hstring m_name;
+        std::wstring m_cache_dir_path;
+        // NOTE: Guards the database, m_entries and the size counters
+        std::mutex m_mutex;
+        std::mutex m_mutex_pending_writes;
+        std::vector<PendingWrite> m_pending_writes;
+        uint64_t m_pending_writes_size = 0;
+        // Streams whose access time is to be updated
+        std::set<winrt::hstring> m_pending_touches;
+        bool m_writer_scheduled = false;
+        util::winrt::task<> m_writer;
+        // NOTE: Serializes flush_pending_writes
+        std::mutex m_mutex_flush;
+        // NOTE: Evicted and idle streams are dropped, closing their data files once
+        //       no reader uses them any more
+        std::map<winrt::hstring, std::shared_ptr<StreamEntry>> m_entries;
+        bool m_idle_sweeper_running = false;
+        util::winrt::task<> m_idle_sweeper;
+        uint64_t m_capacity;
+        uint64_t m_total_size;
+        sqlite3* m_db;
+        Sqlite3StatementPool m_stmt_pool;
+    };
+
+    util::winrt::task<MediaCache> MediaCache::create_async(
+        StorageFolder const& root,
+        winrt::hstring const& name,
+        uint64_t capacity
+    ) {
+        MediaCache result = nullptr;
+        result.m_impl = std::make_shared<details::MediaCacheImpl>(root, name, capacity);
+        co_await result.m_impl->init_async();
+        co_return result;
+    }
+    winrt::hstring MediaCache::make_stream_key(uint64_t cid, uint64_t quality, uint64_t codec) {
+        return winrt::hstring(std::format(L"{}_{}_{}", cid, quality, codec));
+    }
+    std::optional<std::pair<uint64_t, uint64_t>> MediaCache::first_missing_range(
+        winrt::hstring const& key, uint64_t size, uint64_t start, uint64_t end
+    ) const {
+        return m_impl->first_missing_range(key, size, start, end);
+    }
+    bool MediaCache::read(winrt::hstring const& key, uint64_t size, uint64_t pos, void* buf, size_t count) const {
+        return m_impl->read(key, size, pos, buf, count);
+    }
+    void MediaCache::write(
+        winrt::hstring const& key, uint64_t size, uint64_t pos, const void* buf, size_t count
+    ) const {
+        m_impl->write(key, size, pos, buf, count);
+    }
+    uint64_t MediaCache::total_size(void) const {
+        return m_impl->total_size();
+    }
+    uint64_t MediaCache::capacity(void) const {
+        return m_impl->capacity();
+    }
+    void MediaCache::capacity(uint64_t value) const {
+        m_impl->capacity(value);
+    }
+    util::winrt::task<> MediaCache::clear_async(void) const {
+        return m_impl->clear_async();
+    }
+
+    // NOTE: Initialized in background while streams may already be querying it
+    static std::mutex media_cache_mutex;
+    static MediaCache media_cache = nullptr;
+    util::winrt::task<> init_media_cache_async() {
+        static util::winrt::mutex s_mutex;
+        co_await s_mutex.lock_async();
+        deferred([] { s_mutex.unlock(); });
+        if (!get_media_cache()) {
+            auto cache = co_await MediaCache::create_async(
+                ApplicationData::Current().LocalCacheFolder(),
+                L"MediaCache",
+                MEDIA_CACHE_CAPACITY
+            );
+            std::scoped_lock guard(media_cache_mutex);
+            media_cache = cache;
+        }
+    }
+    MediaCache get_media_cache() {
+        std::scoped_lock guard(media_cache_mutex);
+        return media_cache;
+    }
+}
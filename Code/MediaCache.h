@@ -0,0 +1,47 @@
+#pragma once
+
+#include "util.hpp"
+
+namespace BiliUWP {
+    namespace details { struct MediaCacheImpl; }
+    // Persistent cache for (partially) downloaded media streams, so that replaying
+    // a video does not hit the network again
+    // NOTE: Streams are identified by a stable key rather than by uri, as media uris
+    //       expire quickly. Each stream is stored as an append-only data file plus a
+    //       chunk index in the database, so sparse ranges never occupy extra disk space.
+    // NOTE: Whole streams are evicted in LRU order when the capacity is exceeded
+    struct MediaCache {
+        MediaCache(std::nullptr_t) : m_impl(nullptr) {}
+        ~MediaCache() {}
+        static util::winrt::task<MediaCache> create_async(
+            winrt::Windows::Storage::StorageFolder const& root,
+            winrt::hstring const& name,
+            uint64_t capacity
+        );
+        static winrt::hstring make_stream_key(uint64_t cid, uint64_t quality, uint64_t codec);
+
+        // NOTE: For all methods below, `size` is the total size of the stream; cached data
+        //       is discarded if it does not match (i.e. the content has changed)
+        // Returns the first range within [start, end) that is not cached
+        std::optional<std::pair<uint64_t, uint64_t>> first_missing_range(
+            winrt::hstring const& key, uint64_t size, uint64_t start, uint64_t end
+        ) const;
+        // Returns false if [pos, pos + count) is not fully cached
+        bool read(winrt::hstring const& key, uint64_t size, uint64_t pos, void* buf, size_t count) const;
+        // NOTE: Already cached parts are skipped. Data is copied and committed in the
+        //       background, and may be dropped if the writer falls behind.
+        void write(winrt::hstring const& key, uint64_t size, uint64_t pos, const void* buf, size_t count) const;
+        uint64_t total_size(void) const;
+        uint64_t capacity(void) const;
+        void capacity(uint64_t value) const;
+        util::winrt::task<> clear_async(void) const;
+
+        operator bool() const { return static_cast<bool>(m_impl); }
+        bool operator==(std::nullptr_t) const { return m_impl == nullptr; }
+    private:
+        std::shared_ptr<details::MediaCacheImpl> m_impl;
+    };
+
+    util::winrt::task<> init_media_cache_async();
+    MediaCache get_media_cache();
+}
@@ -1,10 +1,540 @@
 #include "pch.h"
 
 #include "json.h"
+#include <bit>
+#include <charconv>
+#include <cmath>
+
+#if defined(_M_X64) || (defined(_M_IX86) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#include <emmintrin.h>
+#define JSON_SCAN_USE_SSE2
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#include <arm_neon.h>
+#define JSON_SCAN_USE_NEON
+#endif
 
 using namespace winrt;
 
 namespace json {
+    namespace {
+        // Deeper documents are rejected instead of exhausting the stack
+        constexpr size_t MAX_NESTING_DEPTH = 512;
+
+        struct Utf8Cursor {
+            const char* p;
+            const char* end;
+
+            bool at_end(void) const noexcept { return p == end; }
+            char peek(void) const noexcept { return p != end ? *p : '\0'; }
+            void skip_whitespace(void) noexcept {
+                while (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) { p++; }
+            }
+            bool consume(char c) noexcept {
+                if (peek() != c) { return false; }
+                p++;
+                return true;
+            }
+            bool consume_literal(std::string_view sv) noexcept {
+                if (static_cast<size_t>(end - p) < sv.size() || std::string_view(p, sv.size()) != sv) {
+                    return false;
+                }
+                p += sv.size();
+                return true;
+            }
+        };
+
+        bool is_digit(char c) noexcept { return c >= '0' && c <= '9'; }
+        // Bytes which end a plain ASCII run inside a string
+        bool is_string_special(char c) noexcept {
+            auto u = static_cast<unsigned char>(c);
+            return u == '"' || u == '\\' || u < 0x20 || u >= 0x80;
+        }
+        // Returns the first special byte in [p, end), or end if there is none
+        const char* find_string_special(const char* p, const char* end) noexcept {
+#if defined(JSON_SCAN_USE_SSE2)
+            const auto v_quote = _mm_set1_epi8('"');
+            const auto v_backslash = _mm_set1_epi8('\\');
+            // NOTE: Signed comparison catches both control characters and non-ASCII bytes
+            const auto v_space = _mm_set1_epi8(0x20);
+            while (end - p >= 16) {
+                auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                auto v_special = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(v, v_quote), _mm_cmpeq_epi8(v, v_backslash)),
+                    _mm_cmplt_epi8(v, v_space)
+                );
+                auto mask = static_cast<uint32_t>(_mm_movemask_epi8(v_special));
+                if (mask != 0) { return p + std::countr_zero(mask); }
+                p += 16;
+            }
+#elif defined(JSON_SCAN_USE_NEON)
+            const auto v_quote = vdupq_n_u8('"');
+            const auto v_backslash = vdupq_n_u8('\\');
+            const auto v_space = vdupq_n_s8(0x20);
+            while (end - p >= 16) {
+                auto v = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+                auto v_special = vorrq_u8(
+                    vorrq_u8(vceqq_u8(v, v_quote), vceqq_u8(v, v_backslash)),
+                    vcltq_s8(vreinterpretq_s8_u8(v), v_space)
+                );
+                // NOTE: The exact position is left to the scalar loop below
+                if (vmaxvq_u8(v_special) != 0) { break; }
+                p += 16;
+            }
+#endif
+            while (p != end && !is_string_special(*p)) { p++; }
+            return p;
+        }
+        // Same as find_string_special, but non-ASCII bytes are skipped over, since
+        // validating strings does not require decoding them
+        const char* find_string_end(const char* p, const char* end) noexcept {
+#if defined(JSON_SCAN_USE_SSE2)
+            const auto v_quote = _mm_set1_epi8('"');
+            const auto v_backslash = _mm_set1_epi8('\\');
+            const auto v_control_max = _mm_set1_epi8(0x1f);
+            while (end - p >= 16) {
+                auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                auto v_special = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(v, v_quote), _mm_cmpeq_epi8(v, v_backslash)),
+                    _mm_cmpeq_epi8(_mm_min_epu8(v, v_control_max), v)
+                );
+                auto mask = static_cast<uint32_t>(_mm_movemask_epi8(v_special));
+                if (mask != 0) { return p + std::countr_zero(mask); }
+                p += 16;
+            }
+#elif defined(JSON_SCAN_USE_NEON)
+            const auto v_quote = vdupq_n_u8('"');
+            const auto v_backslash = vdupq_n_u8('\\');
+            const auto v_space = vdupq_n_u8(0x20);
+            while (end - p >= 16) {
+                auto v = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+                auto v_special = vorrq_u8(
+                    vorrq_u8(vceqq_u8(v, v_quote), vceqq_u8(v, v_backslash)),
+                    vcltq_u8(v, v_space)
+                );
+                if (vmaxvq_u8(v_special) != 0) { break; }
+                p += 16;
+            }
+#endif
+            while (p != end) {
+                auto u = static_cast<unsigned char>(*p);
+                if (u == '"' || u == '\\' || u < 0x20) { break; }
+                p++;
+            }
+            return p;
+        }
+
+        void append_utf16(std::wstring& out, uint32_t cp) {
+            if (cp < 0x10000) {
+                out.push_back(static_cast<wchar_t>(cp));
+            }
+            else {
+                cp -= 0x10000;
+                out.push_back(static_cast<wchar_t>(0xd800 + (cp >> 10)));
+                out.push_back(static_cast<wchar_t>(0xdc00 + (cp & 0x3ff)));
+            }
+        }
+        // Decodes a non-ASCII character; invalid sequences become U+FFFD
+        void decode_utf8_char(Utf8Cursor& cur, std::wstring& out) {
+            auto lead = static_cast<unsigned char>(*cur.p);
+            size_t len;
+            uint32_t cp, min_cp;
+            if (lead >= 0xc2 && lead <= 0xdf) { len = 2; cp = lead & 0x1f; min_cp = 0x80; }
+            else if (lead >= 0xe0 && lead <= 0xef) { len = 3; cp = lead & 0x0f; min_cp = 0x800; }
+            else if (lead >= 0xf0 && lead <= 0xf4) { len = 4; cp = lead & 0x07; min_cp = 0x10000; }
+            else { len = 0; cp = 0; min_cp = 0; }
+            bool valid = len != 0 && static_cast<size_t>(cur.end - cur.p) >= len;
+            for (size_t i = 1; valid && i < len; i++) {
+                auto c = static_cast<unsigned char>(cur.p[i]);
+                if ((c & 0xc0) != 0x80) { valid = false; break; }
+                cp = (cp << 6) | (c & 0x3f);
+            }
+            if (valid && (cp < min_cp || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff))) {
+                valid = false;
+            }
+            if (!valid) {
+                out.push_back(L'\xfffd');
+                cur.p++;
+                return;
+            }
+            append_utf16(out, cp);
+            cur.p += len;
+        }
+        // Decodes UTF-8 without any escape sequences
+        void decode_utf8(std::string_view str, std::wstring& out) {
+            Utf8Cursor cur{ str.data(), str.data() + str.size() };
+            out.reserve(out.size() + str.size());
+            while (!cur.at_end()) {
+                if (static_cast<unsigned char>(*cur.p) < 0x80) { out.push_back(*cur.p++); }
+                else { decode_utf8_char(cur, out); }
+            }
+        }
+        bool parse_hex4(Utf8Cursor& cur, uint32_t& out) noexcept {
+            if (cur.end - cur.p < 4) { return false; }
+            out = 0;
+            for (size_t i = 0; i < 4; i++) {
+                char c = *cur.p++;
+                uint32_t digit;
+                if (c >= '0' && c <= '9') { digit = c - '0'; }
+                else if (c >= 'a' && c <= 'f') { digit = c - 'a' + 10; }
+                else if (c >= 'A' && c <= 'F') { digit = c - 'A' + 10; }
+                else { return false; }
+                out = (out << 4) | digit;
+            }
+            return true;
+        }
+        // NOTE: Cursor must be at the opening quote
+        bool parse_string(Utf8Cursor& cur, std::wstring& out) {
+            cur.p++;
+            out.clear();
+            while (true) {
+                auto run_end = find_string_special(cur.p, cur.end);
+                out.append(cur.p, run_end);
+                cur.p = run_end;
+                if (cur.at_end()) { return false; }
+                auto c = static_cast<unsigned char>(*cur.p);
+                if (c == '"') {
+                    cur.p++;
+                    return true;
+                }
+                if (c < 0x20) { return false; }
+                if (c >= 0x80) {
+                    decode_utf8_char(cur, out);
+                    continue;
+                }
+                // Escape sequence
+                cur.p++;
+                if (cur.at_end()) { return false; }
+                switch (*cur.p++) {
+                case '"':   out.push_back(L'"');    break;
+                case '\\':  out.push_back(L'\\');   break;
+                case '/':   out.push_back(L'/');    break;
+                case 'b':   out.push_back(L'\b');   break;
+                case 'f':   out.push_back(L'\f');   break;
+                case 'n':   out.push_back(L'\n');   break;
+                case 'r':   out.push_back(L'\r');   break;
+                case 't':   out.push_back(L'\t');   break;
+                case 'u': {
+                    // NOTE: Output is UTF-16, so surrogates can be copied as they are
+                    uint32_t code_unit;
+                    if (!parse_hex4(cur, code_unit)) { return false; }
+                    out.push_back(static_cast<wchar_t>(code_unit));
+                    break;
+                }
+                default:
+                    return false;
+                }
+            }
+        }
+        using NumberRepr = std::variant<int64_t, uint64_t, double>;
+        bool parse_number(Utf8Cursor& cur, NumberRepr& out) {
+            auto start = cur.p;
+            bool negative = cur.consume('-');
+            auto int_start = cur.p;
+            if (!cur.consume('0')) {
+                if (!is_digit(cur.peek())) { return false; }
+                while (is_digit(cur.peek())) { cur.p++; }
+            }
+            auto int_end = cur.p;
+            bool integral = true;
+            if (cur.consume('.')) {
+                integral = false;
+                if (!is_digit(cur.peek())) { return false; }
+                while (is_digit(cur.peek())) { cur.p++; }
+            }
+            if (cur.peek() == 'e' || cur.peek() == 'E') {
+                integral = false;
+                cur.p++;
+                if (!cur.consume('+')) { cur.consume('-'); }
+                if (!is_digit(cur.peek())) { return false; }
+                while (is_digit(cur.peek())) { cur.p++; }
+            }
+            if (integral) {
+                // NOTE: Integers are parsed exactly, unless they do not fit into 64 bits
+                uint64_t magnitude;
+                auto [ptr, ec] = std::from_chars(int_start, int_end, magnitude);
+                if (ec == std::errc{}) {
+                    constexpr auto int64_max = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+                    if (!negative) {
+                        if (magnitude <= int64_max) { out = static_cast<int64_t>(magnitude); }
+                        else { out = magnitude; }
+                        return true;
+                    }
+                    if (magnitude <= int64_max + 1) {
+                        out = static_cast<int64_t>(0 - magnitude);
+                        return true;
+                    }
+                }
+            }
+            double value;
+            auto [ptr, ec] = std::from_chars(start, cur.p, value);
+            if (ec == std::errc::result_out_of_range) {
+                // Let strtod decide between infinity and zero
+                value = std::strtod(std::string(start, cur.p).c_str(), nullptr);
+            }
+            else if (ec != std::errc{}) { return false; }
+            out = value;
+            return true;
+        }
+
+        void append_str(std::vector<char>& out, std::string_view sv) {
+            out.insert(out.end(), sv.begin(), sv.end());
+        }
+        // Returns the code point starting at str[i], advancing i past surrogate pairs
+        uint32_t next_code_point(std::wstring_view str, size_t& i) noexcept {
+            uint32_t c = str[i];
+            if (c >= 0xd800 && c <= 0xdbff && i + 1 < str.size() &&
+                str[i + 1] >= 0xdc00 && str[i + 1] <= 0xdfff)
+            {
+                c = 0x10000 + ((c - 0xd800) << 10) + (str[i + 1] - 0xdc00);
+                i++;
+            }
+            else if (c >= 0xd800 && c <= 0xdfff) {
+                // Unpaired surrogate
+                c = 0xfffd;
+            }
+            return c;
+        }
+        void append_utf8(std::vector<char>& out, uint32_t c) {
+            if (c < 0x80) {
+                out.push_back(static_cast<char>(c));
+                return;
+            }
+            if (c < 0x800) {
+                out.push_back(static_cast<char>(0xc0 | (c >> 6)));
+            }
+            else if (c < 0x10000) {
+                out.push_back(static_cast<char>(0xe0 | (c >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3f)));
+            }
+            else {
+                out.push_back(static_cast<char>(0xf0 | (c >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3f)));
+                out.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3f)));
+            }
+            out.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+        }
+        void write_string(std::vector<char>& out, std::wstring_view str) {
+            constexpr char hex_digits[] = "0123456789abcdef";
+            out.push_back('"');
+            for (size_t i = 0; i < str.size(); i++) {
+                uint32_t c = str[i];
+                if (c < 0x80) {
+                    switch (c) {
+                    case '"':   append_str(out, "\\\"");    break;
+                    case '\\':  append_str(out, "\\\\");    break;
+                    case '\b':  append_str(out, "\\b");     break;
+                    case '\f':  append_str(out, "\\f");     break;
+                    case '\n':  append_str(out, "\\n");     break;
+                    case '\r':  append_str(out, "\\r");     break;
+                    case '\t':  append_str(out, "\\t");     break;
+                    default:
+                        if (c < 0x20) {
+                            append_str(out, "\\u00");
+                            out.push_back(hex_digits[c >> 4]);
+                            out.push_back(hex_digits[c & 0xf]);
+                        }
+                        else {
+                            out.push_back(static_cast<char>(c));
+                        }
+                        break;
+                    }
+                    continue;
+                }
+                append_utf8(out, next_code_point(str, i));
+            }
+            out.push_back('"');
+        }
+
+        // Parser for JsonDocument; containers are collected on scratch stacks, then
+        // copied into the arena as flat arrays once they are closed
+        class JsonLazyParser {
+        public:
+            using Node = details::JsonLazyNode;
+            using Member = details::JsonLazyMember;
+
+            JsonLazyParser(details::JsonArena& arena) : m_arena(arena) {}
+
+            bool parse_value(Utf8Cursor& cur, Node& out, size_t depth) {
+                cur.skip_whitespace();
+                out.flags = 0;
+                out.size = 0;
+                switch (cur.peek()) {
+                case '{':
+                    if (depth >= MAX_NESTING_DEPTH) { return false; }
+                    return parse_object(cur, out, depth + 1);
+                case '[':
+                    if (depth >= MAX_NESTING_DEPTH) { return false; }
+                    return parse_array(cur, out, depth + 1);
+                case '"':
+                    return scan_string(cur, out);
+                case 't':
+                    if (!cur.consume_literal("true")) { return false; }
+                    out.kind = JsonValueKind::Boolean;
+                    out.boolean = true;
+                    return true;
+                case 'f':
+                    if (!cur.consume_literal("false")) { return false; }
+                    out.kind = JsonValueKind::Boolean;
+                    out.boolean = false;
+                    return true;
+                case 'n':
+                    if (!cur.consume_literal("null")) { return false; }
+                    out.kind = JsonValueKind::Null;
+                    return true;
+                default: {
+                    NumberRepr number;
+                    if (!parse_number(cur, number)) { return false; }
+                    out.kind = JsonValueKind::Number;
+                    if (auto p = std::get_if<int64_t>(&number)) {
+                        out.flags = Node::NUMBER_INT64;
+                        out.i64 = *p;
+                    }
+                    else if (auto p = std::get_if<uint64_t>(&number)) {
+                        out.flags = Node::NUMBER_UINT64;
+                        out.u64 = *p;
+                    }
+                    else {
+                        out.flags = Node::NUMBER_DOUBLE;
+                        out.f64 = std::get<double>(number);
+                    }
+                    return true;
+                }
+                }
+            }
+
+        private:
+            // Validates the string, leaving decoding to the time it is read
+            // NOTE: Cursor must be at the opening quote
+            bool scan_string(Utf8Cursor& cur, Node& out) {
+                auto start = ++cur.p;
+                uint8_t flags = 0;
+                while (true) {
+                    cur.p = find_string_end(cur.p, cur.end);
+                    if (cur.at_end()) { return false; }
+                    auto c = static_cast<unsigned char>(*cur.p);
+                    if (c == '"') { break; }
+                    if (c < 0x20) { return false; }
+                    // Escape sequence
+                    flags = Node::STRING_NEEDS_DECODING;
+                    cur.p++;
+                    if (cur.at_end()) { return false; }
+                    switch (*cur.p++) {
+                    case '"': case '\\': case '/':
+                    case 'b': case 'f': case 'n': case 'r': case 't':
+                        break;
+                    case 'u': {
+                        uint32_t code_unit;
+                        if (!parse_hex4(cur, code_unit)) { return false; }
+                        break;
+                    }
+                    default:
+                        return false;
+                    }
+                }
+                if (flags == 0) {
+                    // Plain ASCII strings can be widened without decoding
+                    for (auto p = start; p != cur.p; p++) {
+                        if (static_cast<unsigned char>(*p) >= 0x80) {
+                            flags = Node::STRING_NEEDS_DECODING;
+                            break;
+                        }
+                    }
+                }
+                out.kind = JsonValueKind::String;
+                out.flags = flags;
+                out.size = static_cast<uint32_t>(cur.p - start);
+                out.str = start;
+                cur.p++;
+                return true;
+            }
+            bool parse_array(Utf8Cursor& cur, Node& out, size_t depth) {
+                cur.p++;
+                auto base = m_items.size();
+                cur.skip_whitespace();
+                if (!cur.consume(']')) {
+                    while (true) {
+                        Node item;
+                        if (!parse_value(cur, item, depth)) { return false; }
+                        m_items.push_back(item);
+                        cur.skip_whitespace();
+                        if (cur.consume(',')) { continue; }
+                        if (cur.consume(']')) { break; }
+                        return false;
+                    }
+                }
+                auto count = m_items.size() - base;
+                auto items = m_arena.allocate<Node>(count);
+                std::copy(m_items.begin() + base, m_items.end(), items);
+                m_items.resize(base);
+                out.kind = JsonValueKind::Array;
+                out.size = static_cast<uint32_t>(count);
+                out.items = items;
+                return true;
+            }
+            bool parse_object(Utf8Cursor& cur, Node& out, size_t depth) {
+                cur.p++;
+                auto base = m_members.size();
+                cur.skip_whitespace();
+                if (!cur.consume('}')) {
+                    while (true) {
+                        cur.skip_whitespace();
+                        Node key;
+                        if (cur.peek() != '"' || !scan_string(cur, key)) { return false; }
+                        cur.skip_whitespace();
+                        if (!cur.consume(':')) { return false; }
+                        Member member;
+                        if (!parse_value(cur, member.value, depth)) { return false; }
+                        member.key = key_from_node(key);
+                        m_members.push_back(member);
+                        cur.skip_whitespace();
+                        if (cur.consume(',')) { continue; }
+                        if (cur.consume('}')) { break; }
+                        return false;
+                    }
+                }
+                auto first = m_members.begin() + base;
+                // NOTE: Later duplicate keys win, as with JsonObject
+                std::stable_sort(first, m_members.end(),
+                    [](Member const& a, Member const& b) { return a.key < b.key; }
+                );
+                auto last = first;
+                for (auto it = first; it != m_members.end(); it++) {
+                    if (it != first && (last - 1)->key == it->key) { *(last - 1) = *it; }
+                    else { *last++ = *it; }
+                }
+                auto count = static_cast<size_t>(last - first);
+                auto members = m_arena.allocate<Member>(count);
+                std::copy(first, last, members);
+                m_members.resize(base);
+                out.kind = JsonValueKind::Object;
+                out.size = static_cast<uint32_t>(count);
+                out.members = members;
+                return true;
+            }
+            // Keys are looked up frequently, so they are always stored unescaped
+            std::string_view key_from_node(Node const& key) {
+                if (key.flags == 0) { return { key.str, key.size }; }
+                std::wstring wstr;
+                Utf8Cursor key_cur{ key.str - 1, key.str + key.size + 1 };
+                parse_string(key_cur, wstr);
+                m_key_buf.clear();
+                for (size_t i = 0; i < wstr.size(); i++) {
+                    append_utf8(m_key_buf, next_code_point(wstr, i));
+                }
+                auto buf = m_arena.allocate<char>(m_key_buf.size());
+                std::copy(m_key_buf.begin(), m_key_buf.end(), buf);
+                return { buf, m_key_buf.size() };
+            }
+
+            details::JsonArena& m_arena;
+            std::vector<Node> m_items;
+            std::vector<Member> m_members;
+            std::vector<char> m_key_buf;
+        };
+
+        const details::JsonLazyNode null_lazy_node{ JsonValueKind::Null };
+    }
+
     class JsonHelper {
     public:
         static JsonArray value_from_winrt(Windows::Data::Json::JsonArray const& ja) {
@@ -56,37 +586,163 @@ namespace json {
             return result;
         }
 
-        static Windows::Data::Json::JsonArray value_into_winrt(JsonArray const& ja) {
-            Windows::Data::Json::JsonArray result;
-            for (auto& i : ja) {
-                result.Append(value_into_winrt(i));
+        static bool parse_value(Utf8Cursor& cur, JsonValue& out, size_t depth) {
+            cur.skip_whitespace();
+            switch (cur.peek()) {
+            case '{':
+                if (depth >= MAX_NESTING_DEPTH) { return false; }
+                return parse_object(cur, out, depth + 1);
+            case '[':
+                if (depth >= MAX_NESTING_DEPTH) { return false; }
+                return parse_array(cur, out, depth + 1);
+            case '"': {
+                std::wstring str;
+                if (!parse_string(cur, str)) { return false; }
+                out.set_value(std::move(str));
+                return true;
+            }
+            case 't':
+                if (!cur.consume_literal("true")) { return false; }
+                out.set_value(true);
+                return true;
+            case 'f':
+                if (!cur.consume_literal("false")) { return false; }
+                out.set_value(false);
+                return true;
+            case 'n':
+                if (!cur.consume_literal("null")) { return false; }
+                out.set_value(nullptr);
+                return true;
+            default: {
+                NumberRepr number;
+                if (!parse_number(cur, number)) { return false; }
+                std::visit([&](auto v) { out.set_value(v); }, number);
+                return true;
+            }
+            }
+        }
+        static bool parse_array(Utf8Cursor& cur, JsonValue& out, size_t depth) {
+            cur.p++;
+            JsonArray result;
+            cur.skip_whitespace();
+            if (!cur.consume(']')) {
+                while (true) {
+                    JsonValue item;
+                    if (!parse_value(cur, item, depth)) { return false; }
+                    result.m_vec.push_back(std::move(item));
+                    cur.skip_whitespace();
+                    if (cur.consume(',')) { continue; }
+                    if (cur.consume(']')) { break; }
+                    return false;
+                }
+            }
+            out.set_value(std::move(result));
+            return true;
+        }
+        static bool parse_object(Utf8Cursor& cur, JsonValue& out, size_t depth) {
+            cur.p++;
+            JsonObject result;
+            cur.skip_whitespace();
+            if (!cur.consume('}')) {
+                std::wstring key;
+                while (true) {
+                    cur.skip_whitespace();
+                    if (cur.peek() != '"' || !parse_string(cur, key)) { return false; }
+                    cur.skip_whitespace();
+                    if (!cur.consume(':')) { return false; }
+                    JsonValue item;
+                    if (!parse_value(cur, item, depth)) { return false; }
+                    // NOTE: Later duplicate keys win
+                    result.m_map.insert_or_assign(std::move(key), std::move(item));
+                    cur.skip_whitespace();
+                    if (cur.consume(',')) { continue; }
+                    if (cur.consume('}')) { break; }
+                    return false;
+                }
+            }
+            out.set_value(std::move(result));
+            return true;
+        }
+
+        static JsonArray materialize(JsonArrayView const& jav) {
+            JsonArray result;
+            result.m_vec.reserve(jav.size());
+            for (auto&& i : jav) {
+                result.m_vec.push_back(i.materialize());
             }
             return result;
         }
-        static Windows::Data::Json::JsonObject value_into_winrt(JsonObject const& jo) {
-            Windows::Data::Json::JsonObject result;
-            for (auto& i : jo) {
-                result.Insert(i.first, value_into_winrt(i.second));
+        static JsonObject materialize(JsonObjectView const& jov) {
+            JsonObject result;
+            std::wstring key;
+            for (auto&& [k, v] : jov) {
+                key.clear();
+                decode_utf8(k, key);
+                result.m_map.emplace(key, v.materialize());
             }
             return result;
         }
-        static Windows::Data::Json::IJsonValue value_into_winrt(JsonValue const& jv) {
+
+        static void write_value(std::vector<char>& out, JsonValue const& jv) {
             switch (jv.m_kind) {
             case JsonValueKind::Null:
-                return Windows::Data::Json::JsonValue::CreateNullValue();
+                append_str(out, "null");
+                break;
             case JsonValueKind::Boolean:
-                return Windows::Data::Json::JsonValue::CreateBooleanValue(std::get<bool>(jv.m_var));
-            case JsonValueKind::Array:
-                return value_into_winrt(std::get<JsonArray>(jv.m_var));
-            case JsonValueKind::Number:
-                return Windows::Data::Json::JsonValue::CreateNumberValue(std::get<double>(jv.m_var));
+                append_str(out, std::get<bool>(jv.m_var) ? "true" : "false");
+                break;
+            case JsonValueKind::Array: {
+                out.push_back('[');
+                bool first = true;
+                for (auto& i : std::get<JsonArray>(jv.m_var)) {
+                    if (!first) { out.push_back(','); }
+                    first = false;
+                    write_value(out, i);
+                }
+                out.push_back(']');
+                break;
+            }
+            case JsonValueKind::Number: {
+                char buf[32];
+                std::to_chars_result result;
+                if (auto p = std::get_if<int64_t>(&jv.m_var)) {
+                    result = std::to_chars(std::begin(buf), std::end(buf), *p);
+                }
+                else if (auto p = std::get_if<uint64_t>(&jv.m_var)) {
+                    result = std::to_chars(std::begin(buf), std::end(buf), *p);
+                }
+                else {
+                    auto value = std::get<double>(jv.m_var);
+                    // NOTE: JSON cannot represent NaN or infinity
+                    if (!std::isfinite(value)) {
+                        append_str(out, "null");
+                        break;
+                    }
+                    result = std::to_chars(std::begin(buf), std::end(buf), value);
+                }
+                append_str(out, std::string_view(buf, result.ptr));
+                break;
+            }
             case JsonValueKind::String:
-                return Windows::Data::Json::JsonValue::CreateStringValue(std::get<std::wstring>(jv.m_var));
-            case JsonValueKind::Object:
-                return value_into_winrt(std::get<JsonObject>(jv.m_var));
+                write_string(out, std::get<std::wstring>(jv.m_var));
+                break;
+            case JsonValueKind::Object: {
+                out.push_back('{');
+                bool first = true;
+                for (auto& i : std::get<JsonObject>(jv.m_var)) {
+                    if (!first) { out.push_back(','); }
+                    first = false;
+                    write_string(out, i.first);
+                    out.push_back(':');
+                    write_value(out, i.second);
+                }
+                out.push_back('}');
+                break;
+            }
             default:
                 // Should be UNREACHABLE
-                return Windows::Data::Json::JsonValue::CreateNullValue();
+                append_str(out, "null");
+                break;
             }
         }
     };
@@ -113,32 +769,271 @@ namespace json {
         swap(a.m_map, b.m_map);
     }
 
-    bool JsonValue::try_deserialize_from_utf8(const char* data, size_t len) {
-        auto data_buf = Windows::Security::Cryptography::CryptographicBuffer::CreateFromByteArray(
-            { reinterpret_cast<const uint8_t*>(data), static_cast<uint32_t>(len) }
-        );
-        auto data_str = Windows::Security::Cryptography::CryptographicBuffer::ConvertBinaryToString(
-            Windows::Security::Cryptography::BinaryStringEncoding::Utf8,
-            data_buf
-        );
-        return this->try_deserialize_from_hstring(data_str);
-    }
-    bool JsonValue::try_deserialize_from_hstring(winrt::hstring const& str) {
-        auto json_value = Windows::Data::Json::JsonValue::CreateNullValue();
-        if (!Windows::Data::Json::JsonValue::TryParse(str, json_value)) {
-            return false;
+    bool JsonValue::operator==(JsonValue const& rhs) const {
+        if (m_kind != rhs.m_kind) { return false; }
+        if (m_kind == JsonValueKind::Number && m_var.index() != rhs.m_var.index()) {
+            // NOTE: Differently stored numbers are compared by value
+            return get_value<double>() == rhs.get_value<double>();
         }
-        JsonValue result = JsonHelper::value_from_winrt(json_value);
+        return m_var == rhs.m_var;
+    }
+    bool JsonValue::try_deserialize_from_utf8(const char* data, size_t len) {
+        Utf8Cursor cur{ data, data + len };
+        // Skip BOM
+        cur.consume_literal("\xef\xbb\xbf");
+        JsonValue result;
+        if (!JsonHelper::parse_value(cur, result, 0)) { return false; }
+        cur.skip_whitespace();
+        if (!cur.at_end()) { return false; }
         swap(*this, result);
         return true;
     }
+    bool JsonValue::try_deserialize_from_hstring(winrt::hstring const& str) {
+        auto data = winrt::to_string(str);
+        return this->try_deserialize_from_utf8(data.data(), data.size());
+    }
     std::vector<char> JsonValue::serialize_into_utf8(void) const {
-        auto data_buf = Windows::Security::Cryptography::CryptographicBuffer::ConvertStringToBinary(
-            JsonHelper::value_into_winrt(*this).Stringify(),
-            Windows::Security::Cryptography::BinaryStringEncoding::Utf8
+        std::vector<char> result;
+        JsonHelper::write_value(result, *this);
+        return result;
+    }
+
+    void* details::JsonArena::allocate_bytes(size_t size, size_t align) {
+        auto padding = (align - reinterpret_cast<uintptr_t>(m_cur) % align) % align;
+        if (m_left < size + padding) {
+            auto block_size = std::max(m_next_block_size, size + align);
+            m_blocks.push_back(std::make_unique_for_overwrite<std::byte[]>(block_size));
+            m_cur = m_blocks.back().get();
+            m_left = block_size;
+            m_next_block_size = std::max<size_t>(4096, block_size * 2);
+            padding = (align - reinterpret_cast<uintptr_t>(m_cur) % align) % align;
+        }
+        auto result = m_cur + padding;
+        m_cur = result + size;
+        m_left -= size + padding;
+        return result;
+    }
+
+    std::variant<int64_t, uint64_t, double> JsonValueView::get_number(void) const {
+        expect_kind(JsonValueKind::Number);
+        switch (m_node->flags) {
+        case details::JsonLazyNode::NUMBER_INT64:   return m_node->i64;
+        case details::JsonLazyNode::NUMBER_UINT64:  return m_node->u64;
+        default:                                    return m_node->f64;
+        }
+    }
+    JsonObjectView JsonValueView::get_object(void) const {
+        expect_kind(JsonValueKind::Object);
+        return { m_node->members, m_node->size };
+    }
+    JsonArrayView JsonValueView::get_array(void) const {
+        expect_kind(JsonValueKind::Array);
+        return { m_node->items, m_node->size };
+    }
+    std::wstring JsonValueView::decode_string(void) const {
+        expect_kind(JsonValueKind::String);
+        auto str = m_node->str;
+        if (!(m_node->flags & details::JsonLazyNode::STRING_NEEDS_DECODING)) {
+            return std::wstring(str, str + m_node->size);
+        }
+        // NOTE: The string has been validated while parsing
+        std::wstring result;
+        result.reserve(m_node->size);
+        Utf8Cursor cur{ str - 1, str + m_node->size + 1 };
+        parse_string(cur, result);
+        return result;
+    }
+    JsonValue JsonValueView::materialize(void) const {
+        switch (m_node->kind) {
+        case JsonValueKind::Boolean:    return JsonValue(m_node->boolean);
+        case JsonValueKind::Array:      return JsonValue(get_array().materialize());
+        case JsonValueKind::Number:
+            return std::visit([](auto v) { return JsonValue(v); }, get_number());
+        case JsonValueKind::String:     return JsonValue(decode_string());
+        case JsonValueKind::Object:     return JsonValue(get_object().materialize());
+        default:                        return JsonValue();
+        }
+    }
+
+    std::optional<JsonValueView> JsonObjectView::find(std::string_view key) const noexcept {
+        auto members_end = m_members + m_size;
+        auto it = std::lower_bound(m_members, members_end, key,
+            [](details::JsonLazyMember const& m, std::string_view key) { return m.key < key; }
         );
-        const char* data_ptr = reinterpret_cast<const char*>(data_buf.data());
-        return { data_ptr, data_ptr + data_buf.Length() };
+        if (it == members_end || it->key != key) { return std::nullopt; }
+        return JsonValueView{ &it->value };
+    }
+    JsonValueView JsonObjectView::at(std::string_view key) const {
+        auto result = find(key);
+        if (!result) { throw std::out_of_range("key does not exist in JsonObjectView"); }
+        return *result;
+    }
+    JsonObject JsonObjectView::materialize(void) const {
+        return JsonHelper::materialize(*this);
+    }
+
+    JsonValueView JsonArrayView::at(size_t idx) const {
+        if (idx >= m_size) { throw std::out_of_range("index out of bound in JsonArrayView"); }
+        return (*this)[idx];
+    }
+    JsonArray JsonArrayView::materialize(void) const {
+        return JsonHelper::materialize(*this);
+    }
+
+    bool JsonDocument::try_deserialize_from_utf8(const char* data, size_t len) {
+        // NOTE: Node sizes are 32-bit
+        if (len > std::numeric_limits<uint32_t>::max()) { return false; }
+        Utf8Cursor cur{ data, data + len };
+        // Skip BOM
+        cur.consume_literal("\xef\xbb\xbf");
+        details::JsonArena arena;
+        // Usually enough to hold all nodes in one block, while keeping small documents small
+        arena.reserve(len + sizeof(details::JsonLazyNode) * 2);
+        auto root = arena.allocate<details::JsonLazyNode>(1);
+        {
+            JsonLazyParser parser{ arena };
+            if (!parser.parse_value(cur, *root, 0)) { return false; }
+        }
+        cur.skip_whitespace();
+        if (!cur.at_end()) { return false; }
+        m_text = std::string_view(data, len);
+        m_arena = std::move(arena);
+        m_root = root;
+        return true;
+    }
+    bool JsonDocument::try_deserialize_from_utf8(std::vector<char> data) {
+        JsonDocument result;
+        if (!result.try_deserialize_from_utf8(data.data(), data.size())) { return false; }
+        // NOTE: Moving the vector keeps its storage, so views into it remain valid
+        result.m_owned_text = std::move(data);
+        *this = std::move(result);
+        return true;
+    }
+    JsonValueView JsonDocument::root(void) const {
+        return JsonValueView{ m_root ? m_root : &null_lazy_node };
+    }
+
+    void JsonArrayStreamSplitter::push_frame(bool is_object) {
+        bool prefix_matches = m_frames.size() <= m_path.size();
+        if (!m_frames.empty()) {
+            auto& parent = m_frames.back();
+            prefix_matches = prefix_matches && parent.prefix_matches && parent.key_matches;
+        }
+        m_frames.push_back({ is_object, is_object, prefix_matches, false });
+    }
+    bool JsonArrayStreamSplitter::next_item(std::string_view& item) {
+        if (m_item_ready) {
+            m_item.clear();
+            m_item_ready = false;
+        }
+        auto p = m_input.data();
+        auto end = p + m_input.size();
+        while (p != end && !m_item_ready) {
+            if (m_in_string) {
+                if (m_escaped) {
+                    m_escaped = false;
+                    if (m_in_key) { m_key.push_back(*p); }
+                    m_string_dest->push_back(*p++);
+                    continue;
+                }
+                auto run_end = find_string_end(p, end);
+                if (m_in_key) { m_key.append(p, run_end); }
+                m_string_dest->insert(m_string_dest->end(), p, run_end);
+                p = run_end;
+                if (p == end) { break; }
+                char c = *p++;
+                m_string_dest->push_back(c);
+                if (c == '\\') {
+                    m_escaped = true;
+                }
+                else if (c == '"') {
+                    m_in_string = false;
+                    if (m_in_key) {
+                        auto& frame = m_frames.back();
+                        frame.key_matches = m_key == m_path[m_frames.size() - 1];
+                        m_in_key = false;
+                    }
+                }
+                else if (m_in_key) {
+                    // Control characters are left for the parser to reject
+                    m_key.push_back(c);
+                }
+                continue;
+            }
+
+            char c = *p++;
+            // NOTE: Whitespace outside strings is dropped
+            if (c == ' ' || c == '\n' || c == '\r' || c == '\t') { continue; }
+            m_started = true;
+            bool at_target = m_target_depth != 0 && m_frames.size() == m_target_depth;
+            bool in_item = m_target_depth != 0 && m_frames.size() > m_target_depth;
+            auto& dest = (at_target || in_item) ? m_item : m_rest;
+            switch (c) {
+            case '{':
+            case '[':
+                dest.push_back(c);
+                push_frame(c == '{');
+                if (c == '[' && !at_target && !in_item &&
+                    m_frames.back().prefix_matches && m_frames.size() == m_path.size() + 1)
+                {
+                    m_target_depth = m_frames.size();
+                }
+                break;
+            case '}':
+            case ']':
+                if (at_target) {
+                    // End of the target array
+                    m_item_ready = !m_item.empty();
+                    m_target_depth = 0;
+                    m_rest.push_back(c);
+                }
+                else {
+                    dest.push_back(c);
+                }
+                if (!m_frames.empty()) { m_frames.pop_back(); }
+                break;
+            case ',':
+                if (at_target) {
+                    m_item_ready = !m_item.empty();
+                }
+                else {
+                    dest.push_back(c);
+                    if (!m_frames.empty() && m_frames.back().is_object) {
+                        m_frames.back().expecting_key = true;
+                    }
+                }
+                break;
+            case ':':
+                dest.push_back(c);
+                if (!m_frames.empty() && m_frames.back().is_object) {
+                    m_frames.back().expecting_key = false;
+                }
+                break;
+            case '"':
+                dest.push_back(c);
+                m_in_string = true;
+                m_string_dest = &dest;
+                if (!at_target && !in_item && !m_frames.empty()) {
+                    auto& frame = m_frames.back();
+                    if (frame.is_object && frame.expecting_key) {
+                        frame.key_matches = false;
+                        if (frame.prefix_matches && m_frames.size() <= m_path.size()) {
+                            m_in_key = true;
+                            m_key.clear();
+                        }
+                    }
+                }
+                break;
+            default:
+                dest.push_back(c);
+                break;
+            }
+        }
+        m_input = std::string_view(p, end - p);
+        if (m_item_ready) {
+            item = std::string_view(m_item.data(), m_item.size());
+        }
+        return m_item_ready;
     }
 
     JsonArray::JsonArray(winrt::Windows::Data::Json::JsonArray const& ja) :
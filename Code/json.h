@@ -1,10 +1,11 @@
 #pragma once
 
 #include <variant>
+#include <optional>
 // For C++/WinRT interop
 #include <winrt/base.h>
 
-// Implement json functions via WinRT APIs
+// Self-contained json implementation working directly on UTF-8; WinRT is only used for interop
 namespace json {
     class JsonValue;
     class JsonObject;
@@ -13,6 +14,14 @@ namespace json {
     namespace details {
         template<typename T>
         struct dependent_false_type : std::false_type {};
+
+        // Integers are kept exact; only non-integral numbers are stored as double
+        template<typename T>
+        auto to_number_repr(T v) {
+            if constexpr (std::is_floating_point_v<T>) { return static_cast<double>(v); }
+            else if constexpr (std::is_signed_v<T>) { return static_cast<int64_t>(v); }
+            else { return static_cast<uint64_t>(v); }
+        }
     }
 
     enum class JsonValueKind {
@@ -185,7 +194,7 @@ namespace json {
         JsonValue(JsonArray&& v) : m_kind(JsonValueKind::Array), m_var(std::move(v)) {}
         //JsonValue(double v) : m_kind(JsonValueKind::Number), m_var(v) {}
         template<typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
-        JsonValue(T v) : m_kind(JsonValueKind::Number), m_var(static_cast<double>(v)) {}
+        JsonValue(T v) : m_kind(JsonValueKind::Number), m_var(details::to_number_repr(v)) {}
         JsonValue(std::wstring_view v) : m_kind(JsonValueKind::String), m_var(std::wstring{ v }) {}
         JsonValue(std::wstring const& v) : JsonValue(std::wstring_view{ v }) {}
         JsonValue(std::wstring&& v) : m_kind(JsonValueKind::String), m_var(std::move(v)) {}
@@ -241,9 +250,12 @@ namespace json {
         const JsonValue& at(std::wstring_view sv) const {
             return this->get<JsonObject>().at(sv);
         }
+        // NOTE: Numbers are converted to T regardless of how they are stored
         template<typename T>
         T get_value(void) const {
-            if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+            if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) {
+                if (auto p = std::get_if<int64_t>(&m_var)) { return static_cast<T>(*p); }
+                if (auto p = std::get_if<uint64_t>(&m_var)) { return static_cast<T>(*p); }
                 return static_cast<T>(std::get<double>(m_var));
             }
             else {
@@ -257,7 +269,7 @@ namespace json {
             constexpr bool valid_string = std::is_convertible_v<T, std::wstring>;
             static_assert(valid_number || valid_string, "Invalid set_value type for JsonValue");
             if constexpr (valid_number) {
-                m_var = static_cast<double>(v);
+                m_var = details::to_number_repr(v);
                 m_kind = JsonValueKind::Number;
             }
             else {  // if constexpr (valid_string)
@@ -298,9 +310,7 @@ namespace json {
             m_kind = JsonValueKind::String;
         }
 
-        bool operator==(JsonValue const& rhs) const {
-            return m_kind == rhs.m_kind && m_var == rhs.m_var;
-        }
+        bool operator==(JsonValue const& rhs) const;
         bool operator!=(JsonValue const& rhs) const {
             return !operator==(rhs);
         }
@@ -318,7 +328,256 @@ namespace json {
         friend class JsonHelper;
     private:
         JsonValueKind m_kind;
-        std::variant<std::nullptr_t, bool, JsonArray, double, std::wstring, JsonObject> m_var;
+        // NOTE: Numbers are stored as int64_t or uint64_t if integral, or double otherwise
+        std::variant<std::nullptr_t, bool, JsonArray, double, std::wstring, JsonObject, int64_t, uint64_t> m_var;
+    };
+
+    class JsonValueView;
+    class JsonObjectView;
+    class JsonArrayView;
+
+    namespace details {
+        struct JsonLazyMember;
+        // A node of JsonDocument, allocated from its arena
+        // NOTE: Strings are kept as raw UTF-8 (without quotes) and only decoded on access
+        struct JsonLazyNode {
+            static constexpr uint8_t NUMBER_INT64 = 0;
+            static constexpr uint8_t NUMBER_UINT64 = 1;
+            static constexpr uint8_t NUMBER_DOUBLE = 2;
+            static constexpr uint8_t STRING_NEEDS_DECODING = 1;
+
+            JsonValueKind kind;
+            uint8_t flags;
+            uint32_t size;      // Raw string length, or count of items / members
+            union {
+                bool boolean;
+                int64_t i64;
+                uint64_t u64;
+                double f64;
+                const char* str;
+                const JsonLazyNode* items;
+                const JsonLazyMember* members;
+            };
+        };
+        struct JsonLazyMember {
+            std::string_view key;   // Unescaped UTF-8
+            JsonLazyNode value;
+        };
+
+        // Bump allocator whose memory is only released as a whole
+        class JsonArena {
+        public:
+            JsonArena() : m_cur(nullptr), m_left(0), m_next_block_size(4096) {}
+            JsonArena(JsonArena&&) noexcept = default;
+            JsonArena& operator=(JsonArena&&) noexcept = default;
+
+            // Sets the size of the next block, for when the total size is roughly known
+            void reserve(size_t size) { m_next_block_size = size; }
+            template<typename T>
+            T* allocate(size_t count) {
+                static_assert(std::is_trivially_destructible_v<T>, "Arena objects are never destroyed");
+                return static_cast<T*>(allocate_bytes(sizeof(T) * count, alignof(T)));
+            }
+
+        private:
+            void* allocate_bytes(size_t size, size_t align);
+
+            std::vector<std::unique_ptr<std::byte[]>> m_blocks;
+            std::byte* m_cur;
+            size_t m_left;
+            size_t m_next_block_size;
+        };
+    }
+
+    // Read-only view of a value inside JsonDocument
+    // NOTE: Views are only valid while the document (and its text) is alive
+    class JsonValueView {
+    public:
+        explicit JsonValueView(const details::JsonLazyNode* node) noexcept : m_node(node) {}
+
+        JsonValueKind kind(void) const noexcept { return m_node->kind; }
+        bool is_null(void) const noexcept { return m_node->kind == JsonValueKind::Null; }
+        bool is_bool(void) const noexcept { return m_node->kind == JsonValueKind::Boolean; }
+        bool is_array(void) const noexcept { return m_node->kind == JsonValueKind::Array; }
+        bool is_number(void) const noexcept { return m_node->kind == JsonValueKind::Number; }
+        bool is_string(void) const noexcept { return m_node->kind == JsonValueKind::String; }
+        bool is_object(void) const noexcept { return m_node->kind == JsonValueKind::Object; }
+
+        // Same as JsonValue::get_value; std::bad_variant_access is thrown on type mismatch
+        // NOTE: Strings are decoded on every call
+        template<typename T>
+        T get_value(void) const {
+            if constexpr (std::is_same_v<T, bool>) {
+                expect_kind(JsonValueKind::Boolean);
+                return m_node->boolean;
+            }
+            else if constexpr (std::is_arithmetic_v<T>) {
+                return std::visit([](auto v) { return static_cast<T>(v); }, get_number());
+            }
+            else if constexpr (std::is_same_v<T, std::wstring>) {
+                return decode_string();
+            }
+            else if constexpr (std::is_same_v<T, winrt::hstring>) {
+                return winrt::hstring{ decode_string() };
+            }
+            else {
+                static_assert(details::dependent_false_type<T>::value, "Invalid get_value type for JsonValueView");
+            }
+        }
+        // Returns the number as it is stored, without conversion
+        std::variant<int64_t, uint64_t, double> get_number(void) const;
+        JsonObjectView get_object(void) const;
+        JsonArrayView get_array(void) const;
+        // Creates an owned copy which does not depend on the document
+        JsonValue materialize(void) const;
+
+    private:
+        void expect_kind(JsonValueKind kind) const {
+            if (m_node->kind != kind) { throw std::bad_variant_access(); }
+        }
+        std::wstring decode_string(void) const;
+
+        const details::JsonLazyNode* m_node;
+    };
+
+    // NOTE: Members are sorted by key; for duplicate keys, only the last one is kept
+    class JsonObjectView {
+    public:
+        struct const_iterator {
+            using value_type = std::pair<std::string_view, JsonValueView>;
+            using difference_type = ptrdiff_t;
+            using iterator_category = std::forward_iterator_tag;
+
+            value_type operator*() const noexcept { return { m_ptr->key, JsonValueView{ &m_ptr->value } }; }
+            const_iterator& operator++() noexcept { m_ptr++; return *this; }
+            const_iterator operator++(int) noexcept { auto prev = *this; m_ptr++; return prev; }
+            bool operator==(const_iterator const& rhs) const noexcept { return m_ptr == rhs.m_ptr; }
+            bool operator!=(const_iterator const& rhs) const noexcept { return m_ptr != rhs.m_ptr; }
+
+            const details::JsonLazyMember* m_ptr;
+        };
+
+        JsonObjectView(const details::JsonLazyMember* members, size_t size) noexcept :
+            m_members(members), m_size(size) {}
+
+        const_iterator begin() const noexcept { return { m_members }; }
+        const_iterator end() const noexcept { return { m_members + m_size }; }
+        bool empty() const noexcept { return m_size == 0; }
+        size_t size() const noexcept { return m_size; }
+        // NOTE: Keys are UTF-8
+        std::optional<JsonValueView> find(std::string_view key) const noexcept;
+        // Throws std::out_of_range if key does not exist
+        JsonValueView at(std::string_view key) const;
+        bool contains(std::string_view key) const noexcept { return find(key).has_value(); }
+        JsonObject materialize(void) const;
+
+    private:
+        const details::JsonLazyMember* m_members;
+        size_t m_size;
+    };
+
+    class JsonArrayView {
+    public:
+        struct const_iterator {
+            using value_type = JsonValueView;
+            using difference_type = ptrdiff_t;
+            using iterator_category = std::forward_iterator_tag;
+
+            value_type operator*() const noexcept { return JsonValueView{ m_ptr }; }
+            const_iterator& operator++() noexcept { m_ptr++; return *this; }
+            const_iterator operator++(int) noexcept { auto prev = *this; m_ptr++; return prev; }
+            bool operator==(const_iterator const& rhs) const noexcept { return m_ptr == rhs.m_ptr; }
+            bool operator!=(const_iterator const& rhs) const noexcept { return m_ptr != rhs.m_ptr; }
+
+            const details::JsonLazyNode* m_ptr;
+        };
+
+        JsonArrayView(const details::JsonLazyNode* items, size_t size) noexcept :
+            m_items(items), m_size(size) {}
+
+        const_iterator begin() const noexcept { return { m_items }; }
+        const_iterator end() const noexcept { return { m_items + m_size }; }
+        bool empty() const noexcept { return m_size == 0; }
+        size_t size() const noexcept { return m_size; }
+        JsonValueView operator[](size_t idx) const noexcept { return JsonValueView{ m_items + idx }; }
+        // Throws std::out_of_range if idx is out of bound
+        JsonValueView at(size_t idx) const;
+        JsonArray materialize(void) const;
+
+    private:
+        const details::JsonLazyNode* m_items;
+        size_t m_size;
+    };
+
+    // Immutable json document parsed in place, for reading large inputs (such as API
+    // responses) without building a JsonValue tree
+    // NOTE: Nodes live in a per-document arena; strings are not copied nor decoded
+    //       until they are read
+    class JsonDocument {
+    public:
+        JsonDocument() : m_root(nullptr) {}
+        JsonDocument(JsonDocument const&) = delete;
+        JsonDocument(JsonDocument&&) noexcept = default;
+        JsonDocument& operator=(JsonDocument&&) noexcept = default;
+
+        // NOTE: The text is not copied, and must outlive the document
+        bool try_deserialize_from_utf8(const char* data, size_t len);
+        bool try_deserialize_from_utf8(std::vector<char> data);
+
+        // NOTE: The root of an empty document is null
+        JsonValueView root(void) const;
+        std::string_view text(void) const noexcept { return m_text; }
+
+    private:
+        std::vector<char> m_owned_text;
+        std::string_view m_text;
+        details::JsonArena m_arena;
+        const details::JsonLazyNode* m_root;
+    };
+
+    // Splits a json text, fed in pieces, into the elements of one array and the rest of
+    // the document, so that large lists can be decoded while they are still being received
+    // NOTE: The text is only scanned for structure; validation is left to parsing the
+    //       elements and the rest of the document
+    // NOTE: The array is found by a path of (unescaped) object keys, and is left empty in
+    //       the rest of the document
+    class JsonArrayStreamSplitter {
+    public:
+        JsonArrayStreamSplitter(std::vector<std::string> path) : m_path(std::move(path)) {}
+
+        // NOTE: data must stay valid until next_item returns false
+        void feed(const char* data, size_t len) { m_input = std::string_view(data, len); }
+        // Scans the text fed so far; returns true when an element is complete
+        // NOTE: item is only valid until the next call
+        bool next_item(std::string_view& item);
+        // Whether the text so far forms a complete document
+        bool is_complete(void) const noexcept { return m_started && m_frames.empty() && !m_in_string; }
+        std::vector<char> take_rest(void) { return std::move(m_rest); }
+
+    private:
+        struct Frame {
+            bool is_object;
+            bool expecting_key;
+            // Whether all keys leading to this frame match the path so far
+            bool prefix_matches;
+            bool key_matches;
+        };
+        void push_frame(bool is_object);
+
+        std::vector<std::string> m_path;
+        std::string_view m_input;
+        std::vector<Frame> m_frames;
+        // Depth of the array frame when inside the target array, or 0 otherwise
+        size_t m_target_depth = 0;
+        bool m_started = false;
+        bool m_in_string = false;
+        bool m_escaped = false;
+        bool m_in_key = false;
+        bool m_item_ready = false;
+        std::vector<char>* m_string_dest = nullptr;
+        std::string m_key;
+        std::vector<char> m_item;
+        std::vector<char> m_rest;
     };
 
     inline JsonObject::reverse_iterator JsonObject::rbegin() noexcept { return m_map.rbegin(); }
@@ -0,0 +1,185 @@
+#pragma once
+
+// Thin helpers over winsqlite shared by the on-disk caches
+
+#include "util.hpp"
+
+#include <winsqlite/winsqlite3.h>
+
+[[noreturn]] inline void throw_sqlite3_error(sqlite3* db) {
+    throw winrt::hresult_error(E_FAIL, winrt::hstring(
+        std::format(L"sqlite3 error: [{}] {}", sqlite3_errcode(db), (const wchar_t*)sqlite3_errmsg16(db))
+    ));
+}
+[[noreturn]] inline void throw_sqlite3_error_code(int code) {
+    throw winrt::hresult_error(E_FAIL, winrt::hstring(
+        std::format(L"sqlite3 error: [{}] {}", code, winrt::to_hstring(sqlite3_errstr(code)))
+    ));
+}
+inline void check_sqlite3(sqlite3* db, int result) {
+    if (result != SQLITE_OK) { throw_sqlite3_error(db); }
+}
+inline void check_sqlite3(int result) {
+    if (result != SQLITE_OK) { throw_sqlite3_error_code(result); }
+}
+template<typename U, typename... Args>
+inline void check_sqlite3_call(U&& func, sqlite3* db, Args&&... args) {
+    if (std::invoke(func, db, std::forward<Args>(args)...) != SQLITE_OK) {
+        throw_sqlite3_error(db);
+    }
+}
+
+struct Sqlite3MutexGuard {
+    Sqlite3MutexGuard(sqlite3* db) : Sqlite3MutexGuard(sqlite3_db_mutex(db)) {}
+    Sqlite3MutexGuard(sqlite3_mutex* sqlite_mutex) : m_sqlite_mutex(sqlite_mutex) {
+        sqlite3_mutex_enter(m_sqlite_mutex);
+    }
+    ~Sqlite3MutexGuard() {
+        sqlite3_mutex_leave(m_sqlite_mutex);
+    }
+private:
+    sqlite3_mutex* m_sqlite_mutex;
+};
+// Caches prepared statements by their text, so that frequently executed statements
+// are only compiled once
+// NOTE: Statements are checked out exclusively, so the pool is safe to share between threads
+struct Sqlite3StatementPool {
+    Sqlite3StatementPool() : m_db(nullptr) {}
+    Sqlite3StatementPool(Sqlite3StatementPool const&) = delete;
+    Sqlite3StatementPool& operator=(Sqlite3StatementPool const&) = delete;
+    ~Sqlite3StatementPool() { clear(); }
+    void attach(sqlite3* db) {
+        clear();
+        m_db = db;
+    }
+    sqlite3* db(void) const { return m_db; }
+    sqlite3_stmt* take(std::wstring_view stmt) {
+        {
+            std::scoped_lock guard(m_mutex);
+            auto it = m_stmts.find(stmt);
+            if (it != m_stmts.end() && !it->second.empty()) {
+                auto result = it->second.back();
+                it->second.pop_back();
+                return result;
+            }
+        }
+        sqlite3_stmt* result;
+        check_sqlite3_call(sqlite3_prepare16_v2,
+            m_db, stmt.data(), static_cast<int>(stmt.size() * 2), &result, nullptr);
+        return result;
+    }
+    // NOTE: Statement must have been reset
+    void give_back(std::wstring_view stmt, sqlite3_stmt* db_stmt) {
+        std::scoped_lock guard(m_mutex);
+        auto it = m_stmts.find(stmt);
+        if (it == m_stmts.end()) {
+            it = m_stmts.emplace(std::wstring(stmt), std::vector<sqlite3_stmt*>{}).first;
+        }
+        if (it->second.size() >= MAX_IDLE_STMTS_PER_TEXT) {
+            sqlite3_finalize(db_stmt);
+            return;
+        }
+        it->second.push_back(db_stmt);
+    }
+    // WARN: Must be called before closing the database
+    void clear(void) {
+        std::scoped_lock guard(m_mutex);
+        for (auto& [text, stmts] : m_stmts) {
+            for (auto db_stmt : stmts) { sqlite3_finalize(db_stmt); }
+        }
+        m_stmts.clear();
+    }
+private:
+    // NOTE: Roughly the number of threads which may run the same statement at once
+    static constexpr size_t MAX_IDLE_STMTS_PER_TEXT = 4;
+
+    sqlite3* m_db;
+    std::mutex m_mutex;
+    std::map<std::wstring, std::vector<sqlite3_stmt*>, std::less<>> m_stmts;
+};
+struct Sqlite3Statement {
+    Sqlite3Statement(sqlite3* db, std::wstring_view stmt) : m_db(db), m_pool(nullptr) {
+        check_sqlite3_call(sqlite3_prepare16_v2,
+            m_db, stmt.data(), static_cast<int>(stmt.size() * 2), &m_stmt, nullptr);
+    }
+    // NOTE: stmt must outlive the statement object (string literals are fine)
+    Sqlite3Statement(Sqlite3StatementPool& pool, std::wstring_view stmt) :
+        m_db(pool.db()), m_pool(&pool), m_stmt_text(stmt), m_stmt(pool.take(stmt)) {}
+    Sqlite3Statement(Sqlite3Statement const&) = delete;
+    Sqlite3Statement& operator=(Sqlite3Statement const&) = delete;
+    void reset(void) {
+        check_sqlite3(sqlite3_reset(m_stmt));
+    }
+    void bind(int idx, std::wstring_view value, bool clone_ownership) {
+        check_sqlite3(sqlite3_bind_text16(
+            m_stmt,
+            idx,
+            value.data(), static_cast<int>(value.size() * 2),
+            clone_ownership ? SQLITE_TRANSIENT : SQLITE_STATIC
+        ));
+    }
+    void bind(int idx, int64_t value) {
+        check_sqlite3(sqlite3_bind_int64(m_stmt, idx, value));
+    }
+    // NOTE: Waiting on locks held by other connections is left to the busy handler
+    //       (see configure_sqlite3_db), so SQLITE_BUSY here means it gave up
+    bool step(void) {
+        // Used for protecting error messages
+        Sqlite3MutexGuard guard(m_db);
+        switch (sqlite3_step(m_stmt)) {
+        case SQLITE_ROW:
+            return true;
+        case SQLITE_DONE:
+            return false;
+        default:
+            throw_sqlite3_error(m_db);
+        }
+    }
+    int64_t col_i64(int idx) { return sqlite3_column_int64(m_stmt, idx); }
+    const wchar_t* col_str16(int idx) {
+        return reinterpret_cast<const wchar_t*>(sqlite3_column_text16(m_stmt, idx));
+    }
+    ~Sqlite3Statement() {
+        if (m_pool) {
+            // NOTE: Errors of the last step are also reported by reset; they are already handled
+            sqlite3_reset(m_stmt);
+            sqlite3_clear_bindings(m_stmt);
+            m_pool->give_back(m_stmt_text, m_stmt);
+            return;
+        }
+        auto code = sqlite3_finalize(m_stmt);
+        if (code != SQLITE_OK) {
+            util::debug::log_warn(L"sqlite3 error: [{}] {}",
+                code, winrt::to_hstring(sqlite3_errstr(code)));
+        }
+    }
+private:
+    sqlite3* m_db;
+    Sqlite3StatementPool* m_pool;
+    std::wstring_view m_stmt_text;
+    sqlite3_stmt* m_stmt;
+};
+
+// Retries with bounded exponential backoff when the database is locked by another connection
+inline int sqlite3_busy_backoff_handler(void*, int retries_count) noexcept {
+    constexpr int MAX_RETRIES_COUNT = 12;
+    constexpr DWORD MAX_BACKOFF_MS = 256;
+    if (retries_count >= MAX_RETRIES_COUNT) { return 0; }
+    // 1, 2, 4, ..., 256, 256, ... (about 1.3s in total)
+    Sleep(std::min<DWORD>(DWORD{ 1 } << std::min(retries_count, 8), MAX_BACKOFF_MS));
+    return 1;
+}
+// Applies settings shared by all cache databases
+// NOTE: WAL lets readers proceed while a write is in progress; with WAL, synchronous = NORMAL
+//       is still corruption-safe and only risks losing the latest commits on power loss,
+//       which is fine for caches
+inline void configure_sqlite3_db(sqlite3* db) {
+    check_sqlite3_call(sqlite3_busy_handler, db, &sqlite3_busy_backoff_handler, nullptr);
+    {
+        Sqlite3Statement db_stmt(db, L"PRAGMA journal_mode = WAL;");
+        if (!db_stmt.step() || std::wstring_view(db_stmt.col_str16(0)) != L"wal") {
+            util::debug::log_warn(L"sqlite3: Cannot enable WAL journal mode");
+        }
+    }
+    Sqlite3Statement(db, L"PRAGMA synchronous = NORMAL;").step();
+}
@@ -284,6 +284,138 @@ namespace util {
         // }; // End class Md5
     }
 
+    namespace mem {
+        sparse_paged_buffer::sparse_paged_buffer(size_t page_size) :
+            m_page_size(page_size), m_pages(nullptr), m_pages_count(0),
+            m_size(0), m_allocated_pages_count(0)
+        {
+            if (page_size == 0) {
+                throw ::winrt::hresult_invalid_argument(L"Page size must not be zero");
+            }
+        }
+        sparse_paged_buffer::~sparse_paged_buffer() {
+            for (size_t i = 0; i < m_pages_count; i++) {
+                std::free(m_pages[i].load());
+            }
+        }
+        void sparse_paged_buffer::size(uint64_t value) {
+            std::unique_lock guard(m_mutex_dir);
+            resize_nolock(value);
+        }
+        void sparse_paged_buffer::resize_nolock(uint64_t value) {
+            auto old_size = m_size.load();
+            if (value == old_size) { return; }
+            auto new_pages_count_u64 = value / m_page_size + (value % m_page_size != 0);
+            if (new_pages_count_u64 > std::numeric_limits<size_t>::max() / sizeof(void*)) {
+                ::winrt::throw_hresult(E_OUTOFMEMORY);
+            }
+            auto new_pages_count = static_cast<size_t>(new_pages_count_u64);
+            if (value < old_size) {
+                // Drop pages past the end, and clear the tail of the last page so that
+                // expanding later exposes zeros instead of stale data
+                for (size_t i = new_pages_count; i < m_pages_count; i++) {
+                    if (auto page = m_pages[i].exchange(nullptr)) {
+                        std::free(page);
+                        m_allocated_pages_count--;
+                    }
+                }
+                auto tail_offset = static_cast<size_t>(value % m_page_size);
+                if (tail_offset != 0) {
+                    if (auto page = m_pages[new_pages_count - 1].load()) {
+                        std::memset(page + tail_offset, 0, m_page_size - tail_offset);
+                    }
+                }
+            }
+            if (new_pages_count != m_pages_count) {
+                // Only page pointers are moved; page contents stay in place
+                std::unique_ptr<std::atomic<unsigned char*>[]> new_pages;
+                if (new_pages_count > 0) {
+                    new_pages = std::make_unique<std::atomic<unsigned char*>[]>(new_pages_count);
+                    auto kept_count = std::min(new_pages_count, m_pages_count);
+                    for (size_t i = 0; i < kept_count; i++) {
+                        new_pages[i].store(m_pages[i].load(), std::memory_order_relaxed);
+                    }
+                    for (size_t i = kept_count; i < new_pages_count; i++) {
+                        new_pages[i].store(nullptr, std::memory_order_relaxed);
+                    }
+                }
+                m_pages = std::move(new_pages);
+                m_pages_count = new_pages_count;
+            }
+            m_size.store(value);
+        }
+        size_t sparse_paged_buffer::read_at(void* buf, uint64_t pos, size_t count) const {
+            std::shared_lock guard(m_mutex_dir);
+            auto cur_size = m_size.load();
+            if (pos >= cur_size) { return 0; }
+            auto actual_count = static_cast<size_t>(std::min<uint64_t>(cur_size - pos, count));
+            auto out_ptr = static_cast<unsigned char*>(buf);
+            size_t done_count = 0;
+            while (done_count < actual_count) {
+                auto cur_pos = pos + done_count;
+                auto page_idx = static_cast<size_t>(cur_pos / m_page_size);
+                auto page_offset = static_cast<size_t>(cur_pos % m_page_size);
+                auto chunk_size = std::min(m_page_size - page_offset, actual_count - done_count);
+                auto page = m_pages[page_idx].load(std::memory_order_acquire);
+                if (page) {
+                    std::shared_lock guard_page(page_lock(page_idx));
+                    std::memcpy(out_ptr + done_count, page + page_offset, chunk_size);
+                }
+                else {
+                    std::memset(out_ptr + done_count, 0, chunk_size);
+                }
+                done_count += chunk_size;
+            }
+            return actual_count;
+        }
+        size_t sparse_paged_buffer::write_at(const void* buf, uint64_t pos, size_t count, bool expand) {
+            if (count == 0) { return 0; }
+            if (expand) {
+                auto expected_min_size = pos + count;
+                if (expected_min_size < pos) {
+                    throw ::winrt::hresult_invalid_argument(L"Write range overflows");
+                }
+                if (expected_min_size > m_size.load()) {
+                    std::unique_lock guard(m_mutex_dir);
+                    if (expected_min_size > m_size.load()) {
+                        resize_nolock(expected_min_size);
+                    }
+                }
+            }
+            std::shared_lock guard(m_mutex_dir);
+            auto cur_size = m_size.load();
+            if (pos >= cur_size) { return 0; }
+            auto actual_count = static_cast<size_t>(std::min<uint64_t>(cur_size - pos, count));
+            auto in_ptr = static_cast<const unsigned char*>(buf);
+            size_t done_count = 0;
+            while (done_count < actual_count) {
+                auto cur_pos = pos + done_count;
+                auto page_idx = static_cast<size_t>(cur_pos / m_page_size);
+                auto page_offset = static_cast<size_t>(cur_pos % m_page_size);
+                auto chunk_size = std::min(m_page_size - page_offset, actual_count - done_count);
+                auto page = m_pages[page_idx].load(std::memory_order_acquire);
+                if (!page) {
+                    // Publish a zeroed page; if another writer wins the race, use theirs
+                    auto new_page = static_cast<unsigned char*>(std::calloc(m_page_size, 1));
+                    if (!new_page) { ::winrt::throw_hresult(E_OUTOFMEMORY); }
+                    if (m_pages[page_idx].compare_exchange_strong(page, new_page, std::memory_order_acq_rel)) {
+                        page = new_page;
+                        m_allocated_pages_count++;
+                    }
+                    else {
+                        std::free(new_page);
+                    }
+                }
+                {
+                    std::unique_lock guard_page(page_lock(page_idx));
+                    std::memcpy(page + page_offset, in_ptr + done_count, chunk_size);
+                }
+                done_count += chunk_size;
+            }
+            return actual_count;
+        }
+    }
+
     namespace container {
         // TODO...
     }
@@ -462,7 +594,69 @@ namespace util {
     }
 
     namespace win32 {
-        // TODO...
+        // Class overlapped_file {
+        bool overlapped_file::io_awaiter::await_suspend(std::coroutine_handle<> handle) noexcept {
+            m_handle = handle;
+            StartThreadpoolIo(m_io);
+            BOOL succeeded = m_write ?
+                WriteFile(m_hfile, m_buf, m_len, nullptr, &m_ol) :
+                ReadFile(m_hfile, m_buf, m_len, nullptr, &m_ol);
+            // NOTE: Completions are queued to the thread pool even if the operation
+            //       finished synchronously
+            if (succeeded || GetLastError() == ERROR_IO_PENDING) { return true; }
+            m_error = GetLastError();
+            m_transferred = 0;
+            CancelThreadpoolIo(m_io);
+            return false;
+        }
+        uint32_t overlapped_file::io_awaiter::await_resume() const {
+            if (m_error == ERROR_HANDLE_EOF) { return 0; }
+            if (m_error != ERROR_SUCCESS) {
+                ::winrt::throw_hresult(HRESULT_FROM_WIN32(m_error));
+            }
+            return m_transferred;
+        }
+        void CALLBACK overlapped_file::io_callback(PTP_CALLBACK_INSTANCE, void*, void* overlapped,
+            ULONG result, ULONG_PTR transferred, PTP_IO) noexcept
+        {
+            auto awaiter = reinterpret_cast<io_awaiter*>(overlapped);
+            awaiter->m_error = result;
+            awaiter->m_transferred = static_cast<uint32_t>(transferred);
+            awaiter->m_handle.resume();
+        }
+        overlapped_file overlapped_file::open(
+            const wchar_t* path, DWORD access, DWORD share, DWORD disposition
+        ) noexcept {
+            CREATEFILE2_EXTENDED_PARAMETERS params{};
+            params.dwSize = sizeof params;
+            params.dwFileAttributes = FILE_ATTRIBUTE_NORMAL;
+            params.dwFileFlags = FILE_FLAG_OVERLAPPED;
+            overlapped_file result;
+            auto hfile = CreateFile2FromAppW(path, access, share, disposition, &params);
+            if (hfile == INVALID_HANDLE_VALUE) { return result; }
+            auto io = CreateThreadpoolIo(hfile, &io_callback, nullptr, nullptr);
+            if (!io) {
+                auto last_error = GetLastError();
+                CloseHandle(hfile);
+                SetLastError(last_error);
+                return result;
+            }
+            result.m_hfile = hfile;
+            result.m_io = io;
+            return result;
+        }
+        uint64_t overlapped_file::size() const {
+            LARGE_INTEGER li;
+            ::winrt::check_bool(GetFileSizeEx(m_hfile, &li));
+            return static_cast<uint64_t>(li.QuadPart);
+        }
+        void overlapped_file::close() noexcept {
+            if (!m_hfile) { return; }
+            CloseHandle(std::exchange(m_hfile, nullptr));
+            // NOTE: Released once outstanding callbacks (if any) have completed
+            CloseThreadpoolIo(std::exchange(m_io, nullptr));
+        }
+        // }; // End class overlapped_file
     }
 
     namespace winrt {
@@ -798,83 +992,52 @@ namespace util {
         }
 
         struct details::InMemoryStreamImpl final {
-            InMemoryStreamImpl() : m_buf_ptr(nullptr), m_buf_size(0) {}
-            ~InMemoryStreamImpl() {
-                std::free(m_buf_ptr);
+            InMemoryStreamImpl() : m_buf(), m_expand_on_overflow(true) {}
+            void size(uint64_t value) {
+                m_buf.size(value);
             }
-            void size(size_t value) {
-                std::scoped_lock guard(m_mutex);
-                // Deterministically free storage instead of relying on impl-def behaviors
-                if (value == 0) {
-                    std::free(m_buf_ptr);
-                    m_buf_ptr = nullptr;
-                }
-                else {
-                    auto new_ptr = std::realloc(m_buf_ptr, value);
-                    if (!new_ptr) { ::winrt::throw_hresult(E_OUTOFMEMORY); }
-                    m_buf_ptr = reinterpret_cast<unsigned char*>(new_ptr);
-                }
-                m_buf_size = value;
+            uint64_t size() const {
+                return m_buf.size();
             }
-            size_t size() const {
-                std::scoped_lock guard(m_mutex);
-                return m_buf_size;
+            uint64_t allocated_size() const {
+                return m_buf.allocated_size();
             }
             void expand_on_overflow(bool value) {
-                std::scoped_lock guard(m_mutex);
-                m_expand_on_overflow = value;
+                m_expand_on_overflow.store(value);
             }
             bool expand_on_overflow() const {
-                std::scoped_lock guard(m_mutex);
-                return m_expand_on_overflow;
-            }
-            size_t read_at(void* buf, size_t pos, size_t count) const {
-                std::scoped_lock guard(m_mutex);
-                if (pos >= m_buf_size) { return 0; }
-                auto actual_count = std::min(m_buf_size - pos, count);
-                std::memcpy(buf, m_buf_ptr + pos, actual_count);
-                return actual_count;
-            }
-            size_t write_at(const void* buf, size_t pos, size_t count) {
-                std::scoped_lock guard(m_mutex);
-                size_t actual_count;
-                if (m_expand_on_overflow) {
-                    auto expected_min_size = pos + count;
-                    if (expected_min_size > m_buf_size) {
-                        this->size(expected_min_size);
-                    }
-                    actual_count = count;
-                }
-                else {
-                    if (pos >= m_buf_size) { return 0; }
-                    actual_count = std::min(m_buf_size - pos, count);
-                }
-                std::memcpy(m_buf_ptr + pos, buf, actual_count);
-                return actual_count;
+                return m_expand_on_overflow.load();
+            }
+            size_t read_at(void* buf, uint64_t pos, size_t count) const {
+                return m_buf.read_at(buf, pos, count);
+            }
+            size_t write_at(const void* buf, uint64_t pos, size_t count) {
+                return m_buf.write_at(buf, pos, count, m_expand_on_overflow.load());
             }
         private:
-            mutable std::mutex m_mutex;
-            unsigned char* m_buf_ptr;
-            size_t m_buf_size;
-            bool m_expand_on_overflow = true;
+            util::mem::sparse_paged_buffer m_buf;
+            std::atomic_bool m_expand_on_overflow;
         };
         InMemoryStream::InMemoryStream() : m_impl(std::make_shared<details::InMemoryStreamImpl>()) {}
-        void InMemoryStream::size(size_t value) const {
+        void InMemoryStream::size(uint64_t value) const {
             return m_impl->size(value);
         }
-        size_t InMemoryStream::size() const {
+        uint64_t InMemoryStream::size() const {
             return m_impl->size();
         }
+        uint64_t InMemoryStream::allocated_size() const {
+            return m_impl->allocated_size();
+        }
         void InMemoryStream::expand_on_overflow(bool value) const {
             return m_impl->expand_on_overflow(value);
         }
         bool InMemoryStream::expand_on_overflow() const {
             return m_impl->expand_on_overflow();
         }
-        size_t InMemoryStream::read_at(void* buf, size_t pos, size_t count) const {
+        size_t InMemoryStream::read_at(void* buf, uint64_t pos, size_t count) const {
             return m_impl->read_at(buf, pos, count);
         }
-        size_t InMemoryStream::write_at(const void* buf, size_t pos, size_t count) const {
+        size_t InMemoryStream::write_at(const void* buf, uint64_t pos, size_t count) const {
             return m_impl->write_at(buf, pos, count);
         }
         ::winrt::Windows::Storage::Streams::IRandomAccessStream InMemoryStream::as_random_access_stream() const {
@@ -929,7 +1092,7 @@ namespace util {
                 uint64_t Size() {
                     auto impl = m_impl.load();
                     if (!impl) { throw ::winrt::hresult_illegal_method_call(); }
-                    return static_cast<uint64_t>(impl->size());
+                    return impl->size();
                 }
                 void Size(uint64_t value) {
                     auto impl = m_impl.load();
@@ -3,6 +3,7 @@
 #include <string>
 #include <format>
 #include <atomic>
+#include <map>
 #include <shared_mutex>
 #include <source_location>
 
@@ -280,42 +281,146 @@ namespace util {
         // Pass nullptr to disable logging
         void set_log_provider(LoggingProvider* provider);
         LoggingProvider* get_log_provider(void);
+
+        // NOTE: Trace logs are compiled out of release builds by default
+#ifndef UTIL_DEBUG_ENABLE_TRACE_LOG
+#ifdef NDEBUG
+#define UTIL_DEBUG_ENABLE_TRACE_LOG 0
+#else
+#define UTIL_DEBUG_ENABLE_TRACE_LOG 1
+#endif
+#endif
+        namespace details {
+            inline std::atomic<LogLevel> g_min_log_level{ LogLevel::Trace };
+        }
+        // NOTE: Logs below the given level are dropped before being formatted
+        inline void set_min_log_level(LogLevel level) {
+            details::g_min_log_level.store(level, std::memory_order_relaxed);
+        }
+        inline LogLevel get_min_log_level(void) {
+            return details::g_min_log_level.load(std::memory_order_relaxed);
+        }
+        inline bool is_log_enabled(LogLevel level) {
+            if constexpr (!UTIL_DEBUG_ENABLE_TRACE_LOG) {
+                if (level == LogLevel::Trace) { return false; }
+            }
+            return level >= get_min_log_level();
+        }
+
+        // Format string of a deferred log call; also captures the call site
+        // NOTE: Only string literals are accepted, so that calls passing an already
+        //       formatted string keep resolving to the plain overloads
+        template<typename... Args>
+        struct BasicLogFormat {
+            template<size_t N>
+            consteval BasicLogFormat(
+                const wchar_t(&fmt)[N], std::source_location const& loc = std::source_location::current()
+            ) : fmt(fmt), loc(loc) {}
+
+            std::wformat_string<Args...> fmt;
+            std::source_location loc;
+        };
+        template<typename... Args>
+        using LogFormat = BasicLogFormat<std::type_identity_t<Args>...>;
+
+        // Argument which is only evaluated when the log is actually formatted
+        template<typename Functor>
+        struct LazyLogArg {
+            Functor func;
+        };
+        template<typename Functor>
+        inline LazyLogArg<Functor> lazy_arg(Functor func) {
+            return { std::move(func) };
+        }
+
+        // NOTE: Prefer log_*(L"fmt {}", args...) over log_*(std::format(...)), as the former
+        //       skips formatting entirely when the level is disabled
         // TODO: std::source_location shows full file path, maybe change this?
         inline void log_trace(
             std::wstring_view str, std::source_location const& loc = std::source_location::current()
         ) {
+            if (!is_log_enabled(LogLevel::Trace)) {
+                return;
+            }
             if (auto provider = get_log_provider()) {
                 provider->log_trace(str, loc);
             }
         }
+        template<typename... Args>
+        inline void log_trace(LogFormat<Args...> fmt, Args&&... args) {
+            if (!is_log_enabled(LogLevel::Trace)) {
+                return;
+            }
+            log_trace(std::format(fmt.fmt, std::forward<Args>(args)...), fmt.loc);
+        }
         inline void log_debug(
             std::wstring_view str, std::source_location const& loc = std::source_location::current()
         ) {
+            if (!is_log_enabled(LogLevel::Debug)) {
+                return;
+            }
             if (auto provider = get_log_provider()) {
                 provider->log_debug(str, loc);
             }
         }
+        template<typename... Args>
+        inline void log_debug(LogFormat<Args...> fmt, Args&&... args) {
+            if (!is_log_enabled(LogLevel::Debug)) {
+                return;
+            }
+            log_debug(std::format(fmt.fmt, std::forward<Args>(args)...), fmt.loc);
+        }
         inline void log_info(
             std::wstring_view str, std::source_location const& loc = std::source_location::current()
         ) {
+            if (!is_log_enabled(LogLevel::Info)) {
+                return;
+            }
             if (auto provider = get_log_provider()) {
                 provider->log_info(str, loc);
             }
         }
+        template<typename... Args>
+        inline void log_info(LogFormat<Args...> fmt, Args&&... args) {
+            if (!is_log_enabled(LogLevel::Info)) {
+                return;
+            }
+            log_info(std::format(fmt.fmt, std::forward<Args>(args)...), fmt.loc);
+        }
         inline void log_warn(
             std::wstring_view str, std::source_location const& loc = std::source_location::current()
         ) {
+            if (!is_log_enabled(LogLevel::Warn)) {
+                return;
+            }
             if (auto provider = get_log_provider()) {
                 provider->log_warn(str, loc);
             }
         }
+        template<typename... Args>
+        inline void log_warn(LogFormat<Args...> fmt, Args&&... args) {
+            if (!is_log_enabled(LogLevel::Warn)) {
+                return;
+            }
+            log_warn(std::format(fmt.fmt, std::forward<Args>(args)...), fmt.loc);
+        }
         inline void log_error(
             std::wstring_view str, std::source_location const& loc = std::source_location::current()
         ) {
+            if (!is_log_enabled(LogLevel::Error)) {
+                return;
+            }
             if (auto provider = get_log_provider()) {
                 provider->log_error(str, loc);
             }
         }
+        template<typename... Args>
+        inline void log_error(LogFormat<Args...> fmt, Args&&... args) {
+            if (!is_log_enabled(LogLevel::Error)) {
+                return;
+            }
+            log_error(std::format(fmt.fmt, std::forward<Args>(args)...), fmt.loc);
+        }
 
         class RAIIObserver {
         public:
@@ -331,7 +436,7 @@ namespace util {
                 );
             }
             ~RAIIObserver() {
-                log_trace(std::format(L"Destructed RAIIObserver which came from line {}", m_loc.line()));
+                log_trace(L"Destructed RAIIObserver which came from line {}", m_loc.line());
             }
         private:
             std::source_location m_loc;
@@ -385,6 +490,49 @@ namespace util {
                     ptr, std::forward<Args>(args)...);
             }
         };
+
+        // A sparse byte buffer made of fixed-size pages, which are allocated lazily on first write
+        // NOTE: Unwritten ranges read as zeros. Resizing never copies page contents.
+        // NOTE: Concurrent accesses to different pages never contend with each other, except
+        //       when they happen to share the same lock stripe
+        class sparse_paged_buffer {
+        public:
+            static constexpr size_t default_page_size = 65536;
+
+            explicit sparse_paged_buffer(size_t page_size = default_page_size);
+            sparse_paged_buffer(sparse_paged_buffer const&) = delete;
+            sparse_paged_buffer& operator=(sparse_paged_buffer const&) = delete;
+            ~sparse_paged_buffer();
+
+            void size(uint64_t value);
+            uint64_t size() const noexcept { return m_size.load(); }
+            size_t page_size() const noexcept { return m_page_size; }
+            // Total size of pages which are currently allocated
+            uint64_t allocated_size() const noexcept {
+                return static_cast<uint64_t>(m_allocated_pages_count.load()) * m_page_size;
+            }
+            // Returns the count of bytes actually read (stops at the end of buffer)
+            size_t read_at(void* buf, uint64_t pos, size_t count) const;
+            // Returns the count of bytes actually written; if expand is true, buffer
+            // grows to hold all data, otherwise data is truncated at the end of buffer
+            size_t write_at(const void* buf, uint64_t pos, size_t count, bool expand);
+        private:
+            static constexpr size_t lock_stripes_count = 64;
+
+            void resize_nolock(uint64_t value);
+            std::shared_mutex& page_lock(size_t page_idx) const noexcept {
+                return m_page_locks[page_idx % lock_stripes_count];
+            }
+
+            const size_t m_page_size;
+            // Guards the page directory itself; page contents are guarded by m_page_locks
+            mutable std::shared_mutex m_mutex_dir;
+            std::unique_ptr<std::atomic<unsigned char*>[]> m_pages;
+            size_t m_pages_count;
+            std::atomic<uint64_t> m_size;
+            std::atomic<size_t> m_allocated_pages_count;
+            mutable std::shared_mutex m_page_locks[lock_stripes_count];
+        };
     }
 
     namespace container {
@@ -475,6 +623,126 @@ namespace util {
             Container c{};
             Compare comp{};
         };
+        // A set of disjoint half-open ranges [start, end), where adjacent ranges are always merged
+        // NOTE: All modifying and querying operations are O(log n + k), where k is the number of
+        //       ranges touched by the operation
+        template<typename T>
+        class range_set {
+        public:
+            using range_type = std::pair<T, T>;
+            using Container = std::map<T, T>;
+            using const_iterator = typename Container::const_iterator;
+
+            range_set() = default;
+            range_set(T start, T end) { insert(start, end); }
+
+            const_iterator begin() const noexcept { return c.begin(); }
+            const_iterator end() const noexcept { return c.end(); }
+            bool empty() const noexcept { return c.empty(); }
+            // Count of disjoint ranges
+            size_t size() const noexcept { return c.size(); }
+            // Sum of lengths of all ranges
+            T total_length() const noexcept { return m_total_length; }
+            void clear() noexcept {
+                c.clear();
+                m_total_length = T{};
+            }
+
+            void insert(T start, T end) {
+                if (!(start < end)) { return; }
+                // Find the first range which may touch [start, end)
+                auto it = c.upper_bound(start);
+                if (it != c.begin()) {
+                    auto prev_it = std::prev(it);
+                    if (!(prev_it->second < start)) { it = prev_it; }
+                }
+                // Absorb all touching ranges
+                while (it != c.end() && !(end < it->first)) {
+                    if (it->first < start) { start = it->first; }
+                    if (end < it->second) { end = it->second; }
+                    m_total_length -= it->second - it->first;
+                    it = c.erase(it);
+                }
+                c.emplace_hint(it, start, end);
+                m_total_length += end - start;
+            }
+            void erase(T start, T end) {
+                if (!(start < end)) { return; }
+                auto it = c.upper_bound(start);
+                if (it != c.begin()) {
+                    auto prev_it = std::prev(it);
+                    if (start < prev_it->second) { it = prev_it; }
+                }
+                while (it != c.end() && it->first < end) {
+                    auto cur_start = it->first, cur_end = it->second;
+                    m_total_length -= cur_end - cur_start;
+                    it = c.erase(it);
+                    // Put back the parts outside [start, end)
+                    if (cur_start < start) {
+                        c.emplace_hint(it, cur_start, start);
+                        m_total_length += start - cur_start;
+                    }
+                    if (end < cur_end) {
+                        c.emplace_hint(it, end, cur_end);
+                        m_total_length += cur_end - end;
+                        break;
+                    }
+                }
+            }
+            // Whether [start, end) is fully covered
+            bool contains(T start, T end) const {
+                if (!(start < end)) { return true; }
+                auto it = c.upper_bound(start);
+                if (it == c.begin()) { return false; }
+                --it;
+                return !(it->second < end);
+            }
+            // Returns the parts of [start, end) covered by the set, in ascending order
+            std::vector<range_type> intersect(T start, T end) const {
+                std::vector<range_type> result;
+                if (!(start < end)) { return result; }
+                auto it = c.upper_bound(start);
+                if (it != c.begin()) {
+                    auto prev_it = std::prev(it);
+                    if (start < prev_it->second) { it = prev_it; }
+                }
+                for (; it != c.end() && it->first < end; it++) {
+                    result.emplace_back(std::max(start, it->first), std::min(end, it->second));
+                }
+                return result;
+            }
+            // Returns the parts of [start, end) NOT covered by the set, in ascending order
+            std::vector<range_type> gaps(T start, T end) const {
+                std::vector<range_type> result;
+                if (!(start < end)) { return result; }
+                auto it = c.upper_bound(start);
+                if (it != c.begin()) {
+                    auto prev_it = std::prev(it);
+                    if (start < prev_it->second) { start = prev_it->second; }
+                }
+                for (; start < end && it != c.end() && it->first < end; it++) {
+                    if (start < it->first) { result.emplace_back(start, it->first); }
+                    start = it->second;
+                }
+                if (start < end) { result.emplace_back(start, end); }
+                return result;
+            }
+            // Returns the first part of [start, end) NOT covered by the set
+            std::optional<range_type> first_gap(T start, T end) const {
+                if (!(start < end)) { return std::nullopt; }
+                auto it = c.upper_bound(start);
+                if (it != c.begin()) {
+                    auto prev_it = std::prev(it);
+                    if (start < prev_it->second) { start = prev_it->second; }
+                }
+                if (!(start < end)) { return std::nullopt; }
+                if (it != c.end() && it->first < end) { return range_type{ start, it->first }; }
+                return range_type{ start, end };
+            }
+        private:
+            Container c{};
+            T m_total_length{};
+        };
     }
 
     namespace fs {
@@ -494,7 +762,77 @@ namespace util {
     }
 
     namespace win32 {
-        // TODO...
+        // File opened for overlapped I/O and bound to the thread pool, so that reads and
+        // writes complete asynchronously without blocking the awaiting thread
+        // NOTE: There is no file pointer; all operations take explicit offsets
+        // NOTE: Awaiting coroutines are resumed on a thread pool thread
+        class overlapped_file {
+        public:
+            struct io_awaiter {
+                bool await_ready() const noexcept { return false; }
+                bool await_suspend(std::coroutine_handle<> handle) noexcept;
+                // Returns the count of bytes transferred (0 at end of file)
+                uint32_t await_resume() const;
+
+                // NOTE: Must be the first member, see overlapped_file::io_callback
+                OVERLAPPED m_ol;
+                HANDLE m_hfile;
+                PTP_IO m_io;
+                void* m_buf;
+                uint32_t m_len;
+                bool m_write;
+                std::coroutine_handle<> m_handle;
+                DWORD m_error;
+                uint32_t m_transferred;
+            };
+
+            overlapped_file() noexcept : m_hfile(nullptr), m_io(nullptr) {}
+            overlapped_file(std::nullptr_t) noexcept : overlapped_file() {}
+            overlapped_file(overlapped_file const&) = delete;
+            overlapped_file(overlapped_file&& other) noexcept :
+                m_hfile(std::exchange(other.m_hfile, nullptr)), m_io(std::exchange(other.m_io, nullptr)) {}
+            overlapped_file& operator=(overlapped_file&& other) noexcept {
+                if (this != &other) {
+                    close();
+                    m_hfile = std::exchange(other.m_hfile, nullptr);
+                    m_io = std::exchange(other.m_io, nullptr);
+                }
+                return *this;
+            }
+            ~overlapped_file() { close(); }
+            // Returns an empty object on failure; call GetLastError for details
+            static overlapped_file open(const wchar_t* path, DWORD access, DWORD share, DWORD disposition) noexcept;
+
+            explicit operator bool() const noexcept { return m_hfile != nullptr; }
+            HANDLE get() const noexcept { return m_hfile; }
+            uint64_t size() const;
+            // NOTE: Pending operations are aborted
+            void close() noexcept;
+
+            io_awaiter read_at_async(uint64_t pos, void* buf, uint32_t len) const noexcept {
+                return make_awaiter(pos, buf, len, false);
+            }
+            io_awaiter write_at_async(uint64_t pos, const void* buf, uint32_t len) const noexcept {
+                return make_awaiter(pos, const_cast<void*>(buf), len, true);
+            }
+        private:
+            io_awaiter make_awaiter(uint64_t pos, void* buf, uint32_t len, bool write) const noexcept {
+                io_awaiter awaiter{};
+                awaiter.m_ol.Offset = static_cast<DWORD>(pos);
+                awaiter.m_ol.OffsetHigh = static_cast<DWORD>(pos >> 32);
+                awaiter.m_hfile = m_hfile;
+                awaiter.m_io = m_io;
+                awaiter.m_buf = buf;
+                awaiter.m_len = len;
+                awaiter.m_write = write;
+                return awaiter;
+            }
+            static void CALLBACK io_callback(PTP_CALLBACK_INSTANCE, void*, void* overlapped,
+                ULONG result, ULONG_PTR transferred, PTP_IO) noexcept;
+
+            HANDLE m_hfile;
+            PTP_IO m_io;
+        };
     }
 
     namespace winrt {
@@ -1485,6 +1823,35 @@ namespace util {
             uint64_t m_cur_pos;
         };
 
+        // IBuffer referencing memory owned by someone else, so that data can be handed out
+        // without copying
+        // NOTE: owner keeps the memory alive (e.g. pinned in a cache) until the view is released
+        // WARN: Consumers must not write to the memory
+        struct BufferView :
+            ::winrt::implements<BufferView,
+            ::winrt::Windows::Storage::Streams::IBuffer,
+            ::Windows::Storage::Streams::IBufferByteAccess>
+        {
+            BufferView(std::shared_ptr<void> owner, uint8_t* data, uint32_t length) :
+                m_owner(std::move(owner)), m_data(data), m_capacity(length), m_length(length) {}
+            uint32_t Capacity() { return m_capacity; }
+            uint32_t Length() { return m_length.load(); }
+            void Length(uint32_t value) {
+                if (value > m_capacity) { throw ::winrt::hresult_invalid_argument(); }
+                m_length.store(value);
+            }
+            HRESULT __stdcall Buffer(uint8_t** value) noexcept override {
+                *value = m_data;
+                return S_OK;
+            }
+
+        private:
+            std::shared_ptr<void> m_owner;
+            uint8_t* const m_data;
+            const uint32_t m_capacity;
+            std::atomic<uint32_t> m_length;
+        };
+
         void persist_textbox_cc_clipboard(::winrt::Windows::UI::Xaml::Controls::TextBox const& tb);
         void persist_autosuggestbox_clipboard(::winrt::Windows::UI::Xaml::Controls::AutoSuggestBox const& ctrl);
 
@@ -1640,15 +2007,17 @@ namespace util {
         };
 
         // A simple in-memory stream which supports IRandomAccessStream
+        // NOTE: Backed by util::mem::sparse_paged_buffer, so >4GB and sparse content are supported
         namespace details { struct InMemoryStreamImpl; }
         struct InMemoryStream {
             InMemoryStream();
-            void size(size_t value) const;
-            size_t size() const;
+            void size(uint64_t value) const;
+            uint64_t size() const;
+            uint64_t allocated_size() const;
             void expand_on_overflow(bool value) const;
             bool expand_on_overflow() const;
-            size_t read_at(void* buf, size_t pos, size_t count) const;
-            size_t write_at(const void* buf, size_t pos, size_t count) const;
+            size_t read_at(void* buf, uint64_t pos, size_t count) const;
+            size_t write_at(const void* buf, uint64_t pos, size_t count) const;
             ::winrt::Windows::Storage::Streams::IRandomAccessStream as_random_access_stream() const;
         private:
             std::shared_ptr<details::InMemoryStreamImpl> m_impl;
@@ -1968,6 +2337,15 @@ namespace util {
     }
 }
 
+template<typename Functor>
+struct std::formatter<util::debug::LazyLogArg<Functor>, wchar_t> : std::formatter<std::wstring_view, wchar_t> {
+    template<typename FormatContext>
+    auto format(util::debug::LazyLogArg<Functor> const& arg, FormatContext& ctx) const {
+        auto str = std::invoke(arg.func);
+        return std::formatter<std::wstring_view, wchar_t>::format(std::wstring_view{ str }, ctx);
+    }
+};
+
 // Preludes
 using util::winrt::fire_forget_except;
 //using util::winrt::co_exlog;
@@ -21,6 +21,7 @@ using namespace Microsoft::Graphics::Canvas;
 using namespace Microsoft::Graphics::Canvas::UI::Composition;
 
 namespace BiliUWP {
+    constexpr uint64_t IMAGE_EX_CACHE_CAPACITY = 256 * 1024 * 1024;
     static HttpCache http_cache = nullptr;
     util::winrt::task<> init_image_ex_async() {
         static util::winrt::mutex s_mutex;
@@ -30,8 +31,12 @@ namespace BiliUWP {
             http_cache = co_await HttpCache::create_async(
                 Windows::Storage::ApplicationData::Current().TemporaryFolder(),
                 L"ImageExCache",
-                nullptr
+                nullptr,
+                IMAGE_EX_CACHE_CAPACITY
             );
+            // NOTE: The same images are often served under different uris (e.g. from
+            //       different mirror hosts), so store identical ones only once
+            http_cache.dedup_bodies(true);
         }
     }
     HttpCache get_image_ex_http_cache() {
@@ -100,10 +100,10 @@ namespace winrt::BiliUWP::implementation {
             param_type = MediaPlayPage_MediaType::Audio;
             break;
         default:
-            util::debug::log_error(std::format(
+            util::debug::log_error(
                 L"Unsupported or unimplemented resource type {}",
                 std::to_underlying(res_item_type)
-            ));
+            );
             return;
         }
         tab->navigate(
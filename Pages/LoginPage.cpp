@@ -223,8 +223,8 @@ namespace winrt::BiliUWP::implementation {
             co_return QRCodePollResult::Expired;
         case ::BiliUWP::ApiCode::Success:
         {
-            util::debug::log_trace(std::format(L"Got tokens which will expire in {} seconds",
-                result.expires_in));
+            util::debug::log_trace(L"Got tokens which will expire in {} seconds",
+                result.expires_in);
             auto api_keys = client->get_api_sign_keys();
             auto cfg_model = ::BiliUWP::App::get()->cfg_model();
             cfg_model.User_CredentialEffectiveStartTime(cur_ts);
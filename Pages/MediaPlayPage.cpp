@@ -6,6 +6,7 @@
 #include "MediaPlayPage_UpItem.g.cpp"
 #include "MediaPlayPage_PartItem.g.cpp"
 #include "HttpRandomAccessStream.h"
+#include "MediaCache.h"
 #include "App.h"
 #include <deque>
 #include <ranges>
@@ -31,6 +32,12 @@ using namespace Windows::Security::Cryptography;
 
 using ::BiliUWP::App::res_str;
 
+// Memory budget for buffering video streams (audio streams are small enough to be fully buffered)
+constexpr uint64_t HRAS_VIDEO_CACHE_CAPACITY = 256 * 1024 * 1024;
+// Initial prefetch windows; HRAS grows them further when bandwidth allows
+constexpr uint64_t HRAS_VIDEO_PREFETCH_WINDOW_SIZE = 4 * 1024 * 1024;
+constexpr uint64_t HRAS_AUDIO_PREFETCH_WINDOW_SIZE = 512 * 1024;
+
 // TODO: Maybe implement GridSplitter to ease sidebar resizing
 
 // TODO: Add support for App_AlwaysSyncPlayingCfg
@@ -363,11 +370,11 @@ namespace winrt::BiliUWP::implementation {
         media_player_state_overlay.SwitchToLoading(res_str(L"App/Common/Loading"));
         try {
             if (bvid != L"") {
-                util::debug::log_trace(std::format(L"NavHandleVideoPlay with video {}...", bvid));
+                util::debug::log_trace(L"NavHandleVideoPlay with video {}...", bvid);
                 co_await this->UpdateVideoInfo(bvid);
             }
             else {
-                util::debug::log_trace(std::format(L"NavHandleVideoPlay with video av{}...", avid));
+                util::debug::log_trace(L"NavHandleVideoPlay with video av{}...", avid);
                 co_await this->UpdateVideoInfo(avid);
             }
         }
@@ -422,7 +429,7 @@ namespace winrt::BiliUWP::implementation {
         auto media_player_state_overlay = MediaPlayerStateOverlay();
         media_player_state_overlay.SwitchToLoading(res_str(L"App/Common/Loading"));
         try {
-            util::debug::log_trace(std::format(L"NavHandleAudioPlay with audio au{}...", auid));
+            util::debug::log_trace(L"NavHandleAudioPlay with audio au{}...", auid);
             co_await this->UpdateAudioInfo(auid);
         }
         catch (::BiliUWP::BiliApiException const& e) {
@@ -547,7 +554,7 @@ namespace winrt::BiliUWP::implementation {
                 vstream.segment_base.index_range, vstream.segment_base.initialization
             );
         }
-        util::debug::log_trace(std::format(L"Generated dash: {}", dash_mpd_str));
+        util::debug::log_trace(L"Generated dash: {}", dash_mpd_str);
         return util::winrt::string_to_utf8_stream(hstring(dash_mpd_str));
     }
     util::winrt::task<MediaPlayPage::MediaSrcDetailedStatsPair> MediaPlayPage::PlayVideoWithCidInner_DashNativeNative(
@@ -764,8 +771,8 @@ namespace winrt::BiliUWP::implementation {
                         }
                     }
                 });
-                util::debug::log_trace(std::format(L"Fetching partial http: {}+{}",
-                    content_start, content_size));
+                util::debug::log_trace(L"Fetching partial http: {}+{}",
+                    content_start, content_size);
                 auto read_op = util::winrt::fetch_partial_http_as_buffer(
                     target_uri, http_client,
                     content_start, content_size
@@ -787,6 +794,7 @@ namespace winrt::BiliUWP::implementation {
         co_return{ MediaSource::CreateFromAdaptiveMediaSource(adaptive_media_src), std::move(ds_provider) };
     }
     util::winrt::task<MediaPlayPage::MediaSrcDetailedStatsPair> MediaPlayPage::PlayVideoWithCidInner_DashNativeHras(
+        uint64_t cid,
         ::BiliUWP::VideoPlayUrl_Dash const& dash_info,
         ::BiliUWP::VideoPlayUrl_Dash_Stream const& vstream,
         ::BiliUWP::VideoPlayUrl_Dash_Stream const& astream,
@@ -833,8 +841,8 @@ namespace winrt::BiliUWP::implementation {
             auto vhrasop = BiliUWP::HttpRandomAccessStream::CreateAsync(
                 vuri,
                 m_http_client_m,
-                HttpRandomAccessStreamBufferOptions::Full,
-                0, false
+                HttpRandomAccessStreamBufferOptions::Sized,
+                HRAS_VIDEO_CACHE_CAPACITY, false
             );
             auto ahrasop = BiliUWP::HttpRandomAccessStream::CreateAsync(
                 auri,
@@ -854,6 +862,10 @@ namespace winrt::BiliUWP::implementation {
         };
         add_backup_uris_fn(vhras, vstream.backup_url);
         add_backup_uris_fn(ahras, astream.backup_url);
+        vhras.PrefetchWindowSize(HRAS_VIDEO_PREFETCH_WINDOW_SIZE);
+        ahras.PrefetchWindowSize(HRAS_AUDIO_PREFETCH_WINDOW_SIZE);
+        vhras.EnablePersistentCache(::BiliUWP::MediaCache::make_stream_key(cid, vstream.id, vstream.codecid));
+        ahras.EnablePersistentCache(::BiliUWP::MediaCache::make_stream_key(cid, astream.id, astream.codecid));
         auto new_uri_requested_inner_fn = [get_new_stream_fn = std::move(get_new_stream_fn),
             weak_vhras = make_weak(vhras), weak_ahras = make_weak(ahras)
         ](void) -> util::winrt::task<>
@@ -892,21 +904,21 @@ namespace winrt::BiliUWP::implementation {
                 std::scoped_lock guard(shared_data->mutex);
                 op = shared_data->op;
                 if (!op) {
-                    util::debug::log_trace(std::format(L"Establishing inner NRU async operation (CorrelationId: {:08x})", correlation_id));
+                    util::debug::log_trace(L"Establishing inner NRU async operation (CorrelationId: {:08x})", correlation_id);
                     op = shared_data->op = new_uri_requested_inner_fn();
                     owns_op = true;
                 }
             }
             deferred([&] {
                 if (owns_op) {
-                    util::debug::log_trace(std::format(L"Releasing inner NRU async operation (CorrelationId: {:08x})", correlation_id));
+                    util::debug::log_trace(L"Releasing inner NRU async operation (CorrelationId: {:08x})", correlation_id);
                     std::scoped_lock guard(shared_data->mutex);
                     shared_data->op = nullptr;
                 }
             });
-            util::debug::log_trace(std::format(L"Waiting for inner NRU async operation to complete (CorrelationId: {:08x})", correlation_id));
+            util::debug::log_trace(L"Waiting for inner NRU async operation to complete (CorrelationId: {:08x})", correlation_id);
             co_await op;
-            util::debug::log_trace(std::format(L"Done awaiting inner NRU async operation (CorrelationId: {:08x})", correlation_id));
+            util::debug::log_trace(L"Done awaiting inner NRU async operation (CorrelationId: {:08x})", correlation_id);
         };
         vhras.NewUriRequested(new_uri_requested_fn);
         ahras.NewUriRequested(new_uri_requested_fn);
@@ -944,7 +956,7 @@ namespace winrt::BiliUWP::implementation {
                 using util::winrt::make_text_block;
                 ctx->AddElement(L"Mime Type", make_text_block(m_mime_type));
                 ctx->AddElement(L"Player Type", make_text_block(
-                    L"NativeDashPlayer <- NativeBuffering <- HRAS(Full)"
+                    L"NativeDashPlayer <- NativeBuffering <- HRAS(Sized)"
                 ));
                 ctx->AddElement(L"Resolution", make_text_block(m_resolution));
                 ctx->AddElement(L"Video Host", m_video_host_tb);
@@ -1022,9 +1034,12 @@ namespace winrt::BiliUWP::implementation {
                 }, m_net_activity_points, MAX_POINTS);
                 // Update mystery text
                 m_mystery_text_tb.Text(hstring(std::format(
-                    L"c:{} rd:{} hrasb:{}/{}",
+                    L"c:{} rd:{} cr:{} cp:{} pc:{} hrasb:{}/{}",
                     vmetrics.ActiveConnectionsCount + ametrics.ActiveConnectionsCount,
                     vmetrics.SentRequestsDelta + ametrics.SentRequestsDelta,
+                    vmetrics.CoalescedRequestsDelta + ametrics.CoalescedRequestsDelta,
+                    vmetrics.CopiedBytesDelta + ametrics.CopiedBytesDelta,
+                    vmetrics.PersistentCacheBytesDelta + ametrics.PersistentCacheBytesDelta,
                     vmetrics.UsedBufferSize + ametrics.UsedBufferSize,
                     vmetrics.AllocatedBufferSize + ametrics.AllocatedBufferSize
                 )));
@@ -1087,8 +1102,8 @@ namespace winrt::BiliUWP::implementation {
                 auto deferral = e.GetDeferral();
                 deferred([&] { deferral.Complete(); });
                 try {
-                    result.Buffer(co_await target_hras->GetInputStreamAt(content_start).ReadAsync(
-                        Buffer(content_size_u32), content_size_u32, InputStreamOptions::None));
+                    // NOTE: The buffer may reference HRAS cache directly, saving a copy
+                    result.Buffer(co_await target_hras->ReadBufferAtAsync(content_start, content_size_u32));
                 }
                 catch (hresult_error const& err) {
                     // Present failure to the user because normally fetching should never fail
@@ -1119,6 +1134,7 @@ namespace winrt::BiliUWP::implementation {
         co_return{ MediaSource::CreateFromAdaptiveMediaSource(adaptive_media_src), std::move(ds_provider) };
     }
     util::winrt::task<MediaPlayPage::MediaSrcDetailedStatsPair> MediaPlayPage::PlayVideoWithCidInner_DashNativeHrasNoAudio(
+        uint64_t cid,
         ::BiliUWP::VideoPlayUrl_Dash const& dash_info,
         ::BiliUWP::VideoPlayUrl_Dash_Stream const& vstream,
         std::function<util::winrt::task<::BiliUWP::VideoPlayUrl_Dash_Stream>(void)> get_new_stream_fn
@@ -1149,8 +1165,8 @@ namespace winrt::BiliUWP::implementation {
         auto vhras = co_await weak_store.ual(BiliUWP::HttpRandomAccessStream::CreateAsync(
             vuri,
             m_http_client_m,
-            HttpRandomAccessStreamBufferOptions::Full,
-            0, false
+            HttpRandomAccessStreamBufferOptions::Sized,
+            HRAS_VIDEO_CACHE_CAPACITY, false
         ));
 
         // TODO: Improve new uri supplying logic
@@ -1160,6 +1176,8 @@ namespace winrt::BiliUWP::implementation {
             hras.SupplyNewUri(supply_uris);
         };
         add_backup_uris_fn(vhras, vstream.backup_url);
+        vhras.PrefetchWindowSize(HRAS_VIDEO_PREFETCH_WINDOW_SIZE);
+        vhras.EnablePersistentCache(::BiliUWP::MediaCache::make_stream_key(cid, vstream.id, vstream.codecid));
         auto new_uri_requested_fn = [get_new_stream_fn = std::move(get_new_stream_fn),
             weak_vhras = make_weak(vhras)
         ](BiliUWP::HttpRandomAccessStream const&, BiliUWP::NewUriRequestedEventArgs const& e) -> fire_forget_except
@@ -1209,7 +1227,7 @@ namespace winrt::BiliUWP::implementation {
                 using util::winrt::make_text_block;
                 ctx->AddElement(L"Mime Type", make_text_block(m_mime_type));
                 ctx->AddElement(L"Player Type", make_text_block(
-                    L"NativeDashPlayer <- NativeBuffering <- HRAS(Full)"
+                    L"NativeDashPlayer <- NativeBuffering <- HRAS(Sized)"
                 ));
                 ctx->AddElement(L"Resolution", make_text_block(m_resolution));
                 ctx->AddElement(L"Video Host", m_video_host_tb);
@@ -1279,9 +1297,12 @@ namespace winrt::BiliUWP::implementation {
                 }, m_net_activity_points, MAX_POINTS);
                 // Update mystery text
                 m_mystery_text_tb.Text(hstring(std::format(
-                    L"c:{} rd:{} hrasb:{}/{}",
+                    L"c:{} rd:{} cr:{} cp:{} pc:{} hrasb:{}/{}",
                     vmetrics.ActiveConnectionsCount,
                     vmetrics.SentRequestsDelta,
+                    vmetrics.CoalescedRequestsDelta,
+                    vmetrics.CopiedBytesDelta,
+                    vmetrics.PersistentCacheBytesDelta,
                     vmetrics.UsedBufferSize,
                     vmetrics.AllocatedBufferSize
                 )));
@@ -1337,8 +1358,8 @@ namespace winrt::BiliUWP::implementation {
                 auto deferral = e.GetDeferral();
                 deferred([&] { deferral.Complete(); });
                 try {
-                    result.Buffer(co_await target_hras->GetInputStreamAt(content_start).ReadAsync(
-                        Buffer(content_size_u32), content_size_u32, InputStreamOptions::None));
+                    // NOTE: The buffer may reference HRAS cache directly, saving a copy
+                    result.Buffer(co_await target_hras->ReadBufferAtAsync(content_start, content_size_u32));
                 }
                 catch (hresult_error const& err) {
                     // Present failure to the user because normally fetching should never fail
@@ -1464,14 +1485,14 @@ namespace winrt::BiliUWP::implementation {
                 break;
             }
             auto& video_stream = *pvideo_stream;
-            util::debug::log_trace(std::format(L"Selecting video stream {}", video_stream.id));
+            util::debug::log_trace(L"Selecting video stream {}", video_stream.id);
             const bool video_only_res = video_dash.audio.empty();
             constexpr double BACKOFF_INITIAL_SECS = 10;
             constexpr double BACKOFF_FACTOR = 1.2;
             if (video_dash.audio.empty()) {
                 // No audio
                 if (m_cfg_model.App_UseHRASForVideo()) {
-                    video_task = this->PlayVideoWithCidInner_DashNativeHrasNoAudio(video_dash, video_stream,
+                    video_task = this->PlayVideoWithCidInner_DashNativeHrasNoAudio(cid, video_dash, video_stream,
                         [client, bvid = video_bvid, cid, param,
                         backoff_secs = std::make_shared<double>(0),
                         vid = video_stream.id, vcid = video_stream.codecid
@@ -1514,7 +1535,7 @@ namespace winrt::BiliUWP::implementation {
                 // Video + audio
                 auto& audio_stream = video_dash.audio[0];
                 if (m_cfg_model.App_UseHRASForVideo()) {
-                    video_task = this->PlayVideoWithCidInner_DashNativeHras(video_dash, video_stream, audio_stream,
+                    video_task = this->PlayVideoWithCidInner_DashNativeHras(cid, video_dash, video_stream, audio_stream,
                         [client, bvid = video_bvid, cid, param,
                         backoff_secs = std::make_shared<double>(0),
                         vid = video_stream.id, vcid = video_stream.codecid,
@@ -1609,13 +1630,13 @@ namespace winrt::BiliUWP::implementation {
                 }
             }
             if (!found) {
-                util::debug::log_error(std::format(L"Failed to find part title with given cid {}", cid));
+                util::debug::log_error(L"Failed to find part title with given cid {}", cid);
             }
         }
         media_playback_item.ApplyDisplayProperties(display_props);
         this->SubmitMediaPlaybackSourceToNativePlayer(media_playback_item, nullptr, ds_provider);
-        util::debug::log_trace(std::format(L"Video pic url: {}", video_vinfo.cover_url));
-        util::debug::log_trace(std::format(L"Video title: {}", video_vinfo.title));
+        util::debug::log_trace(L"Video pic url: {}", video_vinfo.cover_url);
+        util::debug::log_trace(L"Video title: {}", video_vinfo.title);
     }
     util::winrt::task<> MediaPlayPage::PlayVideoWithCid(uint64_t cid) {
         auto cancellation_token = co_await get_cancellation_token();
@@ -1710,6 +1731,7 @@ namespace winrt::BiliUWP::implementation {
             HttpRandomAccessStreamBufferOptions::Full,
             0, false
         ));
+        http_stream.PrefetchWindowSize(HRAS_AUDIO_PREFETCH_WINDOW_SIZE);
         auto media_src = MediaSource::CreateFromStream(http_stream, http_stream.ContentType());
 
         // Make DetailedStatsProvider
@@ -1775,9 +1797,10 @@ namespace winrt::BiliUWP::implementation {
                 }, m_net_activity_points, MAX_POINTS);
                 // Update mystery text
                 m_mystery_text_tb.Text(hstring(std::format(
-                    L"type:{}({}) c:{} rd:{} hrasb:{}/{}",
+                    L"type:{}({}) c:{} rd:{} cr:{} cp:{} hrasb:{}/{}",
                     std::to_underlying(m_audio_type), m_audio_bps_str,
                     metrics.ActiveConnectionsCount, metrics.SentRequestsDelta,
+                    metrics.CoalescedRequestsDelta, metrics.CopiedBytesDelta,
                     metrics.UsedBufferSize, metrics.AllocatedBufferSize
                 )));
             }
@@ -1804,8 +1827,8 @@ namespace winrt::BiliUWP::implementation {
         this->SubmitMediaPlaybackSourceToNativePlayer(
             media_playback_item, BitmapImage(Uri(audio_vinfo.cover_url)), ds_provider
         );
-        util::debug::log_trace(std::format(L"Audio pic url: {}", audio_vinfo.cover_url));
-        util::debug::log_trace(std::format(L"Audio title: {}", audio_vinfo.audio_title));
+        util::debug::log_trace(L"Audio pic url: {}", audio_vinfo.cover_url);
+        util::debug::log_trace(L"Audio title: {}", audio_vinfo.audio_title);
     }
     util::winrt::task<> MediaPlayPage::PlayAudio() {
         auto cancellation_token = co_await get_cancellation_token();
@@ -1899,13 +1922,13 @@ namespace winrt::BiliUWP::implementation {
         );
         media_player.MediaFailed([](MediaPlayer const& sender, MediaPlayerFailedEventArgs const& e) {
             auto hresult = e.ExtendedErrorCode();
-            util::debug::log_trace(std::format(
+            util::debug::log_trace(
                 L"Media failed: {}: {} (0x{:08x}: {})",
                 std::to_underlying(e.Error()),
                 e.ErrorMessage(),
                 static_cast<uint32_t>(hresult),
                 hresult_error(hresult).message()
-            ));
+            );
         });
         media_player_elem.SetMediaPlayer(media_player);
         media_player_elem.PosterSource(poster_source);
@@ -190,12 +190,14 @@ namespace winrt::BiliUWP::implementation {
             ::BiliUWP::VideoPlayUrl_Dash_Stream const* pastream
         );
         util::winrt::task<MediaSrcDetailedStatsPair> PlayVideoWithCidInner_DashNativeHras(
+            uint64_t cid,
             ::BiliUWP::VideoPlayUrl_Dash const& dash_info,
             ::BiliUWP::VideoPlayUrl_Dash_Stream const& vstream,
             ::BiliUWP::VideoPlayUrl_Dash_Stream const& astream,
             std::function<util::winrt::task<PlayUrlDashStreamPair>(void)> get_new_stream_fn
         );
         util::winrt::task<MediaSrcDetailedStatsPair> PlayVideoWithCidInner_DashNativeHrasNoAudio(
+            uint64_t cid,
             ::BiliUWP::VideoPlayUrl_Dash const& dash_info,
             ::BiliUWP::VideoPlayUrl_Dash_Stream const& vstream,
             std::function<util::winrt::task<::BiliUWP::VideoPlayUrl_Dash_Stream>(void)> get_new_stream_fn
@@ -146,21 +146,21 @@ namespace winrt::BiliUWP::implementation {
         timer.Tick([=](IInspectable const&, IInspectable const&) {
             /*auto mode = ItemsList().ManipulationMode();
             ItemsList().ManipulationMode(mode ^ ManipulationModes::System);
-            util::debug::log_debug(std::format(L"ManipulationMode: System => {}",
+            util::debug::log_debug(L"ManipulationMode: System => {}",
                 static_cast<bool>(mode & ManipulationModes::System) ? L"Enabled" : L"Disabled"
-            ));*/
+            );*/
             auto last_mode = interaction_source.ManipulationRedirectionMode();
             if (last_mode == VisualInteractionSourceRedirectionMode::Off) {
                 interaction_source.ManipulationRedirectionMode(
                     VisualInteractionSourceRedirectionMode::CapableTouchpadAndPointerWheel
                 );
-                util::debug::log_debug(std::format(L"ManipulationRedirectionMode => CapableTouchpadAndPointerWheel"));
+                util::debug::log_debug(L"ManipulationRedirectionMode => CapableTouchpadAndPointerWheel");
             }
             else {
                 interaction_source.ManipulationRedirectionMode(
                     VisualInteractionSourceRedirectionMode::Off
                 );
-                util::debug::log_debug(std::format(L"ManipulationRedirectionMode => Off"));
+                util::debug::log_debug(L"ManipulationRedirectionMode => Off");
             }
         });
         timer.Interval(1s);
@@ -200,7 +200,7 @@ namespace winrt::BiliUWP::implementation {
             [=](IInspectable const&, PointerRoutedEventArgs const& e) {
                 report_pointer_fn(e.Pointer().PointerDeviceType());
                 auto delta = e.GetCurrentPoint(nullptr).Properties().MouseWheelDelta();
-                util::debug::log_debug(std::format(L"Handled? {}", e.Handled()));
+                util::debug::log_debug(L"Handled? {}", e.Handled());
 #if 0
                 /*if (delta < 0) {
                     interaction_source.ManipulationRedirectionMode(
@@ -389,7 +389,7 @@ namespace winrt::BiliUWP::implementation {
                     last_voff = voff;
                     //Header().Translation(float3(0, last_header_height, 0));
                     //Header().Height(last_header_height);
-                    util::debug::log_debug(std::format(L"Progress => {}, IsIntermediate = {}", last_voff, e.IsIntermediate()));
+                    util::debug::log_debug(L"Progress => {}, IsIntermediate = {}", last_voff, e.IsIntermediate());
                 }
             );
         }, ItemsList());
@@ -449,7 +449,7 @@ namespace winrt::BiliUWP::implementation {
                                 if (!strong_this) { return; }
                                 if (sender.Size() == 0) {
                                     strong_this->m_view_is_volatile[idx] = true;
-                                    util::debug::log_debug(std::format(L"Marked {} as volatile", idx));
+                                    util::debug::log_debug(L"Marked {} as volatile", idx);
                                 }
                                 sdata->state_indicator.SwitchToLoading(
                                     ::BiliUWP::App::res_str(L"App/Common/Loading"));
@@ -461,7 +461,7 @@ namespace winrt::BiliUWP::implementation {
                                 if (!strong_this) { return; }
                                 if (strong_this->m_view_is_volatile[idx]) {
                                     strong_this->m_view_is_volatile[idx] = false;
-                                    util::debug::log_debug(std::format(L"Marked {} as non-volatile", idx));
+                                    util::debug::log_debug(L"Marked {} as non-volatile", idx);
                                 }
                                 if (sdata->items_load_error.load()) { return; }
                                 sdata->state_indicator.SwitchToDone(
@@ -579,12 +579,12 @@ namespace winrt::BiliUWP::implementation {
         TabsPivot().PivotItemLoading([](Pivot const& sender, PivotItemEventArgs const& e) {
             uint32_t idx;
             sender.Items().IndexOf(e.Item(), idx);
-            util::debug::log_debug(std::format(L"Loading item {}", idx));
+            util::debug::log_debug(L"Loading item {}", idx);
         });
         TabsPivot().PivotItemLoaded([this](Pivot const& sender, PivotItemEventArgs const& e) {
             uint32_t idx;
             sender.Items().IndexOf(e.Item(), idx);
-            util::debug::log_debug(std::format(L"Loaded item {}", idx));
+            util::debug::log_debug(L"Loaded item {}", idx);
             m_cur_tab_idx = idx;
             this->ApplyHacksToCurrentItem();
             this->ReconnectExpressionAnimations();
@@ -592,12 +592,12 @@ namespace winrt::BiliUWP::implementation {
         TabsPivot().PivotItemUnloading([](Pivot const& sender, PivotItemEventArgs const& e) {
             uint32_t idx;
             sender.Items().IndexOf(e.Item(), idx);
-            util::debug::log_debug(std::format(L"Unloading item {}", idx));
+            util::debug::log_debug(L"Unloading item {}", idx);
         });
         TabsPivot().PivotItemUnloaded([this](Pivot const& sender, PivotItemEventArgs const& e) {
             uint32_t idx;
             sender.Items().IndexOf(e.Item(), idx);
-            util::debug::log_debug(std::format(L"Unloaded item {}", idx));
+            util::debug::log_debug(L"Unloaded item {}", idx);
             m_cur_tab_idx = static_cast<uint32_t>(sender.SelectedIndex());
             this->ApplyHacksToCurrentItem();
             this->ReconnectExpressionAnimations();
@@ -648,7 +648,7 @@ namespace winrt::BiliUWP::implementation {
         auto tab_idx = TabsPivot().SelectedIndex();
         util::debug::log_debug(L"ReconnectExpressionAnimations called");
         if (m_view_is_volatile[tab_idx]) {
-            util::debug::log_debug(std::format(L"Ignored ReconnectExpressionAnimations for tab {}", tab_idx));
+            util::debug::log_debug(L"Ignored ReconnectExpressionAnimations for tab {}", tab_idx);
             return;
         }
         util::winrt::run_when_loaded([=](FrameworkElement const& fe) {
@@ -683,14 +683,14 @@ namespace winrt::BiliUWP::implementation {
                 [=](IInspectable const&, ScrollViewerViewChangingEventArgs const&) {
                     util::debug::log_debug(L"Reconnecting animation");
                     if (m_ignore_next_viewchanging) {
-                        util::debug::log_debug(std::format(
-                            L"Ignored animation reconnection for tab {} (Reason: NextViewChanging)", tab_idx));
+                        util::debug::log_debug(
+                            L"Ignored animation reconnection for tab {} (Reason: NextViewChanging)", tab_idx);
                         m_ignore_next_viewchanging = false;
                         return;
                     }
                     if (m_view_is_volatile[tab_idx]) {
-                        util::debug::log_debug(std::format(
-                            L"Ignored animation reconnection for tab {} (Reason: ViewIsVolatile)", tab_idx));
+                        util::debug::log_debug(
+                            L"Ignored animation reconnection for tab {} (Reason: ViewIsVolatile)", tab_idx);
                         return;
                     }
                     m_latest_p = -1;
@@ -705,7 +705,7 @@ namespace winrt::BiliUWP::implementation {
                             auto strong_this = weak_this.get();
                             if (!strong_this) { return; }
                             // Store old state
-                            util::debug::log_debug(std::format(L"Idx: {} -> {}", tab_idx, strong_this->m_cur_tab_idx));
+                            util::debug::log_debug(L"Idx: {} -> {}", tab_idx, strong_this->m_cur_tab_idx);
                             float2 new_sv;
                             strong_this->m_comp_props.TryGetVector2(L"sv", new_sv);
                             float new_p;
@@ -812,12 +812,12 @@ namespace winrt::BiliUWP::implementation {
         util::debug::log_debug(L"Updating inner scroll viewer");
         auto new_offset = m_view_offsets[m_cur_tab_idx].sv_offset +
             (m_latest_p - m_view_offsets[m_cur_tab_idx].progress) * (HEADER_MAX_HEIGHT - HEADER_MIN_HEIGHT);
-        util::debug::log_debug(std::format(L"{}: Old info is ({},{})", m_cur_tab_idx, m_view_offsets[m_cur_tab_idx].sv_offset, m_view_offsets[m_cur_tab_idx].progress));
+        util::debug::log_debug(L"{}: Old info is ({},{})", m_cur_tab_idx, m_view_offsets[m_cur_tab_idx].sv_offset, m_view_offsets[m_cur_tab_idx].progress);
         m_view_offsets[m_cur_tab_idx] = { .sv_offset = new_offset, .progress = m_latest_p };
         m_comp_props.InsertVector2(L"sv",
             float2(static_cast<float>(new_offset), static_cast<float>(new_offset))
         );
-        util::debug::log_debug(std::format(L"{}: New info is ({},{})", m_cur_tab_idx, new_offset, m_latest_p));
+        util::debug::log_debug(L"{}: New info is ({},{})", m_cur_tab_idx, new_offset, m_latest_p);
         auto cur_inner_sv = util::winrt::get_first_descendant<ScrollViewer>(
             TabsPivot().Items().GetAt(m_cur_tab_idx).as<PivotItem>().Content().as<FrameworkElement>());
         m_ignore_next_viewchanging = true;
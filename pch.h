@@ -6,6 +6,7 @@
 #include <windows.h>
 #include <unknwn.h>
 #include <restrictederrorinfo.h>
+#include <robuffer.h>
 #include <hstring.h>
 #include <ppltasks.h>
 #include <pplawait.h>